@@ -61,6 +61,89 @@ static int __bt_agent_is_auto_response(uint32_t dev_class, const gchar *address)
 static const int __bt_agent_is_hid_keyboard(uint32_t dev_class);
 static int __bt_agent_generate_passkey(char *passkey, int size);
 
+#define BT_AGENT_DEVICE_MATCH_RULE \
+	"type='signal',sender='org.bluez',interface='org.bluez.Device',member='PropertyChanged'"
+#define BT_AGENT_ADAPTER_MATCH_RULE \
+	"type='signal',sender='org.bluez',interface='org.bluez.Adapter',member='DeviceRemoved'"
+#define BT_AGENT_MANAGER_MATCH_RULE \
+	"type='signal',sender='org.bluez',interface='org.bluez.Manager',member='AdapterRemoved'"
+
+/* device object path -> GetProperties reply */
+static GHashTable *device_properties = NULL;
+
+static DBusHandlerResult __bt_agent_device_cache_filter(DBusConnection *conn,
+							DBusMessage *msg, void *data)
+{
+	const char *path = NULL;
+
+	if (device_properties == NULL ||
+	    dbus_message_get_type(msg) != DBUS_MESSAGE_TYPE_SIGNAL)
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+	if (dbus_message_is_signal(msg, "org.bluez.Device", "PropertyChanged")) {
+		/* Drop the entry, it is fetched again on the next request */
+		path = dbus_message_get_path(msg);
+		if (path)
+			g_hash_table_remove(device_properties, path);
+	} else if (dbus_message_is_signal(msg, "org.bluez.Adapter", "DeviceRemoved")) {
+		if (dbus_message_get_args(msg, NULL, DBUS_TYPE_OBJECT_PATH, &path,
+					  DBUS_TYPE_INVALID))
+			g_hash_table_remove(device_properties, path);
+	} else if (dbus_message_is_signal(msg, "org.bluez.Manager", "AdapterRemoved")) {
+		g_hash_table_remove_all(device_properties);
+	}
+
+	return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+}
+
+static void __bt_agent_device_cache_init(void)
+{
+	DBusConnection *conn;
+
+	if (device_properties != NULL || app_data == NULL ||
+	    app_data->g_connection == NULL)
+		return;
+
+	conn = dbus_g_connection_get_connection(app_data->g_connection);
+
+	if (!dbus_connection_add_filter(conn, __bt_agent_device_cache_filter,
+					NULL, NULL)) {
+		ERR("Fail to add device cache filter");
+		return;
+	}
+
+	dbus_bus_add_match(conn, BT_AGENT_DEVICE_MATCH_RULE, NULL);
+	dbus_bus_add_match(conn, BT_AGENT_ADAPTER_MATCH_RULE, NULL);
+	dbus_bus_add_match(conn, BT_AGENT_MANAGER_MATCH_RULE, NULL);
+
+	device_properties = g_hash_table_new_full(g_str_hash, g_str_equal,
+					g_free, (GDestroyNotify)g_hash_table_destroy);
+}
+
+/* The returned table is owned by the cache and valid until the next signal */
+static GHashTable *__bt_agent_get_device_properties(DBusGProxy *device,
+							GError **error)
+{
+	GHashTable *hash = NULL;
+	const char *path = dbus_g_proxy_get_path(device);
+
+	if (device_properties != NULL && path != NULL) {
+		hash = g_hash_table_lookup(device_properties, path);
+		if (hash != NULL)
+			return hash;
+	}
+
+	dbus_g_proxy_call(device, "GetProperties", error,
+				G_TYPE_INVALID,
+				dbus_g_type_get_map("GHashTable", G_TYPE_STRING, G_TYPE_VALUE),
+				&hash, G_TYPE_INVALID);
+
+	if (hash != NULL && device_properties != NULL && path != NULL)
+		g_hash_table_insert(device_properties, g_strdup(path), hash);
+
+	return hash;
+}
+
 static void __bt_agent_release_memory(void)
 {
 	/* Release Malloc Memory*/
@@ -196,10 +279,7 @@ static gboolean __pincode_request(DBusGProxy *device)
 
 	DBG("+\n");
 
-	dbus_g_proxy_call(device, "GetProperties", &error,
-				G_TYPE_INVALID,
-				dbus_g_type_get_map("GHashTable", G_TYPE_STRING, G_TYPE_VALUE),
-				&hash, G_TYPE_INVALID);
+	hash = __bt_agent_get_device_properties(device, &error);
 
 	if (hash != NULL) {
 		value = g_hash_table_lookup(hash, "Class");
@@ -271,10 +351,7 @@ static gboolean __passkey_request(DBusGProxy *device)
 
 	DBG("+\n");
 
-	dbus_g_proxy_call(device, "GetProperties", &error,
-				G_TYPE_INVALID,
-				dbus_g_type_get_map("GHashTable", G_TYPE_STRING, G_TYPE_VALUE),
-				&hash, G_TYPE_INVALID);
+	hash = __bt_agent_get_device_properties(device, &error);
 
 	if (hash != NULL) {
 		value = g_hash_table_lookup(hash, "Class");
@@ -321,10 +398,7 @@ static gboolean __display_request(DBusGProxy *device, guint passkey, guint enter
 
 	DBG("+\n");
 
-	dbus_g_proxy_call(device, "GetProperties", &error,
-				G_TYPE_INVALID,
-				dbus_g_type_get_map("GHashTable", G_TYPE_STRING, G_TYPE_VALUE),
-				&hash, G_TYPE_INVALID);
+	hash = __bt_agent_get_device_properties(device, &error);
 
 	if (hash != NULL) {
 		value = g_hash_table_lookup(hash, "Address");
@@ -359,10 +433,7 @@ static gboolean __confirm_request(DBusGProxy *device, guint passkey)
 
 	snprintf(str_passkey, sizeof(str_passkey), "%.6d", passkey);
 
-	dbus_g_proxy_call(device, "GetProperties", &error,
-				G_TYPE_INVALID,
-				dbus_g_type_get_map("GHashTable", G_TYPE_STRING, G_TYPE_VALUE),
-				&hash, G_TYPE_INVALID);
+	hash = __bt_agent_get_device_properties(device, &error);
 
 	if (hash != NULL) {
 		value = g_hash_table_lookup(hash, "Class");
@@ -477,9 +548,7 @@ static gboolean __authorize_request(DBusGProxy *device, const char *uuid)
 		return TRUE;
 	}
 
-	dbus_g_proxy_call(device, "GetProperties", &error, G_TYPE_INVALID,
-				dbus_g_type_get_map("GHashTable", G_TYPE_STRING, G_TYPE_VALUE),
-				&hash, G_TYPE_INVALID);
+	hash = __bt_agent_get_device_properties(device, &error);
 
 	if (hash != NULL) {
 		value = g_hash_table_lookup(hash, "Address");
@@ -614,6 +683,8 @@ void _bt_agent_register(DBusGProxy *adapter_proxy)
 {
 	SC_CORE_AGENT_FUNC_CB func_cb = { 0 };
 
+	__bt_agent_device_cache_init();
+
 	func_cb.pincode_func = __pincode_request;
 	func_cb.display_func = __display_request;
 	func_cb.passkey_func = __passkey_request;
@@ -27,12 +27,14 @@
 #include <unistd.h>
 #include <glib.h>
 #include <dbus/dbus-glib.h>
+#include <dbus/dbus-glib-lowlevel.h>
 #include <dbus/dbus.h>
 #include <time.h>
 #include "vconf.h"
 #include "vconf-keys.h"
 
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <fcntl.h>
 
 /*Messaging Header Files*/
@@ -52,6 +54,7 @@
 #include "email-api-network.h"
 
 #include <bluetooth_map_agent.h>
+#include "bluetooth_map_listing.h"
 
 #define OBEX_CLIENT_SERVICE "org.openobex.client"
 #define OBEX_CLIENT_INTERFACE "org.openobex.Client"
@@ -65,14 +68,22 @@
 
 static msg_handle_t g_msg_handle = NULL;
 #define BT_MAP_NEW_MESSAGE "NewMessage"
+#define BT_MAP_NEW_MESSAGES "NewMessages"
 #define BT_MAP_STATUS_CB "sent status callback"
 #define BT_MAP_MSG_CB "sms message callback"
-#define BT_MAP_EMAIL_DEFAULTACCOUNT "db/email/defaultaccount"
-#define BT_MAP_SMS "_s"
-#define BT_MAP_EMAIL "_e"
-#define BT_MAP_MSG_INFO_MAX 256
-#define BT_MAP_MSG_HANDLE_MAX 16
-#define BT_MAP_TIMESTAMP_MAX_LEN 16
+#define BT_MAP_LISTING_CHUNK_SIZE 100
+/* An event waits this long (ms) for others to join its NewMessages */
+#define BT_MNS_EVENT_WINDOW 200
+/* A burst this long is batched without waiting for the window */
+#define BT_MNS_EVENT_QUEUE_MAX 64
+/* SMS bodies up to this size are written to a pipe at once, they fit
+ * its buffer; longer ones go through an unlinked temporary file */
+#define BT_MAP_SMS_BODY_MAX 4096
+#define BT_EMAIL_STORAGE_INTERFACE "User.Email.StorageChange"
+#define BT_EMAIL_STORAGE_SIGNAL "email"
+#define BT_EMAIL_STORAGE_MATCH_RULE \
+	"type='signal',interface='" BT_EMAIL_STORAGE_INTERFACE "'"
+#define BT_MAP_SIGNAL_LISTING_CHUNK "MessageListChunk"
 #define BT_MNS_OBJECT_PATH "/org/bluez/mns"
 #define BT_MNS_INTERFACE "org.bluez.mns"
 #define BT_MSG_UPDATE	0
@@ -108,28 +119,80 @@ GType bluetooth_map_agent_get_type(void);
 
 G_DEFINE_TYPE(BluetoothMapAgent, bluetooth_map_agent, G_TYPE_OBJECT)
 
+typedef struct {
+	int msg_id;
+	const char *type;
+	gint64 queued;		/* monotonic time of the event, in us */
+} BluetoothMnsEvent;
+
+typedef struct {
+	GQueue events;		/* BluetoothMnsEvent, oldest first */
+	guint timer_id;
+	guint max_depth;
+	guint event_count;	/* events queued since start */
+	guint report_count;	/* NewMessage and NewMessages signals sent */
+	gint64 last_latency;	/* us the oldest event of a batch waited */
+	gint64 max_latency;
+} BluetoothMnsEventQueue;
+
+typedef struct {
+	int indicator;
+	int target;		/* account id for flags, mailbox id for deletes */
+	int value;
+	GArray *ids;		/* mail ids */
+} BluetoothMapMailBatch;
+
+typedef struct {
+	BtMapListing *listing;
+	guint chunk_size;
+	guint request_id;
+	gchar *destination;	/* unique name of the requester */
+	DBusGConnection *conn;	/* the chunks are sent on */
+	DBusGProxy *bus_proxy;	/* watches the requester leaving the bus */
+	gboolean gone;
+} BluetoothMapPage;
+
 GMainLoop *g_mainloop = NULL;
 static DBusGConnection *g_connection = NULL;
+static DBusGConnection *g_system_connection = NULL;
 static char *g_mns_path = NULL;
+static guint g_page_request_id = 0;
+static BluetoothMnsEventQueue g_mns_events = { G_QUEUE_INIT, 0, };
 
 static gboolean bluetooth_map_get_folder_tree(BluetoothMapAgent *agent,
 					DBusGMethodInvocation *context);
 static gboolean bluetooth_map_get_message_list(BluetoothMapAgent *agent,
 					gchar *folder_name,
 					DBusGMethodInvocation *context);
+static gboolean bluetooth_map_get_message_list_chunked(BluetoothMapAgent *agent,
+					gchar *folder_name,
+					guint16 max_list_count,
+					guint16 list_start_offset,
+					guint16 chunk_size,
+					DBusGMethodInvocation *context);
 static gboolean bluetooth_map_get_message(BluetoothMapAgent *agent,
 					gchar *message_name,
 					DBusGMethodInvocation *context);
+static gboolean bluetooth_map_get_message_fd(BluetoothMapAgent *agent,
+					gchar *message_name,
+					DBusGMethodInvocation *context);
 static gboolean bluetooth_map_update_message(BluetoothMapAgent *agent,
 					DBusGMethodInvocation *context);
 static gboolean bluetooth_map_message_status(BluetoothMapAgent *agent,
 					gchar *message_name,
 					int indicator, int value,
 					DBusGMethodInvocation *context);
+static gboolean bluetooth_map_set_messages_status(BluetoothMapAgent *agent,
+					gchar **message_names,
+					GArray *indicators,
+					GArray *values,
+					DBusGMethodInvocation *context);
 static gboolean bluetooth_map_noti_registration(BluetoothMapAgent *agent,
 					gchar *remote_addr,
 					gboolean status,
 					DBusGMethodInvocation *context);
+static gboolean bluetooth_map_get_event_stats(BluetoothMapAgent *agent,
+					DBusGMethodInvocation *context);
 
 
 #include "bluetooth_map_agent_glue.h"
@@ -175,68 +238,237 @@ static GError *__bt_map_agent_error(bt_map_agent_error_t error,
 	return g_error_new(BT_MAP_AGENT_ERROR, error, err_msg);
 }
 
-static void __bluetooth_map_msg_incoming_status_cb(msg_handle_t handle,
-				msg_struct_t msg, void *user_param)
+static gboolean __bluetooth_map_mns_event_send_one(DBusConnection *conn,
+					BluetoothMnsEvent *event)
 {
 	DBusMessage *message = NULL;
-	char *message_type = NULL;
-	DBusConnection *conn;
-	int msg_id = 0;
-	int msg_type = 0;
-	char msg_handle[BT_MAP_MSG_HANDLE_MAX] = {0,};
-	int ret = MSG_SUCCESS;
+	dbus_int32_t msg_id = event->msg_id;
+	gboolean ret;
 
-	DBG("+\n");
+	message = dbus_message_new_signal(BT_MNS_OBJECT_PATH, BT_MNS_INTERFACE,
+					BT_MAP_NEW_MESSAGE);
+	if (!message)
+		return FALSE;
 
-	conn  = dbus_bus_get(DBUS_BUS_SYSTEM, NULL);
+	dbus_message_append_args(message, DBUS_TYPE_STRING, &event->type,
+						DBUS_TYPE_INT32, &msg_id,
+						DBUS_TYPE_INVALID);
 
-	if (NULL == conn)
-		return;
+	dbus_message_set_no_reply(message, TRUE);
+	ret = dbus_connection_send(conn, message, NULL);
+	dbus_message_unref(message);
+
+	return ret;
+}
+
+/* NewMessages carries the (type, id) of every message of the batch */
+static gboolean __bluetooth_map_mns_event_send_batch(DBusConnection *conn,
+						GQueue *events)
+{
+	DBusMessage *message = NULL;
+	DBusMessageIter iter;
+	DBusMessageIter array;
+	GList *l;
+	gboolean ret;
 
 	message = dbus_message_new_signal(BT_MNS_OBJECT_PATH, BT_MNS_INTERFACE,
-					BT_MAP_NEW_MESSAGE);
-	if (!message) {
-		dbus_connection_unref(conn);
-		return;
+					BT_MAP_NEW_MESSAGES);
+	if (!message)
+		return FALSE;
+
+	dbus_message_iter_init_append(message, &iter);
+	dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
+				DBUS_STRUCT_BEGIN_CHAR_AS_STRING
+				DBUS_TYPE_STRING_AS_STRING
+				DBUS_TYPE_INT32_AS_STRING
+				DBUS_STRUCT_END_CHAR_AS_STRING, &array);
+
+	for (l = g_queue_peek_head_link(events); l; l = l->next) {
+		BluetoothMnsEvent *event = l->data;
+		dbus_int32_t msg_id = event->msg_id;
+		DBusMessageIter item;
+
+		dbus_message_iter_open_container(&array, DBUS_TYPE_STRUCT,
+						NULL, &item);
+		dbus_message_iter_append_basic(&item, DBUS_TYPE_STRING,
+						&event->type);
+		dbus_message_iter_append_basic(&item, DBUS_TYPE_INT32, &msg_id);
+		dbus_message_iter_close_container(&array, &item);
+	}
+
+	dbus_message_iter_close_container(&iter, &array);
+
+	dbus_message_set_no_reply(message, TRUE);
+	ret = dbus_connection_send(conn, message, NULL);
+	dbus_message_unref(message);
+
+	return ret;
+}
+
+static void __bluetooth_map_mns_event_flush(void)
+{
+	BluetoothMnsEventQueue *queue = &g_mns_events;
+	BluetoothMnsEvent *event;
+	gboolean ret = FALSE;
+	guint depth;
+
+	if (queue->timer_id) {
+		g_source_remove(queue->timer_id);
+		queue->timer_id = 0;
 	}
 
+	depth = g_queue_get_length(&queue->events);
+	if (depth == 0)
+		return;
+
+	event = g_queue_peek_head(&queue->events);
+	queue->last_latency = g_get_monotonic_time() - event->queued;
+	queue->max_latency = MAX(queue->max_latency, queue->last_latency);
+
+	if (g_system_connection)
+		ret = __bluetooth_map_mns_event_send_batch(
+			dbus_g_connection_get_connection(g_system_connection),
+			&queue->events);
+
+	if (ret)
+		queue->report_count++;
+	else
+		ERR("NewMessages for %u events dropped\n", depth);
+
+	DBG("%u events batched after %lld us\n", depth,
+				(long long)queue->last_latency);
+
+	while ((event = g_queue_pop_head(&queue->events)) != NULL)
+		g_free(event);
+}
+
+static gboolean __bluetooth_map_mns_event_timeout(gpointer user_data)
+{
+	g_mns_events.timer_id = 0;
+
+	__bluetooth_map_mns_event_flush();
+
+	return FALSE;
+}
+
+static void __bluetooth_map_mns_event_push(int msg_id, const char *type)
+{
+	BluetoothMnsEventQueue *queue = &g_mns_events;
+	BluetoothMnsEvent *event;
+	guint depth;
+
+	event = g_new0(BluetoothMnsEvent, 1);
+	event->msg_id = msg_id;
+	event->type = type;
+	event->queued = g_get_monotonic_time();
+
+	/* NewMessage is what MNS clients know, it never waits for the window */
+	if (g_system_connection && __bluetooth_map_mns_event_send_one(
+			dbus_g_connection_get_connection(g_system_connection),
+			event))
+		queue->report_count++;
+	else
+		ERR("NewMessage for %d dropped\n", msg_id);
+
+	g_queue_push_tail(&queue->events, event);
+	queue->event_count++;
+
+	depth = g_queue_get_length(&queue->events);
+	queue->max_depth = MAX(queue->max_depth, depth);
+
+	if (depth >= BT_MNS_EVENT_QUEUE_MAX)
+		__bluetooth_map_mns_event_flush();
+	else if (queue->timer_id == 0)
+		queue->timer_id = g_timeout_add(BT_MNS_EVENT_WINDOW,
+				__bluetooth_map_mns_event_timeout, NULL);
+}
+
+static void __bluetooth_map_msg_incoming_status_cb(msg_handle_t handle,
+				msg_struct_t msg, void *user_param)
+{
+	int msg_id = 0;
+	int msg_type = 0;
+	int ret = MSG_SUCCESS;
+
+	DBG("+\n");
+
+	_bluetooth_map_index_msg_update(msg);
 
 	ret = msg_get_int_value(msg,
 			MSG_MESSAGE_ID_INT, &msg_id);
 	if (ret != MSG_SUCCESS)
 		return;
 
-	snprintf(msg_handle, sizeof(msg_handle), "%d%s",
-			msg_id,
-			BT_MAP_SMS);
-
 	ret = msg_get_int_value(msg,
 			MSG_MESSAGE_TYPE_INT, &msg_type);
 	if (ret != MSG_SUCCESS)
 		return;
 
-	switch (msg_type) {
-	case MSG_TYPE_SMS:
-		message_type = g_strdup("SMS_GSM");
-		break;
-	case MSG_TYPE_MMS:
-		message_type = g_strdup("MMS");
-		break;
-	default:
-		message_type = g_strdup("UNKNOWN");
-		break;
+	/* Reported at once, and with its burst once the window closes */
+	__bluetooth_map_mns_event_push(msg_id,
+				_bluetooth_map_msg_type_name(msg_type));
+}
+
+static DBusHandlerResult __bluetooth_map_email_storage_filter(
+					DBusConnection *conn,
+					DBusMessage *msg, void *data)
+{
+	dbus_int32_t type = 0;
+	dbus_int32_t data1 = 0;
+	dbus_int32_t data2 = 0;
+	dbus_int32_t data4 = 0;
+	const char *data3 = NULL;
+
+	if (!dbus_message_is_signal(msg, BT_EMAIL_STORAGE_INTERFACE,
+					BT_EMAIL_STORAGE_SIGNAL))
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+	if (!dbus_message_get_args(msg, NULL,
+				DBUS_TYPE_INT32, &type,
+				DBUS_TYPE_INT32, &data1,
+				DBUS_TYPE_INT32, &data2,
+				DBUS_TYPE_STRING, &data3,
+				DBUS_TYPE_INT32, &data4,
+				DBUS_TYPE_INVALID))
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+	/* data2 is the mail id of single mail events */
+	_bluetooth_map_index_mail_changed(type, data2);
+
+	return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+}
+
+static void __bluetooth_map_email_storage_init(void)
+{
+	DBusConnection *conn;
+
+	if (g_system_connection == NULL)
+		return;
+
+	conn = dbus_g_connection_get_connection(g_system_connection);
 
+	if (!dbus_connection_add_filter(conn,
+				__bluetooth_map_email_storage_filter,
+				NULL, NULL)) {
+		ERR("Fail to add email storage filter\n");
+		return;
 	}
 
-	dbus_message_append_args(message, DBUS_TYPE_STRING, &message_type,
-						DBUS_TYPE_INT32, &msg_handle,
-						DBUS_TYPE_INVALID);
+	dbus_bus_add_match(conn, BT_EMAIL_STORAGE_MATCH_RULE, NULL);
+}
 
-	dbus_message_set_no_reply(message, TRUE);
-	dbus_connection_send(conn, message, NULL);
-	dbus_message_unref(message);
-	dbus_connection_unref(conn);
-	g_free(message_type);
+static void __bluetooth_map_email_storage_deinit(void)
+{
+	DBusConnection *conn;
+
+	if (g_system_connection == NULL)
+		return;
+
+	conn = dbus_g_connection_get_connection(g_system_connection);
+
+	dbus_bus_remove_match(conn, BT_EMAIL_STORAGE_MATCH_RULE, NULL);
+	dbus_connection_remove_filter(conn,
+				__bluetooth_map_email_storage_filter, NULL);
 }
 
 static gboolean __bluetooth_map_start_service()
@@ -246,6 +478,11 @@ static gboolean __bluetooth_map_start_service()
 	gboolean msg_ret = TRUE;
 	gboolean email_ret = TRUE;
 
+	/* Kept for the service lifetime, MNS events are sent on it */
+	g_system_connection = dbus_g_bus_get(DBUS_BUS_SYSTEM, NULL);
+	if (g_system_connection == NULL)
+		ERR("Couldn't connect to system bus\n");
+
 	err = msg_open_msg_handle(&g_msg_handle);
 	if (err != MSG_SUCCESS) {
 		ERR("msg_open_msg_handle error = %d\n", err);
@@ -268,14 +505,30 @@ email:
 		email_ret = FALSE;
 	}
 
-	if (msg_ret || email_ret)
+	if (msg_ret || email_ret) {
+		_bluetooth_map_folder_map_init(g_msg_handle);
+
+		if (email_ret)
+			__bluetooth_map_email_storage_init();
+
 		return TRUE;
-	else
-		return FALSE;
+	}
+
+	if (g_system_connection) {
+		dbus_g_connection_unref(g_system_connection);
+		g_system_connection = NULL;
+	}
+
+	return FALSE;
 }
 
 static void __bluetooth_map_stop_service()
 {
+	__bluetooth_map_mns_event_flush();
+
+	__bluetooth_map_email_storage_deinit();
+	_bluetooth_map_folder_map_deinit();
+
 	if (NULL != g_msg_handle)
 		msg_close_msg_handle(&g_msg_handle);
 
@@ -283,25 +536,11 @@ static void __bluetooth_map_stop_service()
 
 	if (EMAIL_ERROR_NONE != email_service_end())
 		ERR("email_service_end fail \n");
-	return;
-}
-
-static void __get_msg_timestamp(time_t *ltime, char *timestamp)
-{
-	struct tm local_time;
-	int year;
-	int month;
-
-	if (!localtime_r(ltime, &local_time))
-		return;
-
-	year = local_time.tm_year + 1900; /* years since 1900 */
-	month = local_time.tm_mon + 1; /* months since January */
-	snprintf(timestamp, 16, "%04d%02d%02dT%02d%02d%02d",
-				year, month,
-				local_time.tm_mday, local_time.tm_hour,
-				local_time.tm_min, local_time.tm_sec);
 
+	if (g_system_connection) {
+		dbus_g_connection_unref(g_system_connection);
+		g_system_connection = NULL;
+	}
 	return;
 }
 
@@ -421,354 +660,278 @@ static gboolean bluetooth_map_get_folder_tree(BluetoothMapAgent *agent,
 	GValue value;
 	GError *error = NULL;
 
-	char name[BT_MAP_MSG_INFO_MAX] = {0,};
-	char folder_name[BT_MAP_MSG_INFO_MAX] = {0,};
-	int i;
-	int j;
-	int account_id = 0;
-	int mailbox_count = 0;
-	int ret = MSG_SUCCESS;
-	gboolean flag = FALSE;
-	gboolean msg_ret = TRUE;
+	const GPtrArray *folders;
+	guint i;
 
-	msg_struct_list_s g_folderList;
-	msg_struct_t p_folder;
-	email_mailbox_t *mailbox_list = NULL;
+	/* The tree is where clients learn about new mailboxes */
+	folders = _bluetooth_map_folder_map_refresh();
 
-	if (g_msg_handle == NULL) {
-		msg_ret = FALSE;
-		goto email;
-	}
+	if (folders->len == 0) {
+		g_ptr_array_free(array, TRUE);
 
-	if (msg_get_folder_list(g_msg_handle, &g_folderList) != MSG_SUCCESS) {
-		msg_ret = FALSE;
-		goto email;
+		error = __bt_map_agent_error(BT_MAP_AGENT_ERROR_INTERNAL,
+					"InternalError");
+		dbus_g_method_return_error(context, error);
+		g_error_free(error);
+		return FALSE;
 	}
 
-	for (i = 0; i < g_folderList.nCount; i++) {
-		p_folder = g_folderList.msg_struct_info[i];
-		memset(folder_name, 0x00, BT_MAP_MSG_INFO_MAX);
-
-		ret = msg_get_str_value(p_folder, MSG_FOLDER_INFO_NAME_STR,
-					folder_name, BT_MAP_MSG_INFO_MAX);
-		if (ret != MSG_SUCCESS)
-			continue;
+	for (i = 0; i < folders->len; i++) {
+		const BtMapFolder *folder = g_ptr_array_index(folders, i);
 
-		g_strlcpy(name, folder_name, sizeof(name));
 		memset(&value, 0, sizeof(GValue));
 		g_value_init(&value, DBUS_STRUCT_STRING_STRING_UINT);
 		g_value_take_boxed(&value, dbus_g_type_specialized_construct(
 					DBUS_STRUCT_STRING_STRING_UINT));
-		dbus_g_type_struct_set(&value, 0, name, G_MAXUINT);
+		dbus_g_type_struct_set(&value, 0, folder->name, G_MAXUINT);
 		g_ptr_array_add(array, g_value_get_boxed(&value));
 	}
 
-email:
-	if (EMAIL_ERROR_NONE != email_load_default_account_id(&account_id))
-		goto done;
-
-	if (EMAIL_ERROR_NONE != email_get_mailbox_list(account_id,
-							EMAIL_MAILBOX_ALL,
-							&mailbox_list,
-							&mailbox_count)) {
-		goto done;
-	}
-
-	msg_ret = TRUE;
-
-	for (i = 0; i < mailbox_count; i++) {
-		flag = FALSE;
-		for (j = 0; j < g_folderList.nCount; j++) {
-
-			p_folder = g_folderList.msg_struct_info[j];
-			memset(folder_name, 0x00, BT_MAP_MSG_INFO_MAX);
-
-			ret = msg_get_str_value(p_folder, MSG_FOLDER_INFO_NAME_STR,
-						folder_name, BT_MAP_MSG_INFO_MAX);
-			if (ret != MSG_SUCCESS)
-				continue;
-
-			if (!g_ascii_strncasecmp(mailbox_list[i].alias,
-				folder_name, strlen(mailbox_list[i].alias))) {
-				flag = TRUE;
-				break;
-			}
-		}
-
-		if (!flag) {
-			g_strlcpy(name, mailbox_list[i].alias, sizeof(name));
-			memset(&value, 0, sizeof(GValue));
-			g_value_init(&value, DBUS_STRUCT_STRING_STRING_UINT);
-			g_value_take_boxed(&value,
-				dbus_g_type_specialized_construct(
-				DBUS_STRUCT_STRING_STRING_UINT));
-			dbus_g_type_struct_set(&value, 0, name, G_MAXUINT);
-			g_ptr_array_add(array, g_value_get_boxed(&value));
-		}
-	}
-
-	if (mailbox_list != NULL)
-		 email_free_mailbox(&mailbox_list, mailbox_count);
-
-done:
-
-	if (msg_ret == FALSE) {
-		g_ptr_array_free(array, TRUE);
-
-		error = __bt_map_agent_error(BT_MAP_AGENT_ERROR_INTERNAL,
-					"InternalError");
-		dbus_g_method_return_error(context, error);
-		g_error_free(error);
-		return FALSE;
-	} else {
-		dbus_g_method_return(context, array);
-		g_ptr_array_free(array, TRUE);
-		return TRUE;
-	}
+	dbus_g_method_return(context, array);
+	g_ptr_array_free(array, TRUE);
+	return TRUE;
 }
 
 static gboolean bluetooth_map_get_message_list(BluetoothMapAgent *agent,
 					gchar *folder_name,
 					DBusGMethodInvocation *context)
 {
-	GPtrArray *array = g_ptr_array_new();
+	GPtrArray *array = NULL;
+	GArray *entries = NULL;
 	GValue value;
 	GError *error = NULL;
 
-	char msg_handle[BT_MAP_MSG_HANDLE_MAX] = {0,};
-	char msg_type[BT_MAP_MSG_INFO_MAX] = {0,};
-	char msg_datetime[BT_MAP_TIMESTAMP_MAX_LEN] = {0,};
-	char *folder = NULL;
-	char *type = NULL;
-	int i = 0;
-	int account_id = 0;
-	int mailbox_count = 0;
-	int mail_count = 0;
-	int total = 0;
-	gboolean msg_ret = TRUE;
-	int ret = 0;
-	int folder_id = 0;
-
-	msg_struct_list_s g_folderList;
-	msg_struct_list_s msg_list;
-
-	email_mailbox_t *mailbox_list = NULL;
-	email_mail_list_item_t *mail_list = NULL;
-	email_list_filter_t *filter_list = NULL;
-	email_list_sorting_rule_t *sorting_rule_list = NULL;
-
-	if (g_msg_handle == NULL) {
-		msg_ret = FALSE;
-		goto email;
-	}
+	BtMapListing *listing;
+	guint i;
 
-	folder = strrchr(folder_name, '/');
-	if (NULL == folder)
-		folder = folder_name;
-	else
-		folder++;
-
-	ret = msg_get_folder_list(g_msg_handle, &g_folderList);
-	if (ret  != MSG_SUCCESS) {
-		msg_ret = FALSE;
-		goto email;
+	listing = _bluetooth_map_listing_new(folder_name,
+				BT_MAP_LISTING_UNRESTRICTED, 0);
+	if (listing == NULL) {
+		error = __bt_map_agent_error(BT_MAP_AGENT_ERROR_INTERNAL,
+					  "InternalError");
+		dbus_g_method_return_error(context, error);
+		g_error_free(error);
+		return FALSE;
 	}
 
-	for (i = 0; i < g_folderList.nCount; i++) {
-		msg_struct_t pFolder = g_folderList.msg_struct_info[i];
-		char folderName[BT_MAP_MSG_INFO_MAX] = {0, };
+	entries = g_array_sized_new(FALSE, FALSE, sizeof(BtMapListingEntry),
+				_bluetooth_map_listing_count(listing));
+	_bluetooth_map_listing_read(listing, entries, G_MAXUINT);
+	_bluetooth_map_listing_free(listing);
 
-		ret = msg_get_str_value(pFolder, MSG_FOLDER_INFO_NAME_STR,
-						folderName, BT_MAP_MSG_INFO_MAX);
-		if (ret  != MSG_SUCCESS)
-			continue;
+	array = g_ptr_array_sized_new(entries->len);
 
-		if (!g_ascii_strncasecmp(folder, folderName, strlen(folder))) {
-			ret = msg_get_int_value(pFolder, MSG_FOLDER_INFO_ID_INT, &folder_id);
-			if (ret != MSG_SUCCESS) {
-				msg_ret = FALSE;
-			} else {
-				DBG("folder_id %d \n", folder_id);
-			}
-			break;
-		}
-	}
+	for (i = 0; i < entries->len; i++) {
+		BtMapListingEntry *entry;
 
-	if (msg_ret == FALSE)
-		goto email;
-
-	/* Need to apply filter on the code based on remote request */
-	if (MSG_SUCCESS != msg_get_folder_view_list(g_msg_handle,
-					folder_id, NULL, &msg_list)) {
-		msg_ret = FALSE;
-		goto email;
-	}
-
-	for (i = 0; i < msg_list.nCount; i++) {
-		int dptime;
-		int m_id = 0;
-		int m_type = 0;
+		entry = &g_array_index(entries, BtMapListingEntry, i);
 
 		memset(&value, 0, sizeof(GValue));
 		g_value_init(&value, DBUS_STRUCT_MESSAGE_LIST);
 		g_value_take_boxed(&value, dbus_g_type_specialized_construct(
 				DBUS_STRUCT_MESSAGE_LIST));
 
-		ret = msg_get_int_value(msg_list.msg_struct_info[i],
-							MSG_MESSAGE_ID_INT, &m_id);
-		if (ret != MSG_SUCCESS)
-			continue;
-
-		snprintf(msg_handle, sizeof(msg_handle), "%d%s",
-				m_id,
-				BT_MAP_SMS);
+		dbus_g_type_struct_set(&value, 0, entry->handle,
+					1, entry->type,
+					2, entry->datetime,
+					G_MAXUINT);
+		g_ptr_array_add(array, g_value_get_boxed(&value));
+	}
 
-		ret = msg_get_int_value(msg_list.msg_struct_info[i],
-				MSG_MESSAGE_DISPLAY_TIME_INT, &dptime);
-		if (ret == MSG_SUCCESS)
-			__get_msg_timestamp((time_t *)&dptime, msg_datetime);
+	dbus_g_method_return(context, array);
+	g_ptr_array_free(array, TRUE);
+	g_array_free(entries, TRUE);
+	return TRUE;
+}
 
-		msg_get_int_value(msg_list.msg_struct_info[i],
-				MSG_MESSAGE_TYPE_INT, &m_type);
+static void __bluetooth_map_page_name_owner_changed(DBusGProxy *object,
+					const char *name,
+					const char *prev,
+					const char *new,
+					gpointer user_data)
+{
+	BluetoothMapPage *page = user_data;
 
-		switch (m_type) {
-		case MSG_TYPE_SMS:
-			g_strlcpy(msg_type, "SMS_GSM", sizeof(msg_type));
-			break;
+	if (g_strcmp0(name, page->destination) == 0 && *new == '\0') {
+		DBG("request %d: requester left the bus\n", page->request_id);
+		page->gone = TRUE;
+	}
+}
 
-		case MSG_TYPE_MMS:
-			g_strlcpy(msg_type, "MMS", sizeof(msg_type));
-			break;
+static void __bluetooth_map_page_free(BluetoothMapPage *page)
+{
+	if (page == NULL)
+		return;
 
-		default:
-			g_strlcpy(msg_type, "UNKNOWN", sizeof(msg_type));
-			break;
-		}
+	_bluetooth_map_listing_free(page->listing);
 
-		dbus_g_type_struct_set(&value, 0, msg_handle,
-					1, msg_type,
-					2, msg_datetime,
-					G_MAXUINT);
-		g_ptr_array_add(array, g_value_get_boxed(&value));
+	if (page->bus_proxy) {
+		dbus_g_proxy_disconnect_signal(page->bus_proxy,
+				"NameOwnerChanged",
+				G_CALLBACK(__bluetooth_map_page_name_owner_changed),
+				page);
+		g_object_unref(page->bus_proxy);
 	}
 
-email:
-	if (EMAIL_ERROR_NONE != email_load_default_account_id(&account_id)) {
-		if (!msg_ret)
-			goto fail;
-	}
+	if (page->conn)
+		dbus_g_connection_unref(page->conn);
 
-	if (EMAIL_ERROR_NONE != email_get_mailbox_list(account_id,
-						EMAIL_MAILBOX_ALL,
-						&mailbox_list,
-						&mailbox_count)) {
-		if (!msg_ret)
-			goto fail;
+	g_free(page->destination);
+	g_free(page);
+}
+
+static gboolean __bluetooth_map_page_send_chunk(BluetoothMapPage *page,
+					GArray *entries,
+					gboolean last)
+{
+	DBusMessage *msg = NULL;
+	DBusMessageIter iter;
+	DBusMessageIter array;
+	dbus_bool_t is_last = last;
+	gboolean ret;
+	guint i;
+
+	msg = dbus_message_new_signal(BT_MAP_SERVICE_OBJECT_PATH,
+				BT_MAP_SERVICE_INTERFACE,
+				BT_MAP_SIGNAL_LISTING_CHUNK);
+	if (msg == NULL)
+		return FALSE;
+
+	/* Unicast, the listing is only for the requester */
+	dbus_message_set_destination(msg, page->destination);
+
+	dbus_message_iter_init_append(msg, &iter);
+	dbus_message_iter_append_basic(&iter, DBUS_TYPE_UINT32, &page->request_id);
+
+	dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
+				DBUS_STRUCT_BEGIN_CHAR_AS_STRING
+				DBUS_TYPE_STRING_AS_STRING
+				DBUS_TYPE_STRING_AS_STRING
+				DBUS_TYPE_STRING_AS_STRING
+				DBUS_STRUCT_END_CHAR_AS_STRING, &array);
+	for (i = 0; i < entries->len; i++) {
+		BtMapListingEntry *entry;
+		DBusMessageIter item;
+		const char *handle;
+		const char *type;
+		const char *datetime;
+
+		entry = &g_array_index(entries, BtMapListingEntry, i);
+		handle = entry->handle;
+		type = entry->type;
+		datetime = entry->datetime;
+
+		dbus_message_iter_open_container(&array, DBUS_TYPE_STRUCT,
+						NULL, &item);
+		dbus_message_iter_append_basic(&item, DBUS_TYPE_STRING, &handle);
+		dbus_message_iter_append_basic(&item, DBUS_TYPE_STRING, &type);
+		dbus_message_iter_append_basic(&item, DBUS_TYPE_STRING, &datetime);
+		dbus_message_iter_close_container(&array, &item);
 	}
+	dbus_message_iter_close_container(&iter, &array);
 
-	if (mailbox_list == NULL)
-		goto fail;
+	dbus_message_iter_append_basic(&iter, DBUS_TYPE_BOOLEAN, &is_last);
 
-	for (i = 0; i < mailbox_count; i++) {
-		DBG("mailbox alias = %s \n", mailbox_list[i].alias);
-		if (!g_ascii_strncasecmp(mailbox_list[i].alias, folder,
-			strlen(mailbox_list[i].alias))) {
-			total = mailbox_list[i].total_mail_count_on_server;
-			DBG("Total mail on sever : %d \n", total);
-			DBG("mailbox name : %s \n", mailbox_list[i].mailbox_name);
+	ret = dbus_connection_send(dbus_g_connection_get_connection(page->conn),
+				msg, NULL);
 
-			break;
-		}
+	dbus_message_unref(msg);
 
-		if (!msg_ret)
-			goto fail;
-		else
-			goto done;
-	}
+	return ret;
+}
 
-	/* Need to modify the filter code, have to make it dynamic based on remote device request*/
-	/* Also to check whether it needs to be done in agent or in obexd */
+static gboolean __bluetooth_map_page_stream(gpointer user_data)
+{
+	BluetoothMapPage *page = user_data;
+	GArray *entries;
+	gboolean last;
 
-	filter_list = g_new0(email_list_filter_t, 3);
-	filter_list[0].list_filter_item_type = EMAIL_LIST_FILTER_ITEM_RULE;
-	filter_list[0].list_filter_item.rule.target_attribute = EMAIL_MAIL_ATTRIBUTE_ACCOUNT_ID;
-	filter_list[0].list_filter_item.rule.rule_type = EMAIL_LIST_FILTER_RULE_EQUAL;
-	filter_list[0].list_filter_item.rule.key_value.integer_type_value = account_id;
+	/* nobody to read the rest, release the listing now */
+	if (page->gone) {
+		__bluetooth_map_page_free(page);
+		return FALSE;
+	}
 
-	filter_list[1].list_filter_item_type = EMAIL_LIST_FILTER_ITEM_OPERATOR;
-	filter_list[1].list_filter_item.operator_type = EMAIL_LIST_FILTER_OPERATOR_AND;
+	entries = g_array_sized_new(FALSE, FALSE, sizeof(BtMapListingEntry),
+				page->chunk_size);
 
-	filter_list[2].list_filter_item_type = EMAIL_LIST_FILTER_ITEM_RULE;
-	filter_list[2].list_filter_item.rule.target_attribute = EMAIL_MAIL_ATTRIBUTE_MAILBOX_NAME;
-	filter_list[2].list_filter_item.rule.rule_type = EMAIL_LIST_FILTER_RULE_EQUAL;
-	type = g_strdup(mailbox_list[i].mailbox_name);
-	filter_list[2].list_filter_item.rule.key_value.string_type_value = type;
-	filter_list[2].list_filter_item.rule.case_sensitivity = true;
+	last = !_bluetooth_map_listing_read(page->listing, entries,
+					page->chunk_size);
 
-	sorting_rule_list = g_new0(email_list_sorting_rule_t, 1);
-	sorting_rule_list->target_attribute = EMAIL_MAIL_ATTRIBUTE_DATE_TIME;
-	sorting_rule_list->sort_order = EMAIL_SORT_ORDER_ASCEND;
+	if (!__bluetooth_map_page_send_chunk(page, entries, last)) {
+		ERR("request %d: chunk send failed\n", page->request_id);
+		last = TRUE;
+	}
 
-	ret = email_get_mail_list_ex(filter_list, 3,
-				sorting_rule_list, 1, 0, total - 1,
-				&mail_list, &mail_count);
+	g_array_free(entries, TRUE);
 
-	DBG("email API ret %d  \n", ret);
-	if (ret != EMAIL_ERROR_NONE) {
-		if (!msg_ret) {
-			g_free(type);
-			g_free(filter_list);
-			g_free(sorting_rule_list);
-			goto fail;
-		} else
-			goto done;
+	if (last) {
+		__bluetooth_map_page_free(page);
+		return FALSE;
 	}
 
-	for (i = 0; i < mail_count; ++i) {
-		time_t time = {0,};
-		memset(&value, 0, sizeof(GValue));
-		g_value_init(&value, DBUS_STRUCT_MESSAGE_LIST);
-		g_value_take_boxed(&value, dbus_g_type_specialized_construct(
-			DBUS_STRUCT_MESSAGE_LIST));
+	/* Yield to the main loop between chunks */
+	return TRUE;
+}
 
-		snprintf(msg_handle, sizeof(msg_handle), "%d%s",
-					mail_list[i].mail_id,
-					BT_MAP_EMAIL);
-		g_strlcpy(msg_type,  "EMAIL", sizeof(msg_type));
+static gboolean bluetooth_map_get_message_list_chunked(BluetoothMapAgent *agent,
+					gchar *folder_name,
+					guint16 max_list_count,
+					guint16 list_start_offset,
+					guint16 chunk_size,
+					DBusGMethodInvocation *context)
+{
+	BluetoothMapPage *page = NULL;
+	BtMapListing *listing = NULL;
+	GError *error = NULL;
 
-		time = mail_list[i].date_time;
-		__get_msg_timestamp(&time, msg_datetime);
+	DBG("folder %s max %d offset %d\n", folder_name, max_list_count,
+						list_start_offset);
 
-		dbus_g_type_struct_set(&value, 0, msg_handle,
-					1, msg_type,
-					2, msg_datetime, G_MAXUINT);
-		g_ptr_array_add(array, g_value_get_boxed(&value));
+	/* Only the folder view and counts are read here */
+	listing = _bluetooth_map_listing_new(folder_name, max_list_count,
+						list_start_offset);
+	if (listing == NULL) {
+		error = __bt_map_agent_error(BT_MAP_AGENT_ERROR_INTERNAL,
+					  "InternalError");
+		dbus_g_method_return_error(context, error);
+		g_error_free(error);
+		return FALSE;
 	}
 
-done:
-	if (mailbox_list != NULL)
-		 email_free_mailbox(&mailbox_list, mailbox_count);
-	if (mail_list != NULL)
-		g_free(mail_list);
-	dbus_g_method_return(context, array);
-	g_ptr_array_free(array, TRUE);
-	g_free(type);
-	g_free(filter_list);
-	g_free(sorting_rule_list);
-	return TRUE;
+	/* The agent's own connection, held for every chunk of the page */
+	page = g_new0(BluetoothMapPage, 1);
+	page->conn = dbus_g_connection_ref(g_connection);
+	page->listing = listing;
+	page->chunk_size = chunk_size ? chunk_size : BT_MAP_LISTING_CHUNK_SIZE;
+	page->request_id = ++g_page_request_id;
+	page->destination = dbus_g_method_get_sender(context);
 
-fail:
-	if (mailbox_list != NULL)
-		 email_free_mailbox(&mailbox_list, mailbox_count);
-	if (mail_list != NULL)
-		g_free(mail_list);
-	g_ptr_array_free(array, TRUE);
-	error = __bt_map_agent_error(BT_MAP_AGENT_ERROR_INTERNAL,
-				  "InternalError");
-	dbus_g_method_return_error(context, error);
-	g_error_free(error);
-	return FALSE;
+	page->bus_proxy = dbus_g_proxy_new_for_name(page->conn,
+					DBUS_SERVICE_DBUS,
+					DBUS_PATH_DBUS, DBUS_INTERFACE_DBUS);
+	if (page->bus_proxy) {
+		dbus_g_proxy_add_signal(page->bus_proxy, "NameOwnerChanged",
+				G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING,
+				G_TYPE_INVALID);
+		dbus_g_proxy_connect_signal(page->bus_proxy, "NameOwnerChanged",
+				G_CALLBACK(__bluetooth_map_page_name_owner_changed),
+				page, NULL);
+	}
+
+	DBG("request %d: %d of %d messages in chunks of %d\n",
+			page->request_id,
+			_bluetooth_map_listing_count(listing),
+			_bluetooth_map_listing_size(listing),
+			page->chunk_size);
 
+	dbus_g_method_return(context, page->request_id,
+				_bluetooth_map_listing_count(listing),
+				_bluetooth_map_listing_size(listing));
+
+	g_idle_add(__bluetooth_map_page_stream, page);
+
+	return TRUE;
 }
 
 static gboolean bluetooth_map_get_message(BluetoothMapAgent *agent,
@@ -896,6 +1059,219 @@ fail:
 	return FALSE;
 }
 
+static gboolean __bluetooth_map_write_all(int fd, const char *buf, size_t len)
+{
+	while (len > 0) {
+		ssize_t n = write(fd, buf, len);
+
+		if (n < 0)
+			return FALSE;
+
+		buf += n;
+		len -= n;
+	}
+
+	return TRUE;
+}
+
+/* Returns a readable fd positioned at the start of buf */
+static int __bluetooth_map_body_fd(const char *buf, size_t len)
+{
+	gchar *path = NULL;
+	int fds[2] = { -1, -1 };
+	int fd;
+
+	if (len <= BT_MAP_SMS_BODY_MAX) {
+		if (pipe(fds) < 0) {
+			ERR("pipe failed\n");
+			return -1;
+		}
+
+		/* The whole body fits the pipe, so the write never blocks */
+		if (!__bluetooth_map_write_all(fds[1], buf, len)) {
+			ERR("body write failed\n");
+			close(fds[0]);
+			fds[0] = -1;
+		}
+
+		close(fds[1]);
+		return fds[0];
+	}
+
+	fd = g_file_open_tmp("bt_map_body_XXXXXX", &path, NULL);
+	if (fd < 0) {
+		ERR("temporary file failed\n");
+		return -1;
+	}
+
+	/* The fd keeps the file alive until the reader closes it */
+	unlink(path);
+	g_free(path);
+
+	if (!__bluetooth_map_write_all(fd, buf, len) ||
+			lseek(fd, 0, SEEK_SET) < 0) {
+		ERR("body write failed\n");
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+static int __bluetooth_map_sms_body_fd(int message_id,
+					dbus_uint64_t *size,
+					const char **type)
+{
+	msg_struct_t msg = NULL;
+	msg_struct_t send_opt = NULL;
+	char *buf = NULL;
+	int msg_type = 0;
+	int msg_size = 0;
+	int fd = -1;
+	size_t len;
+
+	if (g_msg_handle == NULL)
+		return -1;
+
+	msg = msg_create_struct(MSG_STRUCT_MESSAGE_INFO);
+	send_opt = msg_create_struct(MSG_STRUCT_SENDOPT);
+
+	if (msg_get_message(g_msg_handle, (msg_message_id_t)message_id,
+					msg, send_opt) != MSG_SUCCESS)
+		goto done;
+
+	msg_get_int_value(msg, MSG_MESSAGE_TYPE_INT, &msg_type);
+	*type = _bluetooth_map_msg_type_name(msg_type);
+
+	/* sized as in GetMessage, the body is never cut. msg-service
+	 * only hands out a copy, so unlike email this is not zero-copy */
+	if (msg_get_int_value(msg, MSG_MESSAGE_DATA_SIZE_INT,
+				&msg_size) != MSG_SUCCESS || msg_size < 0)
+		goto done;
+
+	buf = g_malloc0(msg_size + 1);
+
+	if (msg_get_str_value(msg, MSG_MESSAGE_SMS_DATA_STR,
+				buf, msg_size + 1) != MSG_SUCCESS)
+		goto done;
+
+	len = strlen(buf);
+
+	fd = __bluetooth_map_body_fd(buf, len);
+	if (fd >= 0)
+		*size = len;
+done:
+	g_free(buf);
+	msg_release_struct(&send_opt);
+	msg_release_struct(&msg);
+
+	return fd;
+}
+
+static int __bluetooth_map_email_body_fd(int message_id,
+					dbus_uint64_t *size)
+{
+	email_mail_data_t *mail_data = NULL;
+	struct stat st;
+	int fd = -1;
+
+	if (email_get_mail_data(message_id, &mail_data) != EMAIL_ERROR_NONE)
+		return -1;
+
+	if (mail_data->file_path_plain)
+		fd = open(mail_data->file_path_plain, O_RDONLY);
+
+	if (fd < 0 && mail_data->file_path_html)
+		fd = open(mail_data->file_path_html, O_RDONLY);
+
+	email_free_mail_data(&mail_data, 1);
+
+	if (fd < 0)
+		return -1;
+
+	if (fstat(fd, &st) < 0) {
+		close(fd);
+		return -1;
+	}
+
+	*size = st.st_size;
+
+	return fd;
+}
+
+static gboolean bluetooth_map_get_message_fd(BluetoothMapAgent *agent,
+					gchar *message_name,
+					DBusGMethodInvocation *context)
+{
+	DBusMessage *reply = NULL;
+	GError *error = NULL;
+	char *pch = NULL;
+	char *last = NULL;
+	const char *type = "EMAIL";
+	int message_id = 0;
+	int fd = -1;
+	dbus_uint64_t size = 0;
+
+	if (message_name != NULL) {
+		pch = strtok_r(message_name, "_", &last);
+		if (pch == NULL)
+			goto fail;
+
+		message_id = atoi(pch);
+		DBG("message_id %d \n", message_id);
+		pch = strtok_r(NULL, "_", &last);
+	}
+
+	if (pch == NULL)
+		goto fail;
+
+	/* Without fd passing the reply could never be sent */
+	if (!dbus_connection_can_send_type(
+			dbus_g_connection_get_connection(g_connection),
+			DBUS_TYPE_UNIX_FD)) {
+		ERR("connection can not pass fds\n");
+		goto fail;
+	}
+
+	if (!g_ascii_strncasecmp(pch, "s", 1))
+		fd = __bluetooth_map_sms_body_fd(message_id, &size, &type);
+	else if (!g_ascii_strncasecmp(pch, "e", 1))
+		fd = __bluetooth_map_email_body_fd(message_id, &size);
+
+	if (fd < 0)
+		goto fail;
+
+	/* dbus-glib can not marshal fds, the reply is built by hand */
+	reply = dbus_g_method_get_reply(context);
+	if (reply == NULL) {
+		close(fd);
+		goto fail;
+	}
+
+	if (!dbus_message_append_args(reply, DBUS_TYPE_UNIX_FD, &fd,
+					DBUS_TYPE_STRING, &type,
+					DBUS_TYPE_UINT64, &size,
+					DBUS_TYPE_INVALID)) {
+		ERR("reply append failed\n");
+		dbus_message_unref(reply);
+		close(fd);
+		goto fail;
+	}
+
+	dbus_g_method_send_reply(context, reply);
+
+	/* The message holds its own duplicate */
+	close(fd);
+
+	return TRUE;
+fail:
+	error = __bt_map_agent_error(BT_MAP_AGENT_ERROR_INTERNAL,
+				  "InternalError");
+	dbus_g_method_return_error(context, error);
+	g_error_free(error);
+	return FALSE;
+}
+
 static gboolean bluetooth_map_update_message(BluetoothMapAgent *agent,
 					DBusGMethodInvocation *context)
 {
@@ -1076,6 +1452,220 @@ done:
 	return flag;
 }
 
+static gboolean __bluetooth_map_msg_is_mms(int message_id)
+{
+	const BtMapListingEntry *entry;
+	msg_struct_t msg;
+	msg_struct_t send_opt;
+	int msg_type = 0;
+
+	/* The index knows the type, the message is only read if unknown */
+	entry = _bluetooth_map_index_find(FALSE, message_id, NULL);
+	if (entry)
+		return !g_strcmp0(entry->type, "MMS");
+
+	msg = msg_create_struct(MSG_STRUCT_MESSAGE_INFO);
+	send_opt = msg_create_struct(MSG_STRUCT_SENDOPT);
+
+	if (msg_get_message(g_msg_handle, (msg_message_id_t)message_id,
+					msg, send_opt) == MSG_SUCCESS)
+		msg_get_int_value(msg, MSG_MESSAGE_TYPE_INT, &msg_type);
+
+	msg_release_struct(&send_opt);
+	msg_release_struct(&msg);
+
+	return __bt_msg_is_mms(msg_type);
+}
+
+static gboolean __bluetooth_map_msg_set_status(int message_id,
+					int indicator, int value)
+{
+	if (g_msg_handle == NULL)
+		return FALSE;
+
+	switch (indicator) {
+	case BT_MSG_UPDATE:
+		if (msg_update_read_status(g_msg_handle, message_id,
+						value ? true : false) != MSG_SUCCESS)
+			return FALSE;
+
+		if (__bluetooth_map_msg_is_mms(message_id))
+			msg_mms_send_read_report(g_msg_handle, message_id,
+					value ? MSG_READ_REPORT_IS_READ :
+						MSG_READ_REPORT_NONE);
+		return TRUE;
+
+	case BT_MSG_DELETE:
+		/* deleted messages can not be restored */
+		if (!value)
+			return FALSE;
+
+		return msg_delete_message(g_msg_handle, message_id) ==
+								MSG_SUCCESS;
+
+	default:
+		return FALSE;
+	}
+}
+
+static gboolean __bluetooth_map_mail_location(int mail_id,
+					int *account_id, int *mailbox_id)
+{
+	email_mail_data_t *mail_data = NULL;
+
+	if (_bluetooth_map_index_find(TRUE, mail_id, mailbox_id)) {
+		*account_id = _bluetooth_map_index_account_id();
+		return TRUE;
+	}
+
+	if (email_get_mail_data(mail_id, &mail_data) != EMAIL_ERROR_NONE)
+		return FALSE;
+
+	*account_id = mail_data->account_id;
+	*mailbox_id = mail_data->mailbox_id;
+
+	email_free_mail_data(&mail_data, 1);
+
+	return TRUE;
+}
+
+static void __bluetooth_map_mail_batch_add(GPtrArray *batches,
+					int indicator, int target,
+					int value, int mail_id)
+{
+	BluetoothMapMailBatch *batch = NULL;
+	guint i;
+
+	for (i = 0; i < batches->len; i++) {
+		batch = g_ptr_array_index(batches, i);
+
+		if (batch->indicator == indicator && batch->target == target &&
+						batch->value == value)
+			break;
+
+		batch = NULL;
+	}
+
+	if (batch == NULL) {
+		batch = g_new0(BluetoothMapMailBatch, 1);
+		batch->indicator = indicator;
+		batch->target = target;
+		batch->value = value;
+		batch->ids = g_array_new(FALSE, FALSE, sizeof(int));
+
+		g_ptr_array_add(batches, batch);
+	}
+
+	g_array_append_val(batch->ids, mail_id);
+}
+
+static void __bluetooth_map_mail_batch_free(gpointer data)
+{
+	BluetoothMapMailBatch *batch = data;
+
+	g_array_free(batch->ids, TRUE);
+	g_free(batch);
+}
+
+/* Returns the number of mails left unchanged */
+static guint __bluetooth_map_mail_batch_run(BluetoothMapMailBatch *batch)
+{
+	int ret;
+
+	if (batch->indicator == BT_MSG_UPDATE)
+		ret = email_set_flags_field(batch->target,
+				(int *)batch->ids->data, batch->ids->len,
+				EMAIL_FLAGS_SEEN_FIELD, batch->value, 0);
+	else
+		ret = email_delete_mail(batch->target,
+				(int *)batch->ids->data, batch->ids->len, 1);
+
+	if (ret != EMAIL_ERROR_NONE) {
+		ERR("indicator %d on %d mails failed %d\n", batch->indicator,
+						batch->ids->len, ret);
+		return batch->ids->len;
+	}
+
+	return 0;
+}
+
+static gboolean bluetooth_map_set_messages_status(BluetoothMapAgent *agent,
+					gchar **message_names,
+					GArray *indicators,
+					GArray *values,
+					DBusGMethodInvocation *context)
+{
+	GPtrArray *batches = NULL;
+	GError *error = NULL;
+	guint failed = 0;
+	guint count;
+	guint i;
+
+	count = message_names ? g_strv_length(message_names) : 0;
+
+	if (count != indicators->len || count != values->len) {
+		error = __bt_map_agent_error(BT_MAP_AGENT_ERROR_INTERNAL,
+						"InvalidArguments");
+		dbus_g_method_return_error(context, error);
+		g_error_free(error);
+		return FALSE;
+	}
+
+	DBG("%d messages\n", count);
+
+	batches = g_ptr_array_new_with_free_func(
+					__bluetooth_map_mail_batch_free);
+
+	for (i = 0; i < count; i++) {
+		int indicator = g_array_index(indicators, gint, i);
+		int value = g_array_index(values, gint, i);
+		int message_id = atoi(message_names[i]);
+		char *suffix = strchr(message_names[i], '_');
+		int account_id = 0;
+		int mailbox_id = 0;
+
+		if (suffix == NULL) {
+			failed++;
+			continue;
+		}
+
+		if (!g_ascii_strncasecmp(suffix + 1, "s", 1)) {
+			if (!__bluetooth_map_msg_set_status(message_id,
+							indicator, value))
+				failed++;
+			continue;
+		}
+
+		if (g_ascii_strncasecmp(suffix + 1, "e", 1) ||
+		    (indicator != BT_MSG_UPDATE &&
+		     (indicator != BT_MSG_DELETE || !value)) ||
+		    !__bluetooth_map_mail_location(message_id,
+						&account_id, &mailbox_id)) {
+			failed++;
+			continue;
+		}
+
+		/* Mails are changed per account or mailbox in one call */
+		if (indicator == BT_MSG_UPDATE)
+			__bluetooth_map_mail_batch_add(batches, indicator,
+					account_id, value ? 1 : 0, message_id);
+		else
+			__bluetooth_map_mail_batch_add(batches, indicator,
+					mailbox_id, 1, message_id);
+	}
+
+	for (i = 0; i < batches->len; i++)
+		failed += __bluetooth_map_mail_batch_run(
+					g_ptr_array_index(batches, i));
+
+	g_ptr_array_free(batches, TRUE);
+
+	DBG("%d of %d messages failed\n", failed, count);
+
+	dbus_g_method_return(context, failed);
+	return TRUE;
+}
+
 static gboolean bluetooth_map_noti_registration(BluetoothMapAgent *agent,
 					gchar *remote_addr,
 					gboolean status,
@@ -1091,6 +1681,21 @@ static gboolean bluetooth_map_noti_registration(BluetoothMapAgent *agent,
 	return TRUE;
 }
 
+static gboolean bluetooth_map_get_event_stats(BluetoothMapAgent *agent,
+					DBusGMethodInvocation *context)
+{
+	BluetoothMnsEventQueue *queue = &g_mns_events;
+
+	dbus_g_method_return(context,
+			g_queue_get_length(&queue->events),
+			queue->max_depth,
+			queue->event_count,
+			queue->report_count,
+			(guint)(queue->last_latency / 1000),
+			(guint)(queue->max_latency / 1000));
+	return TRUE;
+}
+
 int main(int argc, char **argv)
 {
 	BluetoothMapAgent *bluetooth_map_obj = NULL;
@@ -0,0 +1,1048 @@
+/*
+ * Bluetooth-frwk
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact:  Hocheol Seo <hocheol.seo@samsung.com>
+ *		 Girishashok Joshi <girish.joshi@samsung.com>
+ *		 Chanyeol Park <chanyeol.park@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include <glib.h>
+
+#include <dlog.h>
+#include "vconf.h"
+
+/*Messaging Header Files*/
+#include "msg.h"
+#include "msg_storage.h"
+#include "msg_storage_types.h"
+#include "msg_types.h"
+
+/*Email Header Files*/
+#include "email-types.h"
+#include "email-api-account.h"
+#include "email-api-mailbox.h"
+#include "email-api-mail.h"
+
+#include "bluetooth_map_listing.h"
+
+#define BT_MAP_AGENT	"BT_MAP_AGENT"
+#define DBG(fmt, args...) SLOG(LOG_DEBUG, BT_MAP_AGENT,\
+				"%s():%d "fmt, __func__, __LINE__, ##args)
+#define ERR(fmt, args...) SLOG(LOG_ERROR, BT_MAP_AGENT,\
+				"%s():%d "fmt, __func__, __LINE__, ##args)
+
+#define BT_MAP_EMAIL_DEFAULTACCOUNT "db/email/defaultaccount"
+
+/* email-service filter selecting one mailbox of one account */
+#define BT_MAP_MAIL_FILTER_LEN 3
+
+/* mails read per email_get_mail_list_ex() while indexing a mailbox */
+#define BT_MAP_INDEX_MAIL_PAGE 500
+
+typedef struct {
+	msg_handle_t msg_handle;
+	GPtrArray *folders;	/* BtMapFolder in folder tree order */
+	GHashTable *names;	/* lower case requested name -> BtMapFolder */
+	gint account_id;	/* default email account, 0 if none */
+	gboolean valid;
+} BtMapFolderMap;
+
+typedef struct {
+	GArray *entries;	/* BtMapListingEntry, oldest first */
+	gboolean valid;		/* FALSE until (re)built from the service */
+} BtMapIndexFolder;
+
+typedef struct {
+	gint folder_id;		/* msg folder or mailbox holding the entry */
+	time_t time;		/* with the id, the entry's sort key */
+} BtMapIndexLocation;
+
+typedef struct {
+	GHashTable *msg_folders;	/* msg folder id -> BtMapIndexFolder */
+	GHashTable *mailboxes;		/* mailbox id -> BtMapIndexFolder */
+	GHashTable *msg_ids;		/* message id -> BtMapIndexLocation */
+	GHashTable *mail_ids;		/* mail id -> BtMapIndexLocation */
+} BtMapIndex;
+
+struct _BtMapListing {
+	GArray *entries;	/* copy of the selected slice */
+	guint size;		/* messages in the folder */
+	guint pos;		/* next entry to read */
+};
+
+static BtMapFolderMap folder_map = { 0, };
+
+static BtMapIndex map_index = { 0, };
+
+static void __bluetooth_map_index_folder_free(gpointer data);
+
+static void __bluetooth_map_index_msg_storage_cb(msg_handle_t handle,
+					msg_storage_change_type_t type,
+					msg_id_list_s *id_list,
+					void *user_param);
+
+static void __bluetooth_map_folder_free(gpointer data)
+{
+	BtMapFolder *folder = data;
+
+	g_free(folder->name);
+	g_free(folder->mailbox_name);
+	g_free(folder);
+}
+
+static BtMapFolder *__bluetooth_map_folder_add(const gchar *name)
+{
+	BtMapFolder *folder;
+
+	folder = g_new0(BtMapFolder, 1);
+	folder->name = g_strdup(name);
+	folder->msg_folder_id = -1;
+	folder->mailbox_id = -1;
+
+	g_ptr_array_add(folder_map.folders, folder);
+
+	return folder;
+}
+
+static void __bluetooth_map_folder_map_clear(void)
+{
+	if (folder_map.names) {
+		g_hash_table_destroy(folder_map.names);
+		folder_map.names = NULL;
+	}
+
+	if (folder_map.folders) {
+		g_ptr_array_free(folder_map.folders, TRUE);
+		folder_map.folders = NULL;
+	}
+
+	folder_map.account_id = 0;
+	folder_map.valid = FALSE;
+}
+
+static void __bluetooth_map_folder_map_add_mailboxes(void)
+{
+	email_mailbox_t *mailbox_list = NULL;
+	int mailbox_count = 0;
+	int i;
+	guint j;
+
+	if (email_load_default_account_id(&folder_map.account_id) !=
+							EMAIL_ERROR_NONE) {
+		folder_map.account_id = 0;
+		return;
+	}
+
+	if (email_get_mailbox_list(folder_map.account_id, EMAIL_MAILBOX_ALL,
+				&mailbox_list, &mailbox_count) !=
+							EMAIL_ERROR_NONE)
+		return;
+
+	for (i = 0; i < mailbox_count; i++) {
+		const gchar *alias = mailbox_list[i].alias;
+		BtMapFolder *folder = NULL;
+
+		if (alias == NULL || *alias == '\0')
+			continue;
+
+		/* a mailbox is listed with the msg-service folder it prefixes */
+		for (j = 0; j < folder_map.folders->len; j++) {
+			BtMapFolder *msg_folder;
+
+			msg_folder = g_ptr_array_index(folder_map.folders, j);
+			if (msg_folder->msg_folder_id < 0)
+				continue;
+
+			if (!g_ascii_strncasecmp(alias, msg_folder->name,
+							strlen(alias))) {
+				folder = msg_folder;
+				break;
+			}
+		}
+
+		if (folder == NULL)
+			folder = __bluetooth_map_folder_add(alias);
+		else if (folder->mailbox_name != NULL)
+			continue;
+
+		folder->mailbox_id = mailbox_list[i].mailbox_id;
+		folder->mailbox_name = g_strdup(mailbox_list[i].mailbox_name);
+	}
+
+	email_free_mailbox(&mailbox_list, mailbox_count);
+}
+
+static void __bluetooth_map_folder_map_build(void)
+{
+	msg_struct_list_s folder_list;
+	int i;
+
+	__bluetooth_map_folder_map_clear();
+
+	folder_map.folders = g_ptr_array_new_with_free_func(
+					__bluetooth_map_folder_free);
+	folder_map.names = g_hash_table_new_full(g_str_hash, g_str_equal,
+					g_free, NULL);
+
+	if (folder_map.msg_handle != NULL &&
+			msg_get_folder_list(folder_map.msg_handle,
+					&folder_list) == MSG_SUCCESS) {
+		for (i = 0; i < folder_list.nCount; i++) {
+			msg_struct_t p_folder = folder_list.msg_struct_info[i];
+			char name[BT_MAP_MSG_INFO_MAX] = {0,};
+			int folder_id = 0;
+
+			if (msg_get_str_value(p_folder, MSG_FOLDER_INFO_NAME_STR,
+					name, BT_MAP_MSG_INFO_MAX) != MSG_SUCCESS)
+				continue;
+
+			if (msg_get_int_value(p_folder, MSG_FOLDER_INFO_ID_INT,
+					&folder_id) != MSG_SUCCESS)
+				continue;
+
+			__bluetooth_map_folder_add(name)->msg_folder_id =
+								folder_id;
+		}
+
+		msg_release_list_struct(&folder_list);
+	}
+
+	__bluetooth_map_folder_map_add_mailboxes();
+
+	folder_map.valid = TRUE;
+
+	DBG("%d folders, email account %d\n", folder_map.folders->len,
+						folder_map.account_id);
+}
+
+static BtMapFolder *__bluetooth_map_folder_find(const gchar *name)
+{
+	BtMapFolder *folder;
+	gchar *key;
+	guint i;
+
+	/* a 0 length prefix would match the first folder */
+	if (*name == '\0')
+		return NULL;
+
+	key = g_ascii_strdown(name, -1);
+
+	folder = g_hash_table_lookup(folder_map.names, key);
+	if (folder) {
+		g_free(key);
+		return folder;
+	}
+
+	/* "sent" resolves to "SENTBOX", "Inbox" mailboxes to "inbox" */
+	for (i = 0; i < folder_map.folders->len; i++) {
+		BtMapFolder *candidate = g_ptr_array_index(folder_map.folders, i);
+		gsize len = strlen(candidate->name);
+
+		if (!g_ascii_strncasecmp(name, candidate->name, strlen(name)) ||
+				(len > 0 && !g_ascii_strncasecmp(candidate->name,
+								name, len))) {
+			folder = candidate;
+			break;
+		}
+	}
+
+	if (folder)
+		g_hash_table_insert(folder_map.names, key, folder);
+	else
+		g_free(key);
+
+	return folder;
+}
+
+static void __bluetooth_map_default_account_changed(keynode_t *node,
+							void *user_data)
+{
+	DBG("+\n");
+
+	folder_map.valid = FALSE;
+	g_hash_table_remove_all(map_index.mailboxes);
+	g_hash_table_remove_all(map_index.mail_ids);
+}
+
+const GPtrArray *_bluetooth_map_folder_map_refresh(void)
+{
+	__bluetooth_map_folder_map_build();
+
+	return folder_map.folders;
+}
+
+const BtMapFolder *_bluetooth_map_folder_lookup(const gchar *folder_path)
+{
+	const gchar *name;
+	BtMapFolder *folder;
+
+	if (folder_path == NULL)
+		return NULL;
+
+	name = strrchr(folder_path, '/');
+	if (name == NULL)
+		name = folder_path;
+	else
+		name++;
+
+	if (*name == '\0') {
+		ERR("empty folder name in %s\n", folder_path);
+		return NULL;
+	}
+
+	if (!folder_map.valid)
+		__bluetooth_map_folder_map_build();
+
+	folder = __bluetooth_map_folder_find(name);
+	if (folder == NULL) {
+		/* mailboxes may have been created since the map was built */
+		__bluetooth_map_folder_map_build();
+		folder = __bluetooth_map_folder_find(name);
+	}
+
+	if (folder == NULL)
+		ERR("no folder %s\n", name);
+
+	return folder;
+}
+
+
+static void __bluetooth_map_mail_filter(gint account_id,
+					gchar *mailbox_name,
+					email_list_filter_t *filter_list)
+{
+	memset(filter_list, 0,
+		sizeof(email_list_filter_t) * BT_MAP_MAIL_FILTER_LEN);
+
+	filter_list[0].list_filter_item_type = EMAIL_LIST_FILTER_ITEM_RULE;
+	filter_list[0].list_filter_item.rule.target_attribute = EMAIL_MAIL_ATTRIBUTE_ACCOUNT_ID;
+	filter_list[0].list_filter_item.rule.rule_type = EMAIL_LIST_FILTER_RULE_EQUAL;
+	filter_list[0].list_filter_item.rule.key_value.integer_type_value = account_id;
+
+	filter_list[1].list_filter_item_type = EMAIL_LIST_FILTER_ITEM_OPERATOR;
+	filter_list[1].list_filter_item.operator_type = EMAIL_LIST_FILTER_OPERATOR_AND;
+
+	filter_list[2].list_filter_item_type = EMAIL_LIST_FILTER_ITEM_RULE;
+	filter_list[2].list_filter_item.rule.target_attribute = EMAIL_MAIL_ATTRIBUTE_MAILBOX_NAME;
+	filter_list[2].list_filter_item.rule.rule_type = EMAIL_LIST_FILTER_RULE_EQUAL;
+	filter_list[2].list_filter_item.rule.key_value.string_type_value = mailbox_name;
+	filter_list[2].list_filter_item.rule.case_sensitivity = true;
+}
+
+static gint __bluetooth_map_entry_compare(gconstpointer a, gconstpointer b)
+{
+	const BtMapListingEntry *entry_a = a;
+	const BtMapListingEntry *entry_b = b;
+
+	if (entry_a->time != entry_b->time)
+		return (entry_a->time < entry_b->time) ? -1 : 1;
+
+	return entry_a->id - entry_b->id;
+}
+
+static gboolean __bluetooth_map_msg_entry(msg_struct_t msg,
+					BtMapListingEntry *entry)
+{
+	int dptime = 0;
+	int m_type = 0;
+	int size = 0;
+	bool read = false;
+
+	memset(entry, 0, sizeof(BtMapListingEntry));
+
+	if (msg_get_int_value(msg, MSG_MESSAGE_ID_INT, &entry->id) != MSG_SUCCESS)
+		return FALSE;
+
+	snprintf(entry->handle, sizeof(entry->handle), "%d%s",
+					entry->id, BT_MAP_SMS);
+
+	if (msg_get_int_value(msg, MSG_MESSAGE_DISPLAY_TIME_INT,
+						&dptime) == MSG_SUCCESS) {
+		entry->time = dptime;
+		_bluetooth_map_timestamp(entry->time, entry->datetime);
+	}
+
+	if (msg_get_bool_value(msg, MSG_MESSAGE_READ_BOOL, &read) == MSG_SUCCESS)
+		entry->read = read;
+
+	if (msg_get_int_value(msg, MSG_MESSAGE_DATA_SIZE_INT, &size) == MSG_SUCCESS)
+		entry->size = size;
+
+	msg_get_int_value(msg, MSG_MESSAGE_TYPE_INT, &m_type);
+	g_strlcpy(entry->type, _bluetooth_map_msg_type_name(m_type),
+						sizeof(entry->type));
+
+	return TRUE;
+}
+
+static void __bluetooth_map_mail_entry(gint mail_id,
+					time_t date_time,
+					gboolean read,
+					BtMapListingEntry *entry)
+{
+	memset(entry, 0, sizeof(BtMapListingEntry));
+
+	entry->id = mail_id;
+	entry->time = date_time;
+	entry->read = read;
+
+	snprintf(entry->handle, sizeof(entry->handle), "%d%s",
+					mail_id, BT_MAP_EMAIL);
+	g_strlcpy(entry->type, "EMAIL", sizeof(entry->type));
+	_bluetooth_map_timestamp(date_time, entry->datetime);
+}
+
+static void __bluetooth_map_index_folder_free(gpointer data)
+{
+	BtMapIndexFolder *index_folder = data;
+
+	g_array_free(index_folder->entries, TRUE);
+	g_free(index_folder);
+}
+
+static BtMapIndexFolder *__bluetooth_map_index_folder(GHashTable *folders,
+							gint id)
+{
+	BtMapIndexFolder *index_folder;
+
+	index_folder = g_hash_table_lookup(folders, GINT_TO_POINTER(id));
+	if (index_folder)
+		return index_folder;
+
+	index_folder = g_new0(BtMapIndexFolder, 1);
+	index_folder->entries = g_array_new(FALSE, FALSE,
+					sizeof(BtMapListingEntry));
+
+	g_hash_table_insert(folders, GINT_TO_POINTER(id), index_folder);
+
+	return index_folder;
+}
+
+/* Position of the first entry not sorted before key */
+static guint __bluetooth_map_index_lower_bound(BtMapIndexFolder *index_folder,
+					const BtMapListingEntry *key)
+{
+	guint low = 0;
+	guint high = index_folder->entries->len;
+
+	while (low < high) {
+		guint mid = (low + high) / 2;
+
+		if (__bluetooth_map_entry_compare(&g_array_index(
+				index_folder->entries, BtMapListingEntry, mid),
+				key) < 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+static void __bluetooth_map_index_locate(GHashTable *ids, gint folder_id,
+					const BtMapListingEntry *entry)
+{
+	BtMapIndexLocation *location;
+
+	location = g_new0(BtMapIndexLocation, 1);
+	location->folder_id = folder_id;
+	location->time = entry->time;
+
+	g_hash_table_insert(ids, GINT_TO_POINTER(entry->id), location);
+}
+
+/* Drops the locations still pointing into a folder about to be rebuilt */
+static void __bluetooth_map_index_forget(GHashTable *ids, gint folder_id,
+					BtMapIndexFolder *index_folder)
+{
+	guint i;
+
+	for (i = 0; i < index_folder->entries->len; i++) {
+		gint id = g_array_index(index_folder->entries,
+					BtMapListingEntry, i).id;
+		BtMapIndexLocation *location;
+
+		location = g_hash_table_lookup(ids, GINT_TO_POINTER(id));
+		if (location && location->folder_id == folder_id)
+			g_hash_table_remove(ids, GINT_TO_POINTER(id));
+	}
+}
+
+/* Finds the entry of id through its location, sets pos to its position */
+static BtMapIndexFolder *__bluetooth_map_index_lookup(GHashTable *folders,
+						GHashTable *ids,
+						gint id,
+						gint *folder_id,
+						guint *pos)
+{
+	BtMapIndexLocation *location;
+	BtMapIndexFolder *index_folder;
+	BtMapListingEntry key;
+	guint i;
+
+	location = g_hash_table_lookup(ids, GINT_TO_POINTER(id));
+	if (location == NULL)
+		return NULL;
+
+	index_folder = g_hash_table_lookup(folders,
+				GINT_TO_POINTER(location->folder_id));
+	if (index_folder == NULL)
+		return NULL;
+
+	key.id = id;
+	key.time = location->time;
+
+	i = __bluetooth_map_index_lower_bound(index_folder, &key);
+	if (i >= index_folder->entries->len ||
+	    g_array_index(index_folder->entries, BtMapListingEntry, i).id != id)
+		return NULL;
+
+	if (folder_id)
+		*folder_id = location->folder_id;
+	*pos = i;
+
+	return index_folder;
+}
+
+static void __bluetooth_map_index_insert(GHashTable *ids,
+					gint folder_id,
+					BtMapIndexFolder *index_folder,
+					const BtMapListingEntry *entry)
+{
+	g_array_insert_vals(index_folder->entries,
+		__bluetooth_map_index_lower_bound(index_folder, entry),
+		entry, 1);
+
+	__bluetooth_map_index_locate(ids, folder_id, entry);
+}
+
+static void __bluetooth_map_index_remove(GHashTable *folders,
+					GHashTable *ids, gint id)
+{
+	BtMapIndexFolder *index_folder;
+	guint pos;
+
+	index_folder = __bluetooth_map_index_lookup(folders, ids, id,
+							NULL, &pos);
+	if (index_folder)
+		g_array_remove_index(index_folder->entries, pos);
+
+	g_hash_table_remove(ids, GINT_TO_POINTER(id));
+}
+
+static gboolean __bluetooth_map_index_build_msg_folder(
+					BtMapIndexFolder *index_folder,
+					gint folder_id)
+{
+	msg_struct_list_s msg_list;
+	int i;
+
+	if (folder_map.msg_handle == NULL)
+		return FALSE;
+
+	if (msg_get_folder_view_list(folder_map.msg_handle, folder_id,
+					NULL, &msg_list) != MSG_SUCCESS) {
+		ERR("msg_get_folder_view_list failed, folder %d\n", folder_id);
+		return FALSE;
+	}
+
+	__bluetooth_map_index_forget(map_index.msg_ids, folder_id,
+							index_folder);
+	g_array_set_size(index_folder->entries, 0);
+
+	for (i = 0; i < msg_list.nCount; i++) {
+		BtMapListingEntry entry;
+
+		if (!__bluetooth_map_msg_entry(msg_list.msg_struct_info[i],
+								&entry))
+			continue;
+
+		g_array_append_val(index_folder->entries, entry);
+		__bluetooth_map_index_locate(map_index.msg_ids, folder_id,
+								&entry);
+	}
+
+	msg_release_list_struct(&msg_list);
+
+	g_array_sort(index_folder->entries, __bluetooth_map_entry_compare);
+	index_folder->valid = TRUE;
+
+	DBG("msg folder %d: %d messages\n", folder_id,
+				index_folder->entries->len);
+
+	return TRUE;
+}
+
+static gboolean __bluetooth_map_index_build_mailbox(
+					BtMapIndexFolder *index_folder,
+					const BtMapFolder *folder)
+{
+	email_list_filter_t filter_list[BT_MAP_MAIL_FILTER_LEN];
+	email_list_sorting_rule_t sorting_rule;
+	int total = 0;
+	int unseen = 0;
+	int start;
+	int ret;
+
+	if (folder_map.account_id <= 0)
+		return FALSE;
+
+	__bluetooth_map_mail_filter(folder_map.account_id,
+				folder->mailbox_name, filter_list);
+
+	memset(&sorting_rule, 0, sizeof(sorting_rule));
+	sorting_rule.target_attribute = EMAIL_MAIL_ATTRIBUTE_DATE_TIME;
+	sorting_rule.sort_order = EMAIL_SORT_ORDER_ASCEND;
+
+	ret = email_count_mail(filter_list, BT_MAP_MAIL_FILTER_LEN,
+				&total, &unseen);
+	if (ret != EMAIL_ERROR_NONE) {
+		ERR("email_count_mail error = %d\n", ret);
+		return FALSE;
+	}
+
+	__bluetooth_map_index_forget(map_index.mail_ids, folder->mailbox_id,
+							index_folder);
+	g_array_set_size(index_folder->entries, 0);
+
+	/* read page by page, a large mailbox is never listed at once */
+	for (start = 0; start < total; ) {
+		email_mail_list_item_t *mail_list = NULL;
+		int mail_count = 0;
+		int i;
+
+		ret = email_get_mail_list_ex(filter_list, BT_MAP_MAIL_FILTER_LEN,
+					&sorting_rule, 1,
+					start, BT_MAP_INDEX_MAIL_PAGE,
+					&mail_list, &mail_count);
+		if (ret != EMAIL_ERROR_NONE || mail_count <= 0) {
+			ERR("email_get_mail_list_ex error = %d\n", ret);
+			g_free(mail_list);
+			return FALSE;
+		}
+
+		for (i = 0; i < mail_count; i++) {
+			BtMapListingEntry entry;
+
+			__bluetooth_map_mail_entry(mail_list[i].mail_id,
+					mail_list[i].date_time,
+					mail_list[i].flags_seen_field,
+					&entry);
+			g_array_append_val(index_folder->entries, entry);
+			__bluetooth_map_index_locate(map_index.mail_ids,
+					folder->mailbox_id, &entry);
+		}
+
+		g_free(mail_list);
+		start += mail_count;
+	}
+
+	g_array_sort(index_folder->entries, __bluetooth_map_entry_compare);
+	index_folder->valid = TRUE;
+
+	DBG("mailbox %s: %d mails\n", folder->mailbox_name,
+				index_folder->entries->len);
+
+	return TRUE;
+}
+
+/* Returns the index of the folder, built on first use or after a reset */
+static BtMapIndexFolder *__bluetooth_map_index_msg_folder(
+					const BtMapFolder *folder)
+{
+	BtMapIndexFolder *index_folder;
+
+	index_folder = __bluetooth_map_index_folder(map_index.msg_folders,
+						folder->msg_folder_id);
+
+	if (!index_folder->valid &&
+	    !__bluetooth_map_index_build_msg_folder(index_folder,
+						folder->msg_folder_id))
+		return NULL;
+
+	return index_folder;
+}
+
+static BtMapIndexFolder *__bluetooth_map_index_mailbox(
+					const BtMapFolder *folder)
+{
+	BtMapIndexFolder *index_folder;
+
+	index_folder = __bluetooth_map_index_folder(map_index.mailboxes,
+						folder->mailbox_id);
+
+	if (!index_folder->valid &&
+	    !__bluetooth_map_index_build_mailbox(index_folder, folder))
+		return NULL;
+
+	return index_folder;
+}
+
+static void __bluetooth_map_index_msg_storage_cb(msg_handle_t handle,
+					msg_storage_change_type_t type,
+					msg_id_list_s *id_list,
+					void *user_param)
+{
+	int i;
+
+	if (id_list == NULL || map_index.msg_folders == NULL)
+		return;
+
+	DBG("type %d, %d messages\n", type, id_list->nCount);
+
+	for (i = 0; i < id_list->nCount; i++) {
+		msg_message_id_t msg_id = id_list->msgIdList[i];
+		msg_struct_t msg;
+		msg_struct_t send_opt;
+
+		switch (type) {
+		case MSG_STORAGE_CHANGE_INSERT:
+		case MSG_STORAGE_CHANGE_UPDATE:
+			msg = msg_create_struct(MSG_STRUCT_MESSAGE_INFO);
+			send_opt = msg_create_struct(MSG_STRUCT_SENDOPT);
+
+			if (msg_get_message(handle, msg_id, msg,
+						send_opt) == MSG_SUCCESS)
+				_bluetooth_map_index_msg_update(msg);
+			else
+				__bluetooth_map_index_remove(
+						map_index.msg_folders,
+						map_index.msg_ids, msg_id);
+
+			msg_release_struct(&send_opt);
+			msg_release_struct(&msg);
+			break;
+
+		case MSG_STORAGE_CHANGE_DELETE:
+			__bluetooth_map_index_remove(map_index.msg_folders,
+						map_index.msg_ids, msg_id);
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+void _bluetooth_map_index_msg_update(msg_struct_t msg)
+{
+	BtMapIndexFolder *index_folder;
+	BtMapListingEntry entry;
+	int folder_id = 0;
+
+	if (map_index.msg_folders == NULL)
+		return;
+
+	if (!__bluetooth_map_msg_entry(msg, &entry))
+		return;
+
+	if (msg_get_int_value(msg, MSG_MESSAGE_FOLDER_ID_INT,
+					&folder_id) != MSG_SUCCESS)
+		return;
+
+	/* the message may have been moved from another folder */
+	__bluetooth_map_index_remove(map_index.msg_folders,
+					map_index.msg_ids, entry.id);
+
+	/* folders not built yet read the message when they are */
+	index_folder = g_hash_table_lookup(map_index.msg_folders,
+					GINT_TO_POINTER(folder_id));
+	if (index_folder && index_folder->valid)
+		__bluetooth_map_index_insert(map_index.msg_ids, folder_id,
+						index_folder, &entry);
+}
+
+void _bluetooth_map_index_mail_changed(gint type, gint mail_id)
+{
+	email_mail_data_t *mail_data = NULL;
+	BtMapIndexFolder *index_folder;
+	BtMapListingEntry entry;
+	GHashTableIter iter;
+	gpointer value;
+
+	if (map_index.mailboxes == NULL)
+		return;
+
+	switch (type) {
+	case NOTI_MAIL_ADD:
+	case NOTI_MAIL_UPDATE:
+		__bluetooth_map_index_remove(map_index.mailboxes,
+					map_index.mail_ids, mail_id);
+
+		if (email_get_mail_data(mail_id, &mail_data) != EMAIL_ERROR_NONE)
+			break;
+
+		index_folder = g_hash_table_lookup(map_index.mailboxes,
+					GINT_TO_POINTER(mail_data->mailbox_id));
+		if (index_folder && index_folder->valid) {
+			__bluetooth_map_mail_entry(mail_id,
+					mail_data->date_time,
+					mail_data->flags_seen_field,
+					&entry);
+			__bluetooth_map_index_insert(map_index.mail_ids,
+					mail_data->mailbox_id,
+					index_folder, &entry);
+		}
+
+		email_free_mail_data(&mail_data, 1);
+		break;
+
+	case NOTI_MAIL_DELETE:
+	case NOTI_MAIL_DELETE_ALL:
+	case NOTI_MAIL_MOVE:
+	case NOTI_MAIL_FIELD_UPDATE:
+		/* these name their mails in a list that differs per event,
+		 * the mailboxes are read again when they are next listed */
+		g_hash_table_iter_init(&iter, map_index.mailboxes);
+		while (g_hash_table_iter_next(&iter, NULL, &value))
+			((BtMapIndexFolder *)value)->valid = FALSE;
+		break;
+
+	default:
+		break;
+	}
+}
+
+const BtMapListingEntry *_bluetooth_map_index_find(gboolean email,
+						gint id,
+						gint *folder_id)
+{
+	BtMapIndexFolder *index_folder;
+	GHashTable *folders;
+	GHashTable *ids;
+	guint pos;
+
+	folders = email ? map_index.mailboxes : map_index.msg_folders;
+	ids = email ? map_index.mail_ids : map_index.msg_ids;
+	if (folders == NULL)
+		return NULL;
+
+	index_folder = __bluetooth_map_index_lookup(folders, ids, id,
+							folder_id, &pos);
+	if (index_folder == NULL || !index_folder->valid)
+		return NULL;
+
+	return &g_array_index(index_folder->entries, BtMapListingEntry, pos);
+}
+
+gint _bluetooth_map_index_account_id(void)
+{
+	return folder_map.account_id;
+}
+
+void _bluetooth_map_folder_map_init(msg_handle_t msg_handle)
+{
+	guint i;
+
+	folder_map.msg_handle = msg_handle;
+	folder_map.valid = FALSE;
+
+	map_index.msg_folders = g_hash_table_new_full(g_direct_hash,
+				g_direct_equal, NULL,
+				__bluetooth_map_index_folder_free);
+	map_index.mailboxes = g_hash_table_new_full(g_direct_hash,
+				g_direct_equal, NULL,
+				__bluetooth_map_index_folder_free);
+	map_index.msg_ids = g_hash_table_new_full(g_direct_hash,
+				g_direct_equal, NULL, g_free);
+	map_index.mail_ids = g_hash_table_new_full(g_direct_hash,
+				g_direct_equal, NULL, g_free);
+
+	if (msg_handle != NULL &&
+	    msg_reg_storage_change_callback(msg_handle,
+				__bluetooth_map_index_msg_storage_cb,
+				NULL) != MSG_SUCCESS)
+		ERR("msg_reg_storage_change_callback failed\n");
+
+	vconf_notify_key_changed(BT_MAP_EMAIL_DEFAULTACCOUNT,
+			__bluetooth_map_default_account_changed, NULL);
+
+	/* Every listing after this is served from the index */
+	__bluetooth_map_folder_map_build();
+
+	for (i = 0; i < folder_map.folders->len; i++) {
+		BtMapFolder *folder = g_ptr_array_index(folder_map.folders, i);
+
+		if (folder->msg_folder_id >= 0)
+			__bluetooth_map_index_msg_folder(folder);
+
+		if (folder->mailbox_id >= 0)
+			__bluetooth_map_index_mailbox(folder);
+	}
+}
+
+void _bluetooth_map_folder_map_deinit(void)
+{
+	vconf_ignore_key_changed(BT_MAP_EMAIL_DEFAULTACCOUNT,
+			__bluetooth_map_default_account_changed);
+
+	__bluetooth_map_folder_map_clear();
+	folder_map.msg_handle = NULL;
+
+	if (map_index.msg_folders) {
+		g_hash_table_destroy(map_index.msg_folders);
+		map_index.msg_folders = NULL;
+	}
+
+	if (map_index.mailboxes) {
+		g_hash_table_destroy(map_index.mailboxes);
+		map_index.mailboxes = NULL;
+	}
+
+	if (map_index.msg_ids) {
+		g_hash_table_destroy(map_index.msg_ids);
+		map_index.msg_ids = NULL;
+	}
+
+	if (map_index.mail_ids) {
+		g_hash_table_destroy(map_index.mail_ids);
+		map_index.mail_ids = NULL;
+	}
+}
+
+BtMapListing *_bluetooth_map_listing_new(const gchar *folder_path,
+					guint16 max_list_count,
+					guint16 list_start_offset)
+{
+	const BtMapFolder *folder;
+	BtMapIndexFolder *msg_index = NULL;
+	BtMapIndexFolder *mail_index = NULL;
+	BtMapListing *listing;
+	guint msg_len = 0;
+	guint mail_len = 0;
+	guint start;
+	guint end;
+
+	folder = _bluetooth_map_folder_lookup(folder_path);
+	if (folder == NULL)
+		return NULL;
+
+	if (folder->msg_folder_id >= 0)
+		msg_index = __bluetooth_map_index_msg_folder(folder);
+
+	if (folder->mailbox_id >= 0)
+		mail_index = __bluetooth_map_index_mailbox(folder);
+
+	if (msg_index == NULL && mail_index == NULL)
+		return NULL;
+
+	if (msg_index)
+		msg_len = msg_index->entries->len;
+	if (mail_index)
+		mail_len = mail_index->entries->len;
+
+	listing = g_new0(BtMapListing, 1);
+	listing->size = msg_len + mail_len;
+
+	start = MIN(list_start_offset, listing->size);
+	if (max_list_count == BT_MAP_LISTING_UNRESTRICTED)
+		end = listing->size;
+	else
+		end = MIN(start + max_list_count, listing->size);
+
+	/* Messages come first, then mails. The slice is copied so index
+	 * updates between two chunks do not shift the listing */
+	listing->entries = g_array_sized_new(FALSE, FALSE,
+				sizeof(BtMapListingEntry), end - start);
+
+	if (start < msg_len)
+		g_array_append_vals(listing->entries,
+				&g_array_index(msg_index->entries,
+						BtMapListingEntry, start),
+				MIN(end, msg_len) - start);
+
+	if (end > msg_len) {
+		guint mail_start = MAX(start, msg_len) - msg_len;
+
+		g_array_append_vals(listing->entries,
+				&g_array_index(mail_index->entries,
+						BtMapListingEntry, mail_start),
+				end - msg_len - mail_start);
+	}
+
+	DBG("%s: %d messages, %d mails, selected [%d, %d)\n", folder->name,
+					msg_len, mail_len, start, end);
+
+	return listing;
+}
+
+guint _bluetooth_map_listing_size(BtMapListing *listing)
+{
+	return listing->size;
+}
+
+guint _bluetooth_map_listing_count(BtMapListing *listing)
+{
+	return listing->entries->len;
+}
+
+gboolean _bluetooth_map_listing_read(BtMapListing *listing,
+				GArray *entries,
+				guint max)
+{
+	guint count;
+
+	count = MIN(max, listing->entries->len - listing->pos);
+
+	g_array_append_vals(entries, &g_array_index(listing->entries,
+				BtMapListingEntry, listing->pos), count);
+	listing->pos += count;
+
+	return listing->pos < listing->entries->len;
+}
+
+void _bluetooth_map_listing_free(BtMapListing *listing)
+{
+	if (listing == NULL)
+		return;
+
+	g_array_free(listing->entries, TRUE);
+	g_free(listing);
+}
+
+const gchar *_bluetooth_map_msg_type_name(int msg_type)
+{
+	switch (msg_type) {
+	case MSG_TYPE_SMS:
+		return "SMS_GSM";
+	case MSG_TYPE_MMS:
+		return "MMS";
+	default:
+		return "UNKNOWN";
+	}
+}
+
+void _bluetooth_map_timestamp(time_t ltime, gchar *timestamp)
+{
+	struct tm local_time;
+	int year;
+	int month;
+
+	if (!localtime_r(&ltime, &local_time))
+		return;
+
+	year = local_time.tm_year + 1900; /* years since 1900 */
+	month = local_time.tm_mon + 1; /* months since January */
+	snprintf(timestamp, BT_MAP_TIMESTAMP_MAX_LEN, "%04d%02d%02dT%02d%02d%02d",
+				year, month,
+				local_time.tm_mday, local_time.tm_hour,
+				local_time.tm_min, local_time.tm_sec);
+}
@@ -0,0 +1,112 @@
+/*
+ * Bluetooth-frwk
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact:  Hocheol Seo <hocheol.seo@samsung.com>
+ *		 Girishashok Joshi <girish.joshi@samsung.com>
+ *		 Chanyeol Park <chanyeol.park@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __DEF_BT_MAP_LISTING_H_
+#define __DEF_BT_MAP_LISTING_H_
+
+#include <time.h>
+#include <glib.h>
+
+#include "msg.h"
+#include "msg_storage_types.h"
+
+#define BT_MAP_SMS "_s"
+#define BT_MAP_EMAIL "_e"
+#define BT_MAP_MSG_INFO_MAX 256
+#define BT_MAP_MSG_HANDLE_MAX 16
+#define BT_MAP_MSG_TYPE_MAX 16
+#define BT_MAP_TIMESTAMP_MAX_LEN 16
+
+/* MaxListCount asking for every message of the folder */
+#define BT_MAP_LISTING_UNRESTRICTED 65535
+
+typedef struct {
+	gchar *name;		/* folder name reported in the folder tree */
+	gint msg_folder_id;	/* -1 when msg-service has no such folder */
+	gint mailbox_id;	/* -1 when email-service has no such mailbox */
+	gchar *mailbox_name;
+} BtMapFolder;
+
+typedef struct {
+	gint id;		/* msg-service message id or email-service mail id */
+	time_t time;		/* index order, oldest first */
+	gboolean read;
+	guint size;		/* 0 for mails, mail list items carry no size */
+	gchar handle[BT_MAP_MSG_HANDLE_MAX];
+	gchar type[BT_MAP_MSG_TYPE_MAX];
+	gchar datetime[BT_MAP_TIMESTAMP_MAX_LEN];
+} BtMapListingEntry;
+
+typedef struct _BtMapListing BtMapListing;
+
+/* Builds the folder map and indexes every folder */
+void _bluetooth_map_folder_map_init(msg_handle_t msg_handle);
+
+void _bluetooth_map_folder_map_deinit(void);
+
+/* Folders in folder tree order, owned by the map until the next refresh */
+const GPtrArray *_bluetooth_map_folder_map_refresh(void);
+
+/* Resolves the last component of a MAP folder path, NULL if unknown */
+const BtMapFolder *_bluetooth_map_folder_lookup(const gchar *folder_path);
+
+/* Indexes a new or changed message, msg is a MSG_STRUCT_MESSAGE_INFO */
+void _bluetooth_map_index_msg_update(msg_struct_t msg);
+
+/* Applies an email-service storage notification */
+void _bluetooth_map_index_mail_changed(gint type, gint mail_id);
+
+/* Returns the indexed entry of a message (email FALSE) or mail and sets
+ * folder_id to the msg folder or mailbox holding it, NULL if unknown */
+const BtMapListingEntry *_bluetooth_map_index_find(gboolean email,
+						gint id,
+						gint *folder_id);
+
+/* Email account the mailboxes of the index belong to, 0 if none */
+gint _bluetooth_map_index_account_id(void);
+
+/* Copies the selected slice of the folder index */
+BtMapListing *_bluetooth_map_listing_new(const gchar *folder_path,
+					guint16 max_list_count,
+					guint16 list_start_offset);
+
+/* Number of messages in the folder */
+guint _bluetooth_map_listing_size(BtMapListing *listing);
+
+/* Number of messages selected by max_list_count and list_start_offset */
+guint _bluetooth_map_listing_count(BtMapListing *listing);
+
+/* Appends up to max BtMapListingEntry to entries,
+ * returns FALSE once every selected message was read */
+gboolean _bluetooth_map_listing_read(BtMapListing *listing,
+				GArray *entries,
+				guint max);
+
+void _bluetooth_map_listing_free(BtMapListing *listing);
+
+/* MAP message type of a msg-service MSG_MESSAGE_TYPE_INT value */
+const gchar *_bluetooth_map_msg_type_name(int msg_type);
+
+void _bluetooth_map_timestamp(time_t ltime, gchar *timestamp);
+
+#endif
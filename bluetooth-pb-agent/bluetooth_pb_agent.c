@@ -29,6 +29,7 @@
 #include <signal.h>
 #include <glib.h>
 #include <dbus/dbus-glib.h>
+#include <dbus/dbus-glib-lowlevel.h>
 #include <contacts-svc.h>
 
 #include <sys/types.h>
@@ -37,9 +38,16 @@
 
 #include "bluetooth_pb_agent.h"
 #include "bluetooth_pb_vcard.h"
+#include "bluetooth_pb_vcard_cache.h"
+#include "bluetooth_pb_search.h"
+#include "bluetooth_pb_import.h"
 
 #define BLUETOOTH_PB_AGENT_TIMEOUT 600
 
+#define BLUETOOTH_PB_UNRESTRICTED 65535
+#define BLUETOOTH_PB_CHUNK_SIZE 50
+#define BLUETOOTH_PB_SIGNAL_CHUNK "PhonebookChunk"
+
 typedef enum {
 	TELECOM_NONE = 0,
 	TELECOM_PB,
@@ -62,6 +70,24 @@ typedef struct {
 	void (*clear) (BluetoothPbAgent *agent);
 } BluetoothPbAgentClass;
 
+typedef struct {
+	PhoneBookType pb_type;
+	guint64 filter;
+	guint8 format;
+	GArray *ids;		/* contact or phonelog ids of the requested page */
+	guint rendered;		/* ids already sent */
+	guint chunk_size;
+	guint request_id;
+	gchar *destination;	/* unique name of the requester */
+	DBusGConnection *conn;	/* the chunks are sent on */
+} BluetoothPbPage;
+
+typedef struct {
+	GArray *ids;		/* contact or phonelog id of handle n at n - 1 */
+	guint generation;	/* source generation the ids were built from */
+	BtPbSearchView *search;	/* names and numbers of the handles */
+} BluetoothPbFolderIndex;
+
 
 enum {
 	CLEAR,
@@ -97,9 +123,19 @@ static guint signals[LAST_SIGNAL] = { 0 };
 
 static GMainLoop *mainloop = NULL;
 
-static GHashTable *contact_list_hash = NULL;
+static guint g_page_request_id = 0;
+
+static BluetoothPbFolderIndex folder_index[TELECOM_CCH + 1];
+
+/* phonelog id -> TELECOM_ICH, OCH or MCH, built with the call folders */
+static GHashTable *call_type_hash = NULL;
+
+/* unseen missed calls, counted with the call folders */
+static guint new_missed_calls = 0;
 
-static PhoneBookType g_current_pb_type = TELECOM_NONE;
+/* Bumped by the contacts-svc change callbacks */
+static guint contact_generation = 1;
+static guint call_generation = 1;
 
 static void bluetooth_pb_agent_finalize(GObject *obj);
 
@@ -114,6 +150,15 @@ static gboolean bluetooth_pb_get_phonebook(BluetoothPbAgent *agent,
 					guint16 list_start_offset,
 					DBusGMethodInvocation *context);
 
+static gboolean bluetooth_pb_get_phonebook_chunked(BluetoothPbAgent *agent,
+						const char *name,
+						guint64 filter,
+						guint8 format,
+						guint16 max_list_count,
+						guint16 list_start_offset,
+						guint16 chunk_size,
+						DBusGMethodInvocation *context);
+
 static gboolean bluetooth_pb_get_phonebook_size(BluetoothPbAgent *agent,
 						const char *name,
 						DBusGMethodInvocation *context);
@@ -122,6 +167,12 @@ static gboolean bluetooth_pb_get_phonebook_list(BluetoothPbAgent *agent,
 						const char *name,
 						DBusGMethodInvocation *context);
 
+static gboolean bluetooth_pb_get_phonebook_list_search(BluetoothPbAgent *agent,
+						const char *name,
+						guint8 search_attribute,
+						const gchar *search_value,
+						DBusGMethodInvocation *context);
+
 static gboolean bluetooth_pb_get_phonebook_entry(BluetoothPbAgent *agent,
 						const gchar *folder,
 						const gchar *id,
@@ -170,40 +221,47 @@ static unsigned int __bluetooth_pb_get_missed_call_size(void);
 
 static unsigned int __bluetooth_pb_get_combined_call_size(void);
 
+static guint __bluetooth_pb_get_new_missed_calls(PhoneBookType pb_type);
 
-static GPtrArray *__bluetooth_pb_get_contact_vcards(BluetoothPbAgent *agent,
-						guint64 filter,
-						guint8 format,
-						guint16 max_list_count,
-						guint16 list_start_offset);
+static GArray *__bluetooth_pb_page_collect(PhoneBookType pb_type,
+					guint16 max_list_count,
+					guint16 list_start_offset);
+
+static gchar *__bluetooth_pb_page_render(PhoneBookType pb_type,
+					gint id,
+					guint64 filter,
+					guint8 format);
+
+static GPtrArray *__bluetooth_pb_get_vcards(PhoneBookType pb_type,
+					guint64 filter,
+					guint8 format,
+					guint16 max_list_count,
+					guint16 list_start_offset);
+
+static void __bluetooth_pb_page_free(BluetoothPbPage *page);
+
+static gboolean __bluetooth_pb_page_stream(gpointer user_data);
+
+static PhoneBookType __bluetooth_pb_call_type(gint log_type);
+
+static const gchar *__bluetooth_pb_call_attr(PhoneBookType call_type);
+
+static guint __bluetooth_pb_folder_generation(PhoneBookType pb_type);
 
-static GPtrArray *__bluetooth_pb_get_incoming_call_vcards(BluetoothPbAgent *agent,
-							guint64 filter,
-							guint8 format,
-							guint16 max_list_count,
-							guint16 list_start_offset);
+static void __bluetooth_pb_folder_index_free(PhoneBookType pb_type);
 
-static GPtrArray *__bluetooth_pb_get_outgoing_call_vcards(BluetoothPbAgent *agent,
-							guint64 filter,
-							guint8 format,
-							guint16 max_list_count,
-							guint16 list_start_offset);
+static void __bluetooth_pb_contact_index_build(void);
 
-static GPtrArray *__bluetooth_pb_get_missed_call_vcards(BluetoothPbAgent *agent,
-							guint64 filter,
-							guint8 format,
-							guint16 max_list_count,
-							guint16 list_start_offset);
+static void __bluetooth_pb_call_index_build(void);
 
-static GPtrArray *__bluetooth_pb_get_combined_call_vcards(BluetoothPbAgent *agent,
-							guint64 filter,
-							guint8 format,
-							guint16 max_list_count,
-							guint16 list_start_offset);
+static GArray *__bluetooth_pb_folder_index_get(PhoneBookType pb_type);
 
-static void __bluetooth_pb_create_contact_index(PhoneBookType pb_type);
+static const BtPbSearchView *__bluetooth_pb_folder_search_get(PhoneBookType pb_type);
 
-static void __bluetooth_pb_create_call_index(PhoneBookType pb_type);
+static gint __bluetooth_pb_folder_index_lookup_id(PhoneBookType pb_type,
+						gint handle);
+
+static PhoneBookType __bluetooth_pb_call_index_lookup_type(gint phonelog_id);
 
 static void __bluetooth_pb_get_contact_list(PhoneBookType pb_type,
 					GPtrArray *ptr_array,
@@ -217,15 +275,23 @@ static void __bluetooth_pb_get_call_list(PhoneBookType pb_type,
 					gint end_index,
 					gboolean formatted_name);
 
-static void __bluetooth_pb_get_contact_list_by_name(PhoneBookType pb_type,
+static void __bluetooth_pb_search_hits_add(GPtrArray *ptr_array,
+					GArray *hits,
+					gboolean formatted_name);
+
+static void __bluetooth_pb_search_contact_list(PhoneBookType pb_type,
 						GPtrArray *ptr_array,
-						const gchar *find_text,
+						guint8 attribute,
+						BtPbSearchMatch match,
+						const gchar *value,
 						gboolean formatted_name,
 						gboolean owner);
 
-static void __bluetooth_pb_get_call_list_by_name(PhoneBookType pb_type,
+static void __bluetooth_pb_search_call_list(PhoneBookType pb_type,
 						GPtrArray *ptr_array,
-						const gchar *find_text,
+						guint8 attribute,
+						BtPbSearchMatch match,
+						const gchar *value,
 						gboolean formatted_name);
 
 static int __bluetooth_get_calllog_type(int call_type);
@@ -233,16 +299,6 @@ static int __bluetooth_get_calllog_type(int call_type);
 static unsigned int __get_call_log_count(unsigned int call_log_type);
 
 
-static void __bluetooth_pb_list_hash_reset(void);
-
-static gboolean __bluetooth_pb_list_hash_insert(gint handle,
-						gint id);
-
-static gint __bluetooth_pb_list_hash_lookup_id(gint handle);
-
-static guint __bluetooth_pb_list_hash_size(void);
-
-
 static void __bluetooth_pb_list_ptr_array_add(GPtrArray *ptr_array,
 						const gchar *name,
 						const gchar *number,
@@ -295,14 +351,16 @@ static void bluetooth_pb_agent_finalize(GObject *obj)
 
 static void bluetooth_pb_agent_clear(BluetoothPbAgent *agent)
 {
+	PhoneBookType pb_type;
+
 	DBG("+\n");
 
-	if (contact_list_hash) {
-		g_hash_table_destroy(contact_list_hash);
-		contact_list_hash = NULL;
+	/* Release outdated folders now, they are rebuilt on next use */
+	for (pb_type = TELECOM_PB; pb_type <= TELECOM_CCH; pb_type++) {
+		if (folder_index[pb_type].generation !=
+				__bluetooth_pb_folder_generation(pb_type))
+			__bluetooth_pb_folder_index_free(pb_type);
 	}
-
-	g_current_pb_type = TELECOM_NONE;
 }
 
 static gboolean bluetooth_pb_get_phonebook(BluetoothPbAgent *agent,
@@ -317,60 +375,92 @@ static gboolean bluetooth_pb_get_phonebook(BluetoothPbAgent *agent,
 	GPtrArray *vcards = NULL;
 	gchar **vcards_str = NULL;
 
-	gint new_missed_calls = 0;
-
 	DBG("\n");
 
 	__bluetooth_pb_agent_timeout_add_seconds(agent);
 
 	pb_type = __bluetooth_pb_get_pb_type(name);
 
-	switch (pb_type) {
-	case TELECOM_PB:
-		vcards = __bluetooth_pb_get_contact_vcards(agent,
-				filter, format,
-				max_list_count, list_start_offset);
-		break;
-	case TELECOM_ICH:
-		vcards = __bluetooth_pb_get_incoming_call_vcards(agent,
-				filter, format,
-				max_list_count, list_start_offset);
-		break;
-	case TELECOM_OCH:
-		vcards = __bluetooth_pb_get_outgoing_call_vcards(agent,
-				filter, format,
-				max_list_count, list_start_offset);
-		break;
-	case TELECOM_MCH:
-		vcards = __bluetooth_pb_get_missed_call_vcards(agent,
-				filter, format,
-				max_list_count, list_start_offset);
-		break;
-	case TELECOM_CCH:
-		vcards = __bluetooth_pb_get_combined_call_vcards(agent,
-				filter, format,
-				max_list_count, list_start_offset);
-		break;
-	default: {
+	if (pb_type == TELECOM_NONE) {
 		__bluetooth_pb_dbus_return_error(context,
 					G_FILE_ERROR_INVAL,
 					"unsupported name defined");
 		return FALSE;
 	}
 
-	}
+	vcards = __bluetooth_pb_get_vcards(pb_type, filter, format,
+					max_list_count, list_start_offset);
 
 	if (vcards)
 		vcards_str = (gchar **) g_ptr_array_free(vcards, FALSE);
 
-	/* TODO : new_missed_calls need to implement */
-	dbus_g_method_return(context, vcards_str, new_missed_calls);
+	dbus_g_method_return(context, vcards_str,
+			__bluetooth_pb_get_new_missed_calls(pb_type));
 
 	g_strfreev(vcards_str);
 
 	return TRUE;
 }
 
+static gboolean bluetooth_pb_get_phonebook_chunked(BluetoothPbAgent *agent,
+						const char *name,
+						guint64 filter,
+						guint8 format,
+						guint16 max_list_count,
+						guint16 list_start_offset,
+						guint16 chunk_size,
+						DBusGMethodInvocation *context)
+{
+	PhoneBookType pb_type = TELECOM_NONE;
+	BluetoothPbPage *page = NULL;
+	DBusGConnection *conn = NULL;
+
+	DBG("\n");
+
+	__bluetooth_pb_agent_timeout_add_seconds(agent);
+
+	pb_type = __bluetooth_pb_get_pb_type(name);
+
+	if (pb_type == TELECOM_NONE) {
+		__bluetooth_pb_dbus_return_error(context,
+					G_FILE_ERROR_INVAL,
+					"unsupported name defined");
+		return FALSE;
+	}
+
+	/* one connection for every chunk of the page */
+	conn = dbus_g_bus_get(DBUS_BUS_SYSTEM, NULL);
+	if (conn == NULL) {
+		__bluetooth_pb_dbus_return_error(context,
+					G_FILE_ERROR_FAILED,
+					"can not get system bus");
+		return FALSE;
+	}
+
+	page = g_new0(BluetoothPbPage, 1);
+	page->conn = conn;
+	page->pb_type = pb_type;
+	page->filter = filter;
+	page->format = format;
+	page->chunk_size = chunk_size ? chunk_size : BLUETOOTH_PB_CHUNK_SIZE;
+	page->request_id = ++g_page_request_id;
+	page->destination = dbus_g_method_get_sender(context);
+
+	/* Only ids are collected here, vCards are rendered chunk by chunk */
+	page->ids = __bluetooth_pb_page_collect(pb_type,
+					max_list_count, list_start_offset);
+
+	DBG("request %d: %d entries in chunks of %d\n", page->request_id,
+				page->ids->len, page->chunk_size);
+
+	dbus_g_method_return(context, page->request_id, page->ids->len,
+				__bluetooth_pb_get_new_missed_calls(pb_type));
+
+	g_idle_add(__bluetooth_pb_page_stream, page);
+
+	return TRUE;
+}
+
 static gboolean bluetooth_pb_get_phonebook_size(BluetoothPbAgent *agent,
 						const char *name,
 						DBusGMethodInvocation *context)
@@ -452,6 +542,56 @@ static gboolean bluetooth_pb_get_phonebook_list(BluetoothPbAgent *agent,
 	return TRUE;
 }
 
+static gboolean bluetooth_pb_get_phonebook_list_search(BluetoothPbAgent *agent,
+						const char *name,
+						guint8 search_attribute,
+						const gchar *search_value,
+						DBusGMethodInvocation *context)
+{
+	PhoneBookType pb_type = TELECOM_NONE;
+
+	GPtrArray *ptr_array;
+
+	DBG("\n");
+
+	__bluetooth_pb_agent_timeout_add_seconds(agent);
+
+	pb_type = __bluetooth_pb_get_pb_type(name);
+
+	if (pb_type == TELECOM_NONE) {
+		__bluetooth_pb_dbus_return_error(context,
+					G_FILE_ERROR_INVAL,
+					"unsupported name defined");
+		return FALSE;
+	}
+
+	if (search_attribute != BT_PB_SEARCH_NAME &&
+			search_attribute != BT_PB_SEARCH_NUMBER) {
+		__bluetooth_pb_dbus_return_error(context,
+					G_FILE_ERROR_INVAL,
+					"unsupported search attribute");
+		return FALSE;
+	}
+
+	ptr_array = g_ptr_array_new_with_free_func(__bluetooth_pb_list_ptr_array_free);
+
+	if (pb_type == TELECOM_PB)
+		__bluetooth_pb_search_contact_list(pb_type, ptr_array,
+				search_attribute, BT_PB_SEARCH_SUBSTRING,
+				search_value, FALSE, TRUE);
+	else
+		__bluetooth_pb_search_call_list(pb_type, ptr_array,
+				search_attribute, BT_PB_SEARCH_SUBSTRING,
+				search_value, FALSE);
+
+	dbus_g_method_return(context, ptr_array);
+
+	if (ptr_array)
+		g_ptr_array_free(ptr_array, TRUE);
+
+	return TRUE;
+}
+
 
 static gboolean bluetooth_pb_get_phonebook_entry(BluetoothPbAgent *agent,
 						const gchar *folder,
@@ -478,51 +618,27 @@ static gboolean bluetooth_pb_get_phonebook_entry(BluetoothPbAgent *agent,
 	}
 
 	handle = (gint)g_ascii_strtoll(id, NULL, 10);
-	cid = __bluetooth_pb_list_hash_lookup_id(handle);
-
-	DBG("id %s handle%d, cid %d\n", id, handle, cid );
 
 	pb_type = __bluetooth_pb_get_pb_type(folder);
-	switch (pb_type) {
-	case TELECOM_PB:
-		__bluetooth_pb_create_contact_index(pb_type);
-		str = _bluetooth_pb_vcard_contact(cid, filter, format);
-		break;
-	case TELECOM_ICH:
-		__bluetooth_pb_create_call_index(pb_type);
-		str = _bluetooth_pb_vcard_call(cid, filter, format, "RECEIVED");
-		break;
-	case TELECOM_OCH:
-		__bluetooth_pb_create_call_index(pb_type);
-		str = _bluetooth_pb_vcard_call(cid, filter, format, "DIALED");
-		break;
-	case TELECOM_MCH:
-		__bluetooth_pb_create_call_index(pb_type);
-		str = _bluetooth_pb_vcard_call(cid, filter, format, "MISSED");
-		break;
-	case TELECOM_CCH: {
-		char *attr = NULL;
+	if (pb_type == TELECOM_NONE) {
+		__bluetooth_pb_dbus_return_error(context,
+					G_FILE_ERROR_INVAL,
+					"unsupported name defined");
+		return FALSE;
+	}
 
-		if (_bluetooth_pb_is_incoming_call(cid))
-			attr = "RECEIVED";
-		else if (_bluetooth_pb_is_outgoing_call(cid))
-			attr = "DIALED";
-		else if (_bluetooth_pb_is_missed_call(cid))
-			attr = "MISSED";
+	cid = __bluetooth_pb_folder_index_lookup_id(pb_type, handle);
 
-		__bluetooth_pb_create_call_index(pb_type);
-		str = _bluetooth_pb_vcard_call(cid, filter, format, attr);
+	DBG("id %s handle%d, cid %d\n", id, handle, cid );
 
-		break;
-	}
-	default: {
+	if (cid < 0) {
 		__bluetooth_pb_dbus_return_error(context,
 					G_FILE_ERROR_INVAL,
-					"unsupported name defined");
+					"invalid vcf file");
 		return FALSE;
 	}
 
-	}
+	str = __bluetooth_pb_page_render(pb_type, cid, filter, format);
 
 	dbus_g_method_return(context, str);
 	g_free(str);
@@ -632,9 +748,13 @@ static gboolean bluetooth_pb_get_phonebook_entries_find_at(BluetoothPbAgent *age
 	ptr_array = g_ptr_array_new_with_free_func(__bluetooth_pb_list_ptr_array_free);
 
 	if (pb_type == TELECOM_PB)
-		__bluetooth_pb_get_contact_list_by_name(pb_type, ptr_array, find_text, TRUE, FALSE);
+		__bluetooth_pb_search_contact_list(pb_type, ptr_array,
+				BT_PB_SEARCH_NAME, BT_PB_SEARCH_PREFIX,
+				find_text, TRUE, FALSE);
 	else
-		__bluetooth_pb_get_call_list_by_name(pb_type, ptr_array, find_text, TRUE);
+		__bluetooth_pb_search_call_list(pb_type, ptr_array,
+				BT_PB_SEARCH_NAME, BT_PB_SEARCH_PREFIX,
+				find_text, TRUE);
 
 	dbus_g_method_return(context, ptr_array);
 
@@ -673,126 +793,19 @@ static gboolean bluetooth_pb_get_total_object_count(BluetoothPbAgent *agent,
 }
 
 
-static int __bluetooth_pb_agent_read_file(const char *file_path, char **stream)
-{
-	FILE *fp = NULL;
-	int read_len = -1;
-	int received_file_size = 0;
-	struct stat file_attr;
-
-	if (file_path == NULL || stream == NULL) {
-		DBG("Invalid data \n");
-		return -1;
-	}
-
-	DBG("file_path = %s\n", file_path);
-
-	if ((fp = fopen(file_path, "r+")) == NULL) {
-		DBG("Cannot open %s\n", file_path);
-		return -1;
-	}
-
-	if (fstat(fileno(fp), &file_attr) == 0) {
-		received_file_size = file_attr.st_size;
-		DBG("file_attr.st_size = %d, size = %d\n", file_attr.st_size, received_file_size);
-
-		if (received_file_size <= 0) {
-			DBG("Some problem in the file size [%s]  \n", file_path);
-			fclose(fp);
-			fp = NULL;
-			return -1;
-		}
-
-		*stream = (char *)malloc(sizeof(char) * received_file_size);
-		if (NULL == *stream) {
-			fclose(fp);
-			fp = NULL;
-			return -1;
-		}
-	} else {
-		DBG("Some problem in the file [%s]  \n", file_path);
-		fclose(fp);
-		fp = NULL;
-		return -1;
-	}
-
-	read_len = fread(*stream, 1, received_file_size, fp);
-
-	if (read_len == 0) {
-		if (fp != NULL) {
-			fclose(fp);
-			fp = NULL;
-		}
-		DBG("Cannot open %s\n", file_path);
-		return -1;
-	}
-
-	if (fp != NULL) {
-		fclose(fp);
-		fp = NULL;
-	}
-	return 0;
-}
-
 static gboolean bluetooth_pb_add_contact(BluetoothPbAgent *agent, const char *filename,
 					 GError **error)
 {
-	CTSstruct *contact_record = NULL;
-	GSList *numbers_list = NULL, *cursor;
-	int is_success = 0;
-	int is_duplicated = 0;
-	int err = 0;
-	char *stream = NULL;
+	gint inserted;
 
 	DBG("file_path = %s\n", filename);
 
-	err = contacts_svc_connect();
-	DBG("contact_db_service_connect fucntion call [error] = %d \n", err);
-
-	err = __bluetooth_pb_agent_read_file(filename, &stream);
-
-	if (err != 0) {
-		contacts_svc_disconnect();
-		DBG("contacts_svc_disconnect fucntion call [error] = %d \n", err);
-
-		if (NULL != stream) {
-			free(stream);
-			stream = NULL;
-		}
+	/* the agent stays connected to contacts-svc while it runs */
+	inserted = _bluetooth_pb_import_file(filename);
+	if (inserted < 0)
 		return FALSE;
-	}
-
-	is_success = contacts_svc_get_contact_from_vcard((const void *)stream, &contact_record);
-
-	DBG("contacts_svc_get_contact_from_vcard fucntion call [is_success] = %d \n", is_success);
 
-	if (0 == is_success) {
-		contacts_svc_struct_get_list(contact_record, CTS_CF_NUMBER_LIST, &numbers_list);
-		cursor = numbers_list;
-
-		for (; cursor; cursor = g_slist_next(cursor)) {
-			if (contacts_svc_find_contact_by(CTS_FIND_BY_NUMBER,
-							contacts_svc_value_get_str(cursor->data,
-								CTS_NUM_VAL_NUMBER_STR)) > 0) {
-				DBG("is_duplicated\n");
-				is_duplicated = TRUE;
-			}
-		}
-
-		if (is_duplicated == FALSE) {
-			contacts_svc_insert_contact(0, contact_record);
-		}
-	} else {
-		DBG("Fail \n");
-	}
-
-	err = contacts_svc_disconnect();
-	DBG("contacts_svc_disconnect fucntion call [error] = %d \n", err);
-
-	if (NULL != stream) {
-		free(stream);
-		stream = NULL;
-	}
+	DBG("%d contacts inserted\n", inserted);
 
 	return TRUE;
 }
@@ -869,7 +882,7 @@ static unsigned int __bluetooth_pb_get_contact_size(void)
 {
 	unsigned int phonebook_size = 0;
 
-	phonebook_size = contacts_svc_count(CTS_GET_ALL_CONTACT);
+	phonebook_size = __bluetooth_pb_folder_index_get(TELECOM_PB)->len;
 	DBG("Number of contacts is %d\n", phonebook_size);
 
 	/* add count for owner (0.vcf) */
@@ -880,512 +893,452 @@ static unsigned int __bluetooth_pb_get_contact_size(void)
 
 static unsigned int __bluetooth_pb_get_incoming_call_size(void)
 {
-	CTSiter *iter = NULL;
+	return __bluetooth_pb_folder_index_get(TELECOM_ICH)->len;
+}
 
-	unsigned int call_size = 0;
+static unsigned int __bluetooth_pb_get_outgoing_call_size(void)
+{
+	return __bluetooth_pb_folder_index_get(TELECOM_OCH)->len;
+}
 
-	contacts_svc_get_list(CTS_LIST_ALL_PLOG, &iter);
+static unsigned int __bluetooth_pb_get_missed_call_size(void)
+{
+	return __bluetooth_pb_folder_index_get(TELECOM_MCH)->len;
+}
 
-	while (contacts_svc_iter_next(iter) == CTS_SUCCESS) {
-		CTSvalue *value = NULL;
-		gint phonelog_id = 0;
+static unsigned int __bluetooth_pb_get_combined_call_size(void)
+{
+	return __bluetooth_pb_folder_index_get(TELECOM_CCH)->len;
+}
 
-		value = contacts_svc_iter_get_info(iter);
-		if (value == NULL)
-			continue;
+/* PBAP reports NewMissedCalls for mch only */
+static guint __bluetooth_pb_get_new_missed_calls(PhoneBookType pb_type)
+{
+	if (pb_type != TELECOM_MCH)
+		return 0;
 
-		phonelog_id = contacts_svc_value_get_int(value, CTS_LIST_PLOG_ID_INT);
+	/* the count is rebuilt with a stale call index */
+	__bluetooth_pb_folder_index_get(TELECOM_MCH);
 
-		if (_bluetooth_pb_is_incoming_call(phonelog_id))
-			call_size++;
+	return new_missed_calls;
+}
 
-		contacts_svc_value_free(value);
+static PhoneBookType __bluetooth_pb_call_type(gint log_type)
+{
+	switch (log_type) {
+	case CTS_PLOG_TYPE_VOICE_INCOMMING:
+	case CTS_PLOG_TYPE_VIDEO_INCOMMING:
+		return TELECOM_ICH;
+	case CTS_PLOG_TYPE_VOICE_OUTGOING:
+	case CTS_PLOG_TYPE_VIDEO_OUTGOING:
+		return TELECOM_OCH;
+	case CTS_PLOG_TYPE_VOICE_INCOMMING_UNSEEN:
+	case CTS_PLOG_TYPE_VOICE_INCOMMING_SEEN:
+	case CTS_PLOG_TYPE_VIDEO_INCOMMING_UNSEEN:
+	case CTS_PLOG_TYPE_VIDEO_INCOMMING_SEEN:
+		return TELECOM_MCH;
+	default:
+		return TELECOM_NONE;
 	}
-
-	if (iter)
-		contacts_svc_iter_remove(iter);
-
-	return call_size;
 }
 
-static unsigned int __bluetooth_pb_get_outgoing_call_size(void)
+static const gchar *__bluetooth_pb_call_attr(PhoneBookType call_type)
 {
-	CTSiter *iter = NULL;
+	switch (call_type) {
+	case TELECOM_ICH:
+		return "RECEIVED";
+	case TELECOM_OCH:
+		return "DIALED";
+	case TELECOM_MCH:
+		return "MISSED";
+	default:
+		return NULL;
+	}
+}
 
-	unsigned int call_size = 0;
+static guint __bluetooth_pb_folder_generation(PhoneBookType pb_type)
+{
+	if (pb_type == TELECOM_PB)
+		return contact_generation;
 
-	contacts_svc_get_list(CTS_LIST_ALL_PLOG, &iter);
+	return call_generation;
+}
 
-	while (contacts_svc_iter_next(iter) == CTS_SUCCESS) {
-		CTSvalue *value = NULL;
-		gint phonelog_id = 0;
+static void __bluetooth_pb_folder_index_free(PhoneBookType pb_type)
+{
+	BluetoothPbFolderIndex *folder = &folder_index[pb_type];
 
-		value = contacts_svc_iter_get_info(iter);
-		if (value == NULL)
-			continue;
+	if (folder->ids)
+		g_array_free(folder->ids, TRUE);
 
-		phonelog_id = contacts_svc_value_get_int(value, CTS_LIST_PLOG_ID_INT);
+	_bluetooth_pb_search_view_free(folder->search);
 
-		if (_bluetooth_pb_is_outgoing_call(phonelog_id))
-			call_size++;
+	folder->ids = NULL;
+	folder->search = NULL;
+	folder->generation = 0;
 
-		contacts_svc_value_free(value);
+	if (pb_type == TELECOM_CCH && call_type_hash) {
+		g_hash_table_destroy(call_type_hash);
+		call_type_hash = NULL;
 	}
+}
 
-	if (iter)
-		contacts_svc_iter_remove(iter);
-
-	return call_size;
-}
-
-static unsigned int __bluetooth_pb_get_missed_call_size(void)
+static void __bluetooth_pb_contact_index_build(void)
 {
+	BluetoothPbFolderIndex *folder = &folder_index[TELECOM_PB];
 	CTSiter *iter = NULL;
 
-	unsigned int call_size = 0;
-
-	contacts_svc_get_list(CTS_LIST_ALL_MISSED_CALL, &iter);
-
-	while (contacts_svc_iter_next(iter) == CTS_SUCCESS) {
-		call_size++;
-	}
-
-	if (iter)
-		contacts_svc_iter_remove(iter);
-
-	return call_size;
-}
-
-static unsigned int __bluetooth_pb_get_combined_call_size(void)
-{
-	CTSiter *iter = NULL;
+	__bluetooth_pb_folder_index_free(TELECOM_PB);
 
-	unsigned int call_size = 0;
+	folder->ids = g_array_new(FALSE, FALSE, sizeof(gint));
 
-	contacts_svc_get_list(CTS_LIST_ALL_PLOG, &iter);
+	contacts_svc_get_list(CTS_LIST_ALL_CONTACT, &iter);
 
 	while (contacts_svc_iter_next(iter) == CTS_SUCCESS) {
 		CTSvalue *value = NULL;
-		gint phonelog_id = 0;
+		gint contact_id = 0;
 
 		value = contacts_svc_iter_get_info(iter);
 		if (value == NULL)
 			continue;
 
-		phonelog_id = contacts_svc_value_get_int(value, CTS_LIST_PLOG_ID_INT);
-
-		if (_bluetooth_pb_is_incoming_call(phonelog_id) ||
-					_bluetooth_pb_is_outgoing_call(phonelog_id) ||
-					_bluetooth_pb_is_missed_call(phonelog_id))
-			call_size++;
-
+		contact_id = contacts_svc_value_get_int(value, CTS_LIST_CONTACT_ID_INT);
 		contacts_svc_value_free(value);
+
+		g_array_append_val(folder->ids, contact_id);
 	}
 
 	if (iter)
 		contacts_svc_iter_remove(iter);
 
-	return call_size;
-}
+	/* only contacts new or changed since the last build are fetched */
+	folder->search = _bluetooth_pb_search_contacts_view(folder->ids);
 
-static GPtrArray *__bluetooth_pb_get_contact_vcards(BluetoothPbAgent *agent,
-						guint64 filter,
-						guint8 format,
-						guint16 max_list_count,
-						guint16 list_start_offset)
-{
-	GPtrArray *vcards = NULL;
+	folder->generation = contact_generation;
 
-	gint i = 1;
-	gboolean unrestricted = FALSE;
+	DBG("pb %d generation %d\n", folder->ids->len, folder->generation);
+}
 
+static void __bluetooth_pb_call_index_build(void)
+{
 	CTSiter *iter = NULL;
+	PhoneBookType pb_type;
 
-	vcards = g_ptr_array_new();
-
-	if (max_list_count == 65535)
-		unrestricted = TRUE;
+	for (pb_type = TELECOM_ICH; pb_type <= TELECOM_CCH; pb_type++) {
+		__bluetooth_pb_folder_index_free(pb_type);
+		folder_index[pb_type].ids = g_array_new(FALSE, FALSE, sizeof(gint));
+	}
 
-	/* for owner */
-	if (list_start_offset == 0) {
-		gchar *vcard = NULL;
-		vcard = _bluetooth_pb_vcard_contact(0, filter, format);
+	call_type_hash = g_hash_table_new(g_direct_hash, g_direct_equal);
+	new_missed_calls = 0;
 
-		g_ptr_array_add(vcards, vcard);
-	}
+	/* The log type comes with the list row, no per-entry lookup */
+	contacts_svc_get_list(CTS_LIST_ALL_PLOG, &iter);
 
-	contacts_svc_get_list(CTS_LIST_ALL_CONTACT, &iter);
-	while ((contacts_svc_iter_next(iter) == CTS_SUCCESS) &&
-			(unrestricted || (i < list_start_offset + max_list_count))) {
+	while (contacts_svc_iter_next(iter) == CTS_SUCCESS) {
 		CTSvalue *value = NULL;
-		gchar *vcard = NULL;
-		gint id = 0;
+		PhoneBookType call_type;
+		gint phonelog_id = 0;
+		gint log_type = 0;
 
 		value = contacts_svc_iter_get_info(iter);
 		if (value == NULL)
 			continue;
 
-		id = contacts_svc_value_get_int(value, CTS_LIST_CONTACT_ID_INT);
-		vcard = _bluetooth_pb_vcard_contact(id, filter, format);
+		phonelog_id = contacts_svc_value_get_int(value, CTS_LIST_PLOG_ID_INT);
+		log_type = contacts_svc_value_get_int(value, CTS_LIST_PLOG_LOG_TYPE_INT);
+		call_type = __bluetooth_pb_call_type(log_type);
 
 		contacts_svc_value_free(value);
 
-		if (vcard == NULL)
-			continue;
+		if (log_type == CTS_PLOG_TYPE_VOICE_INCOMMING_UNSEEN ||
+				log_type == CTS_PLOG_TYPE_VIDEO_INCOMMING_UNSEEN)
+			new_missed_calls++;
 
-		if ( i >= list_start_offset)
-			g_ptr_array_add(vcards, vcard);
+		if (call_type == TELECOM_NONE)
+			continue;
 
-		i++;
+		g_array_append_val(folder_index[call_type].ids, phonelog_id);
+		g_array_append_val(folder_index[TELECOM_CCH].ids, phonelog_id);
+		g_hash_table_insert(call_type_hash,
+				GINT_TO_POINTER(phonelog_id),
+				GINT_TO_POINTER(call_type));
 	}
 
-	g_ptr_array_add(vcards, NULL);
-
 	if (iter)
 		contacts_svc_iter_remove(iter);
 
-	return vcards;
-}
+	/* search entries of deleted calls go with the old index */
+	_bluetooth_pb_search_calls_prune(call_type_hash);
 
-static GPtrArray *__bluetooth_pb_get_incoming_call_vcards(BluetoothPbAgent *agent,
-							guint64 filter,
-							guint8 format,
-							guint16 max_list_count,
-							guint16 list_start_offset)
-{
-	GPtrArray *vcards = NULL;
-
-	gint i = 1;
-	guint16 offset = list_start_offset;
+	for (pb_type = TELECOM_ICH; pb_type <= TELECOM_CCH; pb_type++) {
+		folder_index[pb_type].search = _bluetooth_pb_search_calls_view(
+						folder_index[pb_type].ids);
+		folder_index[pb_type].generation = call_generation;
+	}
 
-	gboolean unrestricted = FALSE;
+	DBG("ich %d och %d mch %d (%d new) cch %d generation %d\n",
+			folder_index[TELECOM_ICH].ids->len,
+			folder_index[TELECOM_OCH].ids->len,
+			folder_index[TELECOM_MCH].ids->len,
+			new_missed_calls,
+			folder_index[TELECOM_CCH].ids->len,
+			call_generation);
+}
 
-	CTSiter *iter = NULL;
+static GArray *__bluetooth_pb_folder_index_get(PhoneBookType pb_type)
+{
+	BluetoothPbFolderIndex *folder = &folder_index[pb_type];
 
-	vcards = g_ptr_array_new();
-	contacts_svc_get_list(CTS_LIST_ALL_PLOG, &iter);
+	if (folder->ids &&
+		folder->generation == __bluetooth_pb_folder_generation(pb_type))
+		return folder->ids;
 
-	if (max_list_count == 65535)
-		unrestricted = TRUE;
+	if (pb_type == TELECOM_PB)
+		__bluetooth_pb_contact_index_build();
+	else
+		__bluetooth_pb_call_index_build();
 
-	if (offset == 0)
-		offset = 1;
+	return folder->ids;
+}
 
-	DBG("i %d offset %d max_list_count %d\n", i, offset, max_list_count);
+static const BtPbSearchView *__bluetooth_pb_folder_search_get(PhoneBookType pb_type)
+{
+	BluetoothPbFolderIndex *folder = &folder_index[pb_type];
+	GArray *ids;
 
-	while ((contacts_svc_iter_next(iter) == CTS_SUCCESS) &&
-			(unrestricted || (i < offset + max_list_count))) {
-		CTSvalue *value = NULL;
-		gint phonelog_id = 0;
-		gchar *vcard = NULL;
+	ids = __bluetooth_pb_folder_index_get(pb_type);
 
-		value = contacts_svc_iter_get_info(iter);
-		if (value == NULL)
-			continue;
+	if (_bluetooth_pb_search_view_valid(folder->search))
+		return folder->search;
 
-		phonelog_id = contacts_svc_value_get_int(value, CTS_LIST_PLOG_ID_INT);
+	/* entries it pointed to were dropped, the handles still hold */
+	_bluetooth_pb_search_view_free(folder->search);
 
-		if (_bluetooth_pb_is_incoming_call(phonelog_id)) {
-			vcard = _bluetooth_pb_vcard_call(phonelog_id, filter, format,
-					"RECEIVED");
+	if (pb_type == TELECOM_PB)
+		folder->search = _bluetooth_pb_search_contacts_view(ids);
+	else
+		folder->search = _bluetooth_pb_search_calls_view(ids);
 
-			if (vcard == NULL)
-				continue;
+	return folder->search;
+}
 
-			if ( i >= offset)
-				g_ptr_array_add(vcards, vcard);
-			i++;
-		}
+static gint __bluetooth_pb_folder_index_lookup_id(PhoneBookType pb_type,
+						gint handle)
+{
+	GArray *ids;
 
-		contacts_svc_value_free(value);
-	}
+	/* owner */
+	if (pb_type == TELECOM_PB && handle == 0)
+		return 0;
 
-	g_ptr_array_add(vcards, NULL);
+	ids = __bluetooth_pb_folder_index_get(pb_type);
 
-	if (iter)
-		contacts_svc_iter_remove(iter);
+	if (handle < 1 || handle > ids->len)
+		return -1;
 
-	return vcards;
+	return g_array_index(ids, gint, handle - 1);
 }
 
-static GPtrArray *__bluetooth_pb_get_outgoing_call_vcards(BluetoothPbAgent *agent,
-							guint64 filter,
-							guint8 format,
-							guint16 max_list_count,
-							guint16 list_start_offset)
+static PhoneBookType __bluetooth_pb_call_index_lookup_type(gint phonelog_id)
 {
-	GPtrArray *vcards = NULL;
+	__bluetooth_pb_folder_index_get(TELECOM_CCH);
 
-	gint i = 1;
-	guint16 offset = list_start_offset;
-
-	gboolean unrestricted = FALSE;
+	return GPOINTER_TO_INT(g_hash_table_lookup(call_type_hash,
+					GINT_TO_POINTER(phonelog_id)));
+}
 
-	CTSiter *iter = NULL;
+static GArray *__bluetooth_pb_page_collect(PhoneBookType pb_type,
+					guint16 max_list_count,
+					guint16 list_start_offset)
+{
+	GArray *ids = NULL;
+	GArray *folder = NULL;
 
-	vcards = g_ptr_array_new();
-	contacts_svc_get_list(CTS_LIST_ALL_PLOG, &iter);
+	gboolean unrestricted;
+	gint start = list_start_offset;
+	gint end;
 
-	if (max_list_count == 65535)
-		unrestricted = TRUE;
+	ids = g_array_new(FALSE, FALSE, sizeof(gint));
+	folder = __bluetooth_pb_folder_index_get(pb_type);
 
-	if (offset == 0)
-		offset = 1;
+	unrestricted = (max_list_count == BLUETOOTH_PB_UNRESTRICTED);
 
-	while ((contacts_svc_iter_next(iter) == CTS_SUCCESS) &&
-			(unrestricted || (i < offset + max_list_count))) {
-		CTSvalue *value = NULL;
-		gint phonelog_id = 0;
-		gchar *vcard = NULL;
+	if (start == 0) {
+		/* owner is handle 0, other handles start at 1 */
+		if (pb_type == TELECOM_PB && max_list_count > 0) {
+			gint owner = 0;
 
-		value = contacts_svc_iter_get_info(iter);
-		if (value == NULL)
-			continue;
+			g_array_append_val(ids, owner);
+			max_list_count--;
+		}
+		start = 1;
+	}
 
-		phonelog_id = contacts_svc_value_get_int(value, CTS_LIST_PLOG_ID_INT);
+	if (unrestricted)
+		end = folder->len;
+	else
+		end = MIN(start - 1 + max_list_count, (gint)folder->len);
 
-		if (_bluetooth_pb_is_outgoing_call(phonelog_id)) {
-			vcard = _bluetooth_pb_vcard_call(phonelog_id, filter, format,
-					"DIALED");
+	DBG("start %d end %d\n", start, end);
 
-			if (vcard == NULL)
-				continue;
+	/* Entries before the offset are never rendered */
+	if (start <= end)
+		g_array_append_vals(ids,
+				&g_array_index(folder, gint, start - 1),
+				end - start + 1);
 
-			if (i >= offset)
-				g_ptr_array_add(vcards, vcard);
-			i++;
-		}
+	return ids;
+}
 
-		contacts_svc_value_free(value);
+static gchar *__bluetooth_pb_page_render(PhoneBookType pb_type,
+					gint id,
+					guint64 filter,
+					guint8 format)
+{
+	switch (pb_type) {
+	case TELECOM_PB:
+		return _bluetooth_pb_vcard_contact(id, filter, format);
+	case TELECOM_ICH:
+	case TELECOM_OCH:
+	case TELECOM_MCH:
+		break;
+	case TELECOM_CCH:
+		pb_type = __bluetooth_pb_call_index_lookup_type(id);
+		break;
+	default:
+		return NULL;
 	}
 
-	g_ptr_array_add(vcards, NULL);
-
-	if (iter)
-		contacts_svc_iter_remove(iter);
-
-	return vcards;
+	return _bluetooth_pb_vcard_call(id, filter, format,
+				__bluetooth_pb_call_attr(pb_type));
 }
 
-static GPtrArray *__bluetooth_pb_get_missed_call_vcards(BluetoothPbAgent *agent,
-							guint64 filter,
-							guint8 format,
-							guint16 max_list_count,
-							guint16 list_start_offset)
+static GPtrArray *__bluetooth_pb_get_vcards(PhoneBookType pb_type,
+					guint64 filter,
+					guint8 format,
+					guint16 max_list_count,
+					guint16 list_start_offset)
 {
 	GPtrArray *vcards = NULL;
+	GArray *ids = NULL;
+	guint i;
 
-	gint i = 1;
-	guint16 offset = list_start_offset;
-
-	gboolean unrestricted = FALSE;
-
-	CTSiter *iter = NULL;
-
-	vcards = g_ptr_array_new();
-	contacts_svc_get_list(CTS_LIST_ALL_MISSED_CALL, &iter);
-
-	if (max_list_count == 65535)
-		unrestricted = TRUE;
-
-	if (offset == 0)
-		offset = 1;
-
-	while ((contacts_svc_iter_next(iter) == CTS_SUCCESS) &&
-			(unrestricted || (i < offset + max_list_count))) {
-		CTSvalue *value = NULL;
-		gint phonelog_id = 0;
-		gchar *vcard = NULL;
-
-		value = contacts_svc_iter_get_info(iter);
-		if (value == NULL)
-			continue;
-
-		phonelog_id = contacts_svc_value_get_int(value, CTS_LIST_PLOG_ID_INT);
-
-		if (_bluetooth_pb_is_missed_call(phonelog_id)) {
-			vcard = _bluetooth_pb_vcard_call(phonelog_id, filter, format,
-					"MISSED");
+	ids = __bluetooth_pb_page_collect(pb_type, max_list_count, list_start_offset);
 
-			if (vcard == NULL)
-				continue;
+	vcards = g_ptr_array_sized_new(ids->len + 1);
 
-			if (i >= offset)
-				g_ptr_array_add(vcards, vcard);
-			i++;
-		}
+	for (i = 0; i < ids->len; i++) {
+		gchar *vcard;
 
-		contacts_svc_value_free(value);
+		vcard = __bluetooth_pb_page_render(pb_type,
+				g_array_index(ids, gint, i), filter, format);
+		if (vcard)
+			g_ptr_array_add(vcards, vcard);
 	}
 
 	g_ptr_array_add(vcards, NULL);
 
-	if (iter)
-		contacts_svc_iter_remove(iter);
+	g_array_free(ids, TRUE);
 
 	return vcards;
 }
 
-static GPtrArray *__bluetooth_pb_get_combined_call_vcards(BluetoothPbAgent *agent,
-							guint64 filter,
-							guint8 format,
-							guint16 max_list_count,
-							guint16 list_start_offset)
+static void __bluetooth_pb_page_free(BluetoothPbPage *page)
 {
-	GPtrArray *vcards = NULL;
-
-	gint i = 1;
-	guint16 offset = list_start_offset;
-
-	gboolean unrestricted = FALSE;
-
-	CTSiter *iter = NULL;
-
-	vcards = g_ptr_array_new();
-	contacts_svc_get_list(CTS_LIST_ALL_PLOG, &iter);
-
-	if (max_list_count == 65535)
-		unrestricted = TRUE;
-
-	if (offset == 0)
-		offset = 1;
-
-	while ((contacts_svc_iter_next(iter) == CTS_SUCCESS) &&
-			(unrestricted || (i < offset + max_list_count))) {
-		CTSvalue *value = NULL;
-		gint phonelog_id = 0;
-		gchar *vcard = NULL;
-
-		gchar *attr = NULL;
-
-		value = contacts_svc_iter_get_info(iter);
-		if(value == NULL)
-			continue;
-
-		phonelog_id = contacts_svc_value_get_int(value, CTS_LIST_PLOG_ID_INT);
-
-		if (_bluetooth_pb_is_incoming_call(phonelog_id))
-			attr = "RECEIVED";
-		else if (_bluetooth_pb_is_outgoing_call(phonelog_id))
-			attr = "DIALED";
-		else if (_bluetooth_pb_is_missed_call(phonelog_id))
-			attr = "MISSED";
-
-		vcard = _bluetooth_pb_vcard_call(phonelog_id, filter, format,
-				attr);
-
-		if (vcard == NULL)
-			continue;
-
-		if (i >= offset)
-			g_ptr_array_add(vcards, vcard);
-		i++;
-
-		contacts_svc_value_free(value);
-	}
+	if (page == NULL)
+		return;
 
-	g_ptr_array_add(vcards, NULL);
+	if (page->ids)
+		g_array_free(page->ids, TRUE);
 
-	if (iter)
-		contacts_svc_iter_remove(iter);
+	if (page->conn)
+		dbus_g_connection_unref(page->conn);
 
-	return vcards;
+	g_free(page->destination);
+	g_free(page);
 }
 
-static void __bluetooth_pb_create_contact_index(PhoneBookType pb_type)
+static gboolean __bluetooth_pb_page_send_chunk(BluetoothPbPage *page,
+					GPtrArray *vcards,
+					gboolean last)
 {
-	CTSiter *iter = NULL;
-	gint i = 1;
+	DBusMessage *msg = NULL;
+	DBusMessageIter iter;
+	DBusMessageIter array;
+	dbus_bool_t is_last = last;
+	gboolean ret = FALSE;
+	guint i;
 
+	msg = dbus_message_new_signal(BT_PB_SERVICE_OBJECT_PATH,
+				BT_PB_SERVICE_INTERFACE,
+				BLUETOOTH_PB_SIGNAL_CHUNK);
+	if (msg == NULL)
+		return FALSE;
 
-	if (g_current_pb_type == pb_type)
-		return;
+	/* Unicast, the phonebook is only for the requester */
+	dbus_message_set_destination(msg, page->destination);
 
-	/* create cache */
-	g_current_pb_type = pb_type;
-	__bluetooth_pb_list_hash_reset();
+	dbus_message_iter_init_append(msg, &iter);
+	dbus_message_iter_append_basic(&iter, DBUS_TYPE_UINT32, &page->request_id);
 
-	contacts_svc_get_list(CTS_LIST_ALL_CONTACT, &iter);
+	dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
+				DBUS_TYPE_STRING_AS_STRING, &array);
+	for (i = 0; i < vcards->len; i++) {
+		const gchar *vcard = g_ptr_array_index(vcards, i);
+		dbus_message_iter_append_basic(&array, DBUS_TYPE_STRING, &vcard);
+	}
+	dbus_message_iter_close_container(&iter, &array);
 
-	while (contacts_svc_iter_next(iter) == CTS_SUCCESS) {
-		CTSvalue *value = NULL;
-		gint contact_id = 0;
+	dbus_message_iter_append_basic(&iter, DBUS_TYPE_BOOLEAN, &is_last);
 
-		value = contacts_svc_iter_get_info(iter);
-		if (value == NULL)
-			continue;
-
-		contact_id = contacts_svc_value_get_int(value, CTS_LIST_CONTACT_ID_INT);
-		__bluetooth_pb_list_hash_insert(i, contact_id);
+	ret = dbus_connection_send(dbus_g_connection_get_connection(page->conn),
+				msg, NULL);
 
+	dbus_message_unref(msg);
 
-		i++;
-	}
+	return ret;
 }
 
-static void __bluetooth_pb_create_call_index(PhoneBookType pb_type)
+static gboolean __bluetooth_pb_page_stream(gpointer user_data)
 {
-	CTSiter *iter = NULL;
-	gint i = 1;
+	BluetoothPbPage *page = user_data;
+	GPtrArray *vcards = NULL;
+	gboolean last;
+	guint end;
 
-	if (g_current_pb_type == pb_type)
-		return;
+	end = MIN(page->rendered + page->chunk_size, page->ids->len);
 
-	/* create cache */
-	g_current_pb_type = pb_type;
-	__bluetooth_pb_list_hash_reset();
+	vcards = g_ptr_array_sized_new(end - page->rendered);
+	g_ptr_array_set_free_func(vcards, g_free);
 
-	contacts_svc_get_list(CTS_LIST_ALL_PLOG, &iter);
+	for (; page->rendered < end; page->rendered++) {
+		gchar *vcard;
 
-	while(contacts_svc_iter_next(iter) == CTS_SUCCESS) {
-		CTSvalue *value = NULL;
-		gint phonelog_id = 0;
+		vcard = __bluetooth_pb_page_render(page->pb_type,
+				g_array_index(page->ids, gint, page->rendered),
+				page->filter, page->format);
+		if (vcard)
+			g_ptr_array_add(vcards, vcard);
+	}
 
-		value = contacts_svc_iter_get_info(iter);
-		if(value == NULL)
-			continue;
+	last = (page->rendered >= page->ids->len);
 
-		phonelog_id = contacts_svc_value_get_int(value, CTS_LIST_PLOG_ID_INT);
+	if (!__bluetooth_pb_page_send_chunk(page, vcards, last)) {
+		ERR("request %d: chunk send failed\n", page->request_id);
+		last = TRUE;
+	}
 
-		switch (pb_type) {
-		case TELECOM_ICH: {
-			if(_bluetooth_pb_is_incoming_call(phonelog_id)) {
-				__bluetooth_pb_list_hash_insert(i, phonelog_id);
-				i++;
-			}
-		}
-			break;
-		case TELECOM_OCH: {
-			if(_bluetooth_pb_is_outgoing_call(phonelog_id)) {
-				__bluetooth_pb_list_hash_insert(i, phonelog_id);
-				i++;
-			}
-		}
-			break;
-		case TELECOM_MCH: {
-			if(_bluetooth_pb_is_missed_call(phonelog_id)) {
-				__bluetooth_pb_list_hash_insert(i, phonelog_id);
-				i++;
-			}
-		}
-			break;
-		case TELECOM_CCH: {
-			if(_bluetooth_pb_is_incoming_call(phonelog_id) ||
-					_bluetooth_pb_is_outgoing_call(phonelog_id) ||
-					_bluetooth_pb_is_missed_call(phonelog_id)) {
-				__bluetooth_pb_list_hash_insert(i, phonelog_id);
-				i++;
-			}
-		}
-			break;
-		default :
-			return;
-		}
+	g_ptr_array_free(vcards, TRUE);
 
-		contacts_svc_value_free(value);
+	if (last) {
+		__bluetooth_pb_page_free(page);
+		return FALSE;
 	}
-}
 
+	/* Yield to the main loop between chunks */
+	return TRUE;
+}
 
 static void __bluetooth_pb_get_contact_list(PhoneBookType pb_type,
 					GPtrArray *ptr_array,
@@ -1393,13 +1346,14 @@ static void __bluetooth_pb_get_contact_list(PhoneBookType pb_type,
 					gint end_index,
 					gboolean formatted_name)
 {
+	GArray *ids;
+	GPtrArray *projections;
 	gint i;
-	guint hash_size;
 
 	if (ptr_array == NULL)
 		return;
 
-	__bluetooth_pb_create_contact_index(pb_type);
+	ids = __bluetooth_pb_folder_index_get(pb_type);
 
 	if (end_index < 0 || end_index < start_index)
 		end_index = start_index;
@@ -1424,30 +1378,27 @@ static void __bluetooth_pb_get_contact_list(PhoneBookType pb_type,
 		start_index = 1;
 	}
 
-	hash_size = __bluetooth_pb_list_hash_size();
-	if (hash_size < end_index)
-		end_index = hash_size;
-
-	for (i = start_index; i <= end_index; i++) {
-		gint contact_id;
-
-		gchar *name = NULL;
-		gchar *number = NULL;
+	if (ids->len < end_index)
+		end_index = ids->len;
 
-		contact_id = __bluetooth_pb_list_hash_lookup_id(i);
+	if (start_index > end_index)
+		return;
 
-		if (formatted_name)
-			name = _bluetooth_pb_fn_from_contact_id(contact_id);
-		else
-			name = _bluetooth_pb_name_from_contact_id(contact_id);
+	projections = _bluetooth_pb_projection_from_contact_ids(
+			&g_array_index(ids, gint, start_index - 1),
+			end_index - start_index + 1);
 
-		number = _bluetooth_pb_number_from_contact_id(contact_id);
+	for (i = start_index; i <= end_index; i++) {
+		BtPbProjection *projection;
 
-		__bluetooth_pb_list_ptr_array_add(ptr_array, name, number, i);
+		projection = g_ptr_array_index(projections, i - start_index);
 
-		g_free(name);
-		g_free(number);
+		__bluetooth_pb_list_ptr_array_add(ptr_array,
+				formatted_name ? projection->fn : projection->name,
+				projection->number, i);
 	}
+
+	g_ptr_array_free(projections, TRUE);
 }
 
 static void __bluetooth_pb_get_call_list(PhoneBookType pb_type,
@@ -1456,13 +1407,14 @@ static void __bluetooth_pb_get_call_list(PhoneBookType pb_type,
 					gint end_index,
 					gboolean formatted_name)
 {
+	GArray *ids;
+	GPtrArray *projections;
 	gint i;
-	guint hash_size;
 
 	if (ptr_array == NULL)
 		return;
 
-	__bluetooth_pb_create_call_index(pb_type);
+	ids = __bluetooth_pb_folder_index_get(pb_type);
 
 	if (end_index < 0 || end_index < start_index)
 		end_index = start_index;
@@ -1470,136 +1422,124 @@ static void __bluetooth_pb_get_call_list(PhoneBookType pb_type,
 	if (start_index <= 0)
 		start_index = 1;
 
-	hash_size = __bluetooth_pb_list_hash_size();
-	if (hash_size < end_index)
-		end_index = hash_size;
+	if (ids->len < end_index)
+		end_index = ids->len;
 
 	DBG("start_index: %d end_index %d\n", start_index, end_index);
 
+	if (start_index > end_index)
+		return;
+
+	projections = _bluetooth_pb_projection_from_phonelog_ids(
+			&g_array_index(ids, gint, start_index - 1),
+			end_index - start_index + 1);
+
 	for (i = start_index; i <= end_index; i++) {
-		gint phonelog_id;
+		BtPbProjection *projection;
 
-		gchar *name = NULL;
-		gchar *number = NULL;
+		projection = g_ptr_array_index(projections, i - start_index);
 
-		phonelog_id = __bluetooth_pb_list_hash_lookup_id(i);
+		__bluetooth_pb_list_ptr_array_add(ptr_array,
+				formatted_name ? projection->fn : projection->name,
+				projection->number, i);
+	}
 
-		if (formatted_name)
-			name = _bluetooth_pb_fn_from_phonelog_id(phonelog_id);
-		else
-			name = _bluetooth_pb_name_from_phonelog_id(phonelog_id);
+	g_ptr_array_free(projections, TRUE);
+}
 
-		number = _bluetooth_pb_number_from_phonelog_id(phonelog_id);
+static void __bluetooth_pb_search_hits_add(GPtrArray *ptr_array,
+					GArray *hits,
+					gboolean formatted_name)
+{
+	guint i;
 
-		__bluetooth_pb_list_ptr_array_add(ptr_array, name, number, i);
+	for (i = 0; i < hits->len; i++) {
+		BtPbSearchHit *hit = &g_array_index(hits, BtPbSearchHit, i);
 
-		g_free(name);
-		g_free(number);
+		__bluetooth_pb_list_ptr_array_add(ptr_array,
+				formatted_name ? hit->entry->projection.fn :
+						hit->entry->projection.name,
+				hit->entry->projection.number, hit->handle);
 	}
 }
 
-static void __bluetooth_pb_get_contact_list_by_name(PhoneBookType pb_type,
+static void __bluetooth_pb_search_contact_list(PhoneBookType pb_type,
 						GPtrArray *ptr_array,
-						const gchar *find_text,
+						guint8 attribute,
+						BtPbSearchMatch match,
+						const gchar *value,
 						gboolean formatted_name,
 						gboolean owner)
 {
-	DBG("%s %d\n", __FILE__, __LINE__);
-	guint i;
-	guint hash_size;
+	const BtPbSearchView *view;
+	GArray *hits;
+	gchar *key;
 
 	if (ptr_array == NULL)
 		return;
 
-	__bluetooth_pb_create_contact_index(pb_type);
+	view = __bluetooth_pb_folder_search_get(pb_type);
+	key = _bluetooth_pb_search_key(attribute, value);
 
 	if (owner) {
 		/* owner */
 		gchar *name;
+		gchar *number;
+		gchar *field;
+		gboolean matched;
 
 		if (formatted_name)
 			name = _bluetooth_pb_name_owner();
 		else
 			name = _bluetooth_pb_fn_owner();
 
-		if (g_str_has_prefix(name, find_text)) {
-			gchar *number;
+		number = _bluetooth_pb_number_owner();
 
-			number = _bluetooth_pb_number_owner();
+		/* the owner FN is its number */
+		field = _bluetooth_pb_search_key(attribute, number);
 
-			__bluetooth_pb_list_ptr_array_add(ptr_array, name, number, 0);
+		if (match == BT_PB_SEARCH_SUBSTRING)
+			matched = (strstr(field, key) != NULL);
+		else
+			matched = g_str_has_prefix(field, key);
 
-			g_free(number);
-		}
+		if (matched)
+			__bluetooth_pb_list_ptr_array_add(ptr_array, name, number, 0);
 
+		g_free(field);
+		g_free(number);
 		g_free(name);
 	}
 
-	hash_size = __bluetooth_pb_list_hash_size();
+	hits = _bluetooth_pb_search_view_find(view, attribute, match, key);
+	__bluetooth_pb_search_hits_add(ptr_array, hits, formatted_name);
 
-	for (i = 1; i <= hash_size; i++) {
-		gint contact_id;
-		gchar *name;
-
-		contact_id = __bluetooth_pb_list_hash_lookup_id(i);
-
-		if (formatted_name)
-			name = _bluetooth_pb_fn_from_contact_id(contact_id);
-		else
-			name = _bluetooth_pb_name_from_contact_id(contact_id);
-
-		if(g_str_has_prefix(name , find_text)) {
-			gchar *number;
-
-			number = _bluetooth_pb_number_from_contact_id(contact_id);
-
-			__bluetooth_pb_list_ptr_array_add(ptr_array, name, number, i);
-
-			g_free(number);
-		}
-
-		g_free(name);
-	}
+	g_array_free(hits, TRUE);
+	g_free(key);
 }
 
-static void __bluetooth_pb_get_call_list_by_name(PhoneBookType pb_type,
+static void __bluetooth_pb_search_call_list(PhoneBookType pb_type,
 						GPtrArray *ptr_array,
-						const gchar *find_text,
+						guint8 attribute,
+						BtPbSearchMatch match,
+						const gchar *value,
 						gboolean formatted_name)
 {
-	guint i;
-	guint hash_size;
+	const BtPbSearchView *view;
+	GArray *hits;
+	gchar *key;
 
 	if (ptr_array == NULL)
 		return;
 
-	__bluetooth_pb_create_call_index(pb_type);
+	view = __bluetooth_pb_folder_search_get(pb_type);
+	key = _bluetooth_pb_search_key(attribute, value);
 
-	hash_size = __bluetooth_pb_list_hash_size();
+	hits = _bluetooth_pb_search_view_find(view, attribute, match, key);
+	__bluetooth_pb_search_hits_add(ptr_array, hits, formatted_name);
 
-	for (i = 1; i <= hash_size; i++) {
-		gint phonelog_id;
-		gchar *name;
-
-		phonelog_id = __bluetooth_pb_list_hash_lookup_id(i);
-
-		if (formatted_name)
-			name = _bluetooth_pb_fn_from_phonelog_id(phonelog_id);
-		else
-			name = _bluetooth_pb_name_from_phonelog_id(phonelog_id);
-
-		if(g_str_has_prefix(name , find_text)) {
-			gchar *number;
-
-			number = _bluetooth_pb_number_from_phonelog_id(phonelog_id);
-
-			__bluetooth_pb_list_ptr_array_add(ptr_array, name, number, i);
-
-			g_free(number);
-		}
-
-		g_free(name);
-	}
+	g_array_free(hits, TRUE);
+	g_free(key);
 }
 
 static int __bluetooth_get_calllog_type(int call_type)
@@ -1656,46 +1596,6 @@ static unsigned int __get_call_log_count(unsigned int call_log_type)
 	return count;
 }
 
-static void __bluetooth_pb_list_hash_reset(void)
-{
-	if (contact_list_hash)
-		g_hash_table_destroy(contact_list_hash);
-
-	contact_list_hash = g_hash_table_new(g_direct_hash, g_direct_equal);
-}
-
-static gboolean __bluetooth_pb_list_hash_insert(gint handle,
-						gint id)
-{
-	if (contact_list_hash == NULL)
-		return FALSE;
-
-	g_hash_table_insert(contact_list_hash,
-			GINT_TO_POINTER(handle), GINT_TO_POINTER(id));
-
-	return TRUE;
-}
-
-static gint __bluetooth_pb_list_hash_lookup_id(gint handle)
-{
-	gint id;
-	if (contact_list_hash == NULL)
-		return 0;
-
-	id = GPOINTER_TO_INT(g_hash_table_lookup(contact_list_hash,
-				GINT_TO_POINTER(handle)));
-
-	return id;
-}
-
-static guint __bluetooth_pb_list_hash_size (void)
-{
-	if (contact_list_hash == NULL)
-		return 0;
-
-	return g_hash_table_size(contact_list_hash);
-}
-
 static void __bluetooth_pb_list_ptr_array_add(GPtrArray *ptr_array,
 						const gchar *name,
 						const gchar *number,
@@ -1749,10 +1649,20 @@ static void __bluetooth_pb_agent_signal_handler(int signum)
 static void __bluetooth_pb_contact_changed(void *user_data)
 {
 	BluetoothPbAgent *agent;
+	GArray *changed;
 
 	g_return_if_fail(BLUETOOTH_IS_PB_AGENT(user_data));
 	agent = BLUETOOTH_PB_AGENT(user_data);
 
+	contact_generation++;
+
+	/* one walk of the contacts-svc change log serves both caches */
+	changed = _bluetooth_pb_vcard_cache_contacts_changed();
+	_bluetooth_pb_search_contacts_changed(changed);
+
+	if (changed)
+		g_array_free(changed, TRUE);
+
 	g_signal_emit(agent, signals[CLEAR], 0);
 }
 
@@ -1763,6 +1673,8 @@ static void __bluetooth_pb_call_changed(void *user_data)
 	g_return_if_fail(BLUETOOTH_IS_PB_AGENT(user_data));
 	agent = BLUETOOTH_PB_AGENT(user_data);
 
+	call_generation++;
+
 	g_signal_emit(agent, signals[CLEAR], 0);
 }
 
@@ -1871,6 +1783,12 @@ int main(int argc, char **argv)
 		goto failure;
 	}
 
+	_bluetooth_pb_vcard_cache_init(BT_PB_VCARD_CACHE_MEMORY_MAX,
+				BT_PB_VCARD_CACHE_SPILL_FILE,
+				BT_PB_VCARD_CACHE_SPILL_MAX);
+
+	_bluetooth_pb_search_init();
+
 	contacts_svc_subscribe_change(CTS_SUBSCRIBE_CONTACT_CHANGE,
 				__bluetooth_pb_contact_changed,
 				bluetooth_pb_obj);
@@ -1898,6 +1816,9 @@ int main(int argc, char **argv)
 	contacts_svc_unsubscribe_change(CTS_SUBSCRIBE_PLOG_CHANGE,
 				__bluetooth_pb_call_changed);
 
+	_bluetooth_pb_search_deinit();
+	_bluetooth_pb_vcard_cache_deinit();
+
 	contacts_svc_disconnect();
 
 	g_signal_emit(bluetooth_pb_obj, signals[CLEAR], 0);
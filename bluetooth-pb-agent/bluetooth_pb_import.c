@@ -0,0 +1,315 @@
+/*
+ * Bluetooth-frwk
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact:  Hocheol Seo <hocheol.seo@samsung.com>
+ *		 Girishashok Joshi <girish.joshi@samsung.com>
+ *		 Chanyeol Park <chanyeol.park@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+
+#include <dlog.h>
+#include <contacts-svc.h>
+
+#include "bluetooth_pb_import.h"
+
+#define BT_PB_AGENT	"BT_PB_AGENT"
+#define DBG(fmt, args...) SLOG(LOG_DEBUG, BT_PB_AGENT, "%s():%d "fmt, __func__, __LINE__, ##args)
+#define ERR(fmt, args...) SLOG(LOG_ERROR, BT_PB_AGENT, "%s():%d "fmt, __func__, __LINE__, ##args)
+
+#define VCARD_BEGIN	"BEGIN:VCARD"
+#define VCARD_END	"END:VCARD"
+
+typedef struct {
+	GHashTable *numbers;	/* number key -> NULL, phonebook and imported */
+	gboolean in_trans;	/* a contacts-svc transaction is open */
+	guint pending;		/* successful inserts not committed yet */
+	gint inserted;
+	gint duplicated;
+	gint failed;
+} BtPbImport;
+
+/* the last BT_PB_IMPORT_MATCH_DIGITS digits, so that numbers written
+ * with and without a country code match */
+static gchar *__bluetooth_pb_import_number_key(const gchar *number)
+{
+	gchar *key;
+	gchar *pos;
+	gsize len;
+
+	if (number == NULL)
+		return NULL;
+
+	key = g_malloc(strlen(number) + 1);
+	pos = key;
+
+	while (*number != '\0') {
+		if (g_ascii_isdigit(*number))
+			*pos++ = *number;
+		number++;
+	}
+	*pos = '\0';
+
+	len = pos - key;
+	if (len == 0) {
+		g_free(key);
+		return NULL;
+	}
+
+	if (len > BT_PB_IMPORT_MATCH_DIGITS)
+		memmove(key, key + len - BT_PB_IMPORT_MATCH_DIGITS,
+				BT_PB_IMPORT_MATCH_DIGITS + 1);
+
+	return key;
+}
+
+static void __bluetooth_pb_import_numbers_add(GHashTable *numbers,
+					const gchar *number)
+{
+	gchar *key;
+
+	key = __bluetooth_pb_import_number_key(number);
+	if (key)
+		g_hash_table_replace(numbers, key, NULL);
+}
+
+/* every number of the phonebook from one list query */
+static GHashTable *__bluetooth_pb_import_numbers_new(void)
+{
+	GHashTable *numbers;
+	CTSiter *iter = NULL;
+
+	numbers = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+	if (contacts_svc_get_list(CTS_LIST_ALL_NUMBERINFOS, &iter) != CTS_SUCCESS)
+		return numbers;
+
+	while (contacts_svc_iter_next(iter) == CTS_SUCCESS) {
+		CTSvalue *value = NULL;
+
+		value = contacts_svc_iter_get_info(iter);
+		if (value == NULL)
+			continue;
+
+		__bluetooth_pb_import_numbers_add(numbers,
+				contacts_svc_value_get_str(value,
+						CTS_LIST_NUM_NUMBER_STR));
+
+		contacts_svc_value_free(value);
+	}
+
+	contacts_svc_iter_remove(iter);
+
+	DBG("%d numbers\n", g_hash_table_size(numbers));
+
+	return numbers;
+}
+
+static gboolean __bluetooth_pb_import_duplicated(GHashTable *numbers,
+						GSList *list)
+{
+	GSList *pos;
+
+	for (pos = list; pos != NULL; pos = pos->next) {
+		gchar *key;
+		gboolean found;
+
+		key = __bluetooth_pb_import_number_key(
+				contacts_svc_value_get_str(pos->data,
+						CTS_NUM_VAL_NUMBER_STR));
+		if (key == NULL)
+			continue;
+
+		found = g_hash_table_lookup_extended(numbers, key, NULL, NULL);
+		g_free(key);
+
+		if (found)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+static void __bluetooth_pb_import_commit(BtPbImport *import)
+{
+	if (!import->in_trans)
+		return;
+
+	/* the contacts of the batch only count once they are stored */
+	if (contacts_svc_end_trans(TRUE) < CTS_SUCCESS) {
+		ERR("can not commit %d contacts\n", import->pending);
+		import->failed += import->pending;
+	} else {
+		import->inserted += import->pending;
+	}
+
+	import->in_trans = FALSE;
+	import->pending = 0;
+}
+
+static void __bluetooth_pb_import_vcard(BtPbImport *import,
+					const gchar *vcard)
+{
+	CTSstruct *contact = NULL;
+	GSList *list = NULL;
+
+	if (contacts_svc_get_contact_from_vcard(vcard, &contact) != CTS_SUCCESS) {
+		DBG("can not parse vcard\n");
+		import->failed++;
+		return;
+	}
+
+	contacts_svc_struct_get_list(contact, CTS_CF_NUMBER_LIST, &list);
+
+	if (__bluetooth_pb_import_duplicated(import->numbers, list)) {
+		import->duplicated++;
+		contacts_svc_struct_free(contact);
+		return;
+	}
+
+	if (!import->in_trans) {
+		if (contacts_svc_begin_trans() == CTS_SUCCESS)
+			import->in_trans = TRUE;
+		else
+			ERR("can not begin transaction, inserting alone\n");
+	}
+
+	if (contacts_svc_insert_contact(0, contact) > 0) {
+		GSList *pos;
+
+		/* later cards of the same stream are checked against it */
+		for (pos = list; pos != NULL; pos = pos->next)
+			__bluetooth_pb_import_numbers_add(import->numbers,
+					contacts_svc_value_get_str(pos->data,
+						CTS_NUM_VAL_NUMBER_STR));
+
+		if (import->in_trans)
+			import->pending++;
+		else
+			import->inserted++;
+	} else {
+		import->failed++;
+	}
+
+	contacts_svc_struct_free(contact);
+
+	if (import->pending >= BT_PB_IMPORT_BATCH)
+		__bluetooth_pb_import_commit(import);
+}
+
+/* returns the start of the next line, or end */
+static const gchar *__bluetooth_pb_import_next_line(const gchar *pos,
+						const gchar *end)
+{
+	const gchar *eol;
+
+	eol = memchr(pos, '\n', end - pos);
+	if (eol == NULL)
+		return end;
+
+	return eol + 1;
+}
+
+static gboolean __bluetooth_pb_import_line_is(const gchar *pos,
+					const gchar *end,
+					const gchar *tag)
+{
+	gsize len = strlen(tag);
+
+	if ((gsize)(end - pos) < len)
+		return FALSE;
+
+	return g_ascii_strncasecmp(pos, tag, len) == 0;
+}
+
+gint _bluetooth_pb_import_file(const gchar *filename)
+{
+	BtPbImport import = { 0, };
+	struct stat st;
+
+	const gchar *map;
+	const gchar *end;
+	const gchar *pos;
+	const gchar *card = NULL;
+	gint depth = 0;
+	gint fd;
+
+	if (filename == NULL)
+		return -1;
+
+	fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		ERR("can not open %s\n", filename);
+		return -1;
+	}
+
+	if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+		ERR("can not read %s\n", filename);
+		close(fd);
+		return -1;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (map == MAP_FAILED) {
+		ERR("can not map %s\n", filename);
+		return -1;
+	}
+
+	madvise((void *)map, st.st_size, MADV_SEQUENTIAL);
+
+	import.numbers = __bluetooth_pb_import_numbers_new();
+
+	end = map + st.st_size;
+
+	/* split the stream on BEGIN:VCARD and END:VCARD lines,
+	 * nested (AGENT) vCards stay inside their parent */
+	for (pos = map; pos < end; pos = __bluetooth_pb_import_next_line(pos, end)) {
+		if (__bluetooth_pb_import_line_is(pos, end, VCARD_BEGIN)) {
+			if (depth++ == 0)
+				card = pos;
+		} else if (depth > 0 &&
+				__bluetooth_pb_import_line_is(pos, end, VCARD_END)) {
+			if (--depth == 0) {
+				gchar *vcard;
+
+				vcard = g_strndup(card,
+					__bluetooth_pb_import_next_line(pos, end) - card);
+				__bluetooth_pb_import_vcard(&import, vcard);
+				g_free(vcard);
+			}
+		}
+	}
+
+	__bluetooth_pb_import_commit(&import);
+
+	g_hash_table_destroy(import.numbers);
+	munmap((void *)map, st.st_size);
+
+	DBG("inserted %d duplicated %d failed %d\n", import.inserted,
+			import.duplicated, import.failed);
+
+	return import.inserted;
+}
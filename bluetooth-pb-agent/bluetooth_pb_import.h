@@ -0,0 +1,40 @@
+/*
+ * Bluetooth-frwk
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact:  Hocheol Seo <hocheol.seo@samsung.com>
+ *		 Girishashok Joshi <girish.joshi@samsung.com>
+ *		 Chanyeol Park <chanyeol.park@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __DEF_BT_PB_IMPORT_H_
+#define __DEF_BT_PB_IMPORT_H_
+
+#include <glib.h>
+
+/* Contacts inserted per contacts-svc transaction */
+#define BT_PB_IMPORT_BATCH		100
+
+/* Trailing digits compared when looking for an existing number */
+#define BT_PB_IMPORT_MATCH_DIGITS	8
+
+/* Imports every vCard of filename, skipping contacts with a number that
+ * is already in the phonebook. Returns the number of inserted contacts,
+ * or -1 when the file can not be read */
+gint _bluetooth_pb_import_file(const gchar *filename);
+
+#endif
@@ -0,0 +1,440 @@
+/*
+ * Bluetooth-frwk
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact:  Hocheol Seo <hocheol.seo@samsung.com>
+ *		 Girishashok Joshi <girish.joshi@samsung.com>
+ *		 Chanyeol Park <chanyeol.park@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <dlog.h>
+#include <contacts-svc.h>
+
+#include "bluetooth_pb_search.h"
+
+#define BT_PB_AGENT	"BT_PB_AGENT"
+#define DBG(fmt, args...) SLOG(LOG_DEBUG, BT_PB_AGENT, "%s():%d "fmt, __func__, __LINE__, ##args)
+#define ERR(fmt, args...) SLOG(LOG_ERROR, BT_PB_AGENT, "%s():%d "fmt, __func__, __LINE__, ##args)
+
+typedef struct {
+	GHashTable *contacts;	/* contact id -> BtPbSearchEntry */
+	GHashTable *calls;	/* phonelog id -> BtPbSearchEntry */
+	guint contact_generation;	/* bumped when contact entries go */
+	guint call_generation;		/* bumped when call entries go */
+} BtPbSearchIndex;
+
+static BtPbSearchIndex search = { 0, };
+
+static gchar *__bluetooth_pb_search_name_key(const gchar *name)
+{
+	gchar *normalized;
+	gchar *key;
+
+	if (name == NULL)
+		return g_strdup("");
+
+	normalized = g_utf8_normalize(name, -1, G_NORMALIZE_ALL);
+	if (normalized == NULL)
+		return g_strdup("");
+
+	key = g_utf8_casefold(normalized, -1);
+	g_free(normalized);
+
+	return key;
+}
+
+static gchar *__bluetooth_pb_search_number_key(const gchar *number)
+{
+	gchar *key;
+	gchar *pos;
+
+	if (number == NULL)
+		return g_strdup("");
+
+	key = g_malloc(strlen(number) + 1);
+	pos = key;
+
+	while (*number != '\0') {
+		if (g_ascii_isdigit(*number))
+			*pos++ = *number;
+		number++;
+	}
+	*pos = '\0';
+
+	return key;
+}
+
+static BtPbSearchEntry *__bluetooth_pb_search_entry_new(BtPbProjection *projection)
+{
+	BtPbSearchEntry *entry;
+
+	entry = g_new0(BtPbSearchEntry, 1);
+
+	/* take over the projection strings */
+	entry->projection = *projection;
+	g_free(projection);
+
+	entry->name_key = __bluetooth_pb_search_name_key(entry->projection.fn);
+	entry->number_key = __bluetooth_pb_search_number_key(
+						entry->projection.number);
+
+	return entry;
+}
+
+static void __bluetooth_pb_search_entry_free(gpointer data)
+{
+	BtPbSearchEntry *entry = data;
+
+	g_free(entry->projection.name);
+	g_free(entry->projection.fn);
+	g_free(entry->projection.number);
+	g_free(entry->name_key);
+	g_free(entry->number_key);
+	g_free(entry);
+}
+
+void _bluetooth_pb_search_init(void)
+{
+	if (search.contacts)
+		return;
+
+	search.contacts = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+					NULL, __bluetooth_pb_search_entry_free);
+	search.calls = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+					NULL, __bluetooth_pb_search_entry_free);
+}
+
+void _bluetooth_pb_search_deinit(void)
+{
+	if (search.contacts == NULL)
+		return;
+
+	g_hash_table_destroy(search.contacts);
+	g_hash_table_destroy(search.calls);
+
+	search.contacts = NULL;
+	search.calls = NULL;
+
+	/* views left over can not be valid for a later index */
+	search.contact_generation++;
+	search.call_generation++;
+}
+
+gchar *_bluetooth_pb_search_key(guint8 attribute,
+				const gchar *value)
+{
+	if (attribute == BT_PB_SEARCH_NUMBER)
+		return __bluetooth_pb_search_number_key(value);
+
+	return __bluetooth_pb_search_name_key(value);
+}
+
+static void __bluetooth_pb_search_fill(GHashTable *entries,
+					const GArray *ids,
+					gboolean calls)
+{
+	GArray *missing;
+	GPtrArray *projections;
+	guint i;
+
+	missing = g_array_new(FALSE, FALSE, sizeof(gint));
+
+	for (i = 0; i < ids->len; i++) {
+		gint id = g_array_index(ids, gint, i);
+
+		if (!g_hash_table_lookup(entries, GINT_TO_POINTER(id)))
+			g_array_append_val(missing, id);
+	}
+
+	if (missing->len == 0) {
+		g_array_free(missing, TRUE);
+		return;
+	}
+
+	if (calls)
+		projections = _bluetooth_pb_projection_from_phonelog_ids(
+				(const gint *)missing->data, missing->len);
+	else
+		projections = _bluetooth_pb_projection_from_contact_ids(
+				(const gint *)missing->data, missing->len);
+
+	/* the entries take over the projections */
+	g_ptr_array_set_free_func(projections, NULL);
+
+	for (i = 0; i < missing->len; i++)
+		g_hash_table_insert(entries,
+			GINT_TO_POINTER(g_array_index(missing, gint, i)),
+			__bluetooth_pb_search_entry_new(
+				g_ptr_array_index(projections, i)));
+
+	DBG("%d %s entries indexed\n", missing->len,
+				calls ? "call" : "contact");
+
+	g_ptr_array_free(projections, TRUE);
+	g_array_free(missing, TRUE);
+}
+
+static gint __bluetooth_pb_search_hit_name_cmp(gconstpointer a,
+					gconstpointer b)
+{
+	const BtPbSearchHit *hit_a = a;
+	const BtPbSearchHit *hit_b = b;
+
+	return strcmp(hit_a->entry->name_key, hit_b->entry->name_key);
+}
+
+static gint __bluetooth_pb_search_hit_number_cmp(gconstpointer a,
+					gconstpointer b)
+{
+	const BtPbSearchHit *hit_a = a;
+	const BtPbSearchHit *hit_b = b;
+
+	return strcmp(hit_a->entry->number_key, hit_b->entry->number_key);
+}
+
+static gint __bluetooth_pb_search_hit_handle_cmp(gconstpointer a,
+					gconstpointer b)
+{
+	const BtPbSearchHit *hit_a = a;
+	const BtPbSearchHit *hit_b = b;
+
+	if (hit_a->handle < hit_b->handle)
+		return -1;
+
+	return hit_a->handle > hit_b->handle;
+}
+
+static BtPbSearchView *__bluetooth_pb_search_view_new(GHashTable *entries,
+						const GArray *ids,
+						gboolean calls)
+{
+	BtPbSearchView *view;
+	guint i;
+
+	if (entries == NULL || ids == NULL)
+		return NULL;
+
+	__bluetooth_pb_search_fill(entries, ids, calls);
+
+	view = g_new0(BtPbSearchView, 1);
+	view->calls = calls;
+	view->generation = calls ? search.call_generation :
+					search.contact_generation;
+	view->by_name = g_array_sized_new(FALSE, FALSE,
+					sizeof(BtPbSearchHit), ids->len);
+
+	for (i = 0; i < ids->len; i++) {
+		BtPbSearchHit hit;
+
+		hit.entry = g_hash_table_lookup(entries,
+			GINT_TO_POINTER(g_array_index(ids, gint, i)));
+		hit.handle = i + 1;
+
+		g_array_append_val(view->by_name, hit);
+	}
+
+	view->by_number = g_array_sized_new(FALSE, FALSE,
+					sizeof(BtPbSearchHit), ids->len);
+	g_array_append_vals(view->by_number, view->by_name->data,
+					view->by_name->len);
+
+	g_array_sort(view->by_name, __bluetooth_pb_search_hit_name_cmp);
+	g_array_sort(view->by_number, __bluetooth_pb_search_hit_number_cmp);
+
+	return view;
+}
+
+BtPbSearchView *_bluetooth_pb_search_contacts_view(const GArray *ids)
+{
+	return __bluetooth_pb_search_view_new(search.contacts, ids, FALSE);
+}
+
+BtPbSearchView *_bluetooth_pb_search_calls_view(const GArray *ids)
+{
+	return __bluetooth_pb_search_view_new(search.calls, ids, TRUE);
+}
+
+gboolean _bluetooth_pb_search_view_valid(const BtPbSearchView *view)
+{
+	if (view == NULL || search.contacts == NULL)
+		return FALSE;
+
+	if (view->calls)
+		return view->generation == search.call_generation;
+
+	return view->generation == search.contact_generation;
+}
+
+void _bluetooth_pb_search_view_free(BtPbSearchView *view)
+{
+	if (view == NULL)
+		return;
+
+	g_array_free(view->by_name, TRUE);
+	g_array_free(view->by_number, TRUE);
+	g_free(view);
+}
+
+static const gchar *__bluetooth_pb_search_hit_key(const BtPbSearchHit *hit,
+						guint8 attribute)
+{
+	if (attribute == BT_PB_SEARCH_NUMBER)
+		return hit->entry->number_key;
+
+	return hit->entry->name_key;
+}
+
+GArray *_bluetooth_pb_search_view_find(const BtPbSearchView *view,
+				guint8 attribute,
+				BtPbSearchMatch match,
+				const gchar *key)
+{
+	GArray *sorted;
+	GArray *hits;
+	guint low = 0;
+	guint high;
+	guint i;
+
+	hits = g_array_new(FALSE, FALSE, sizeof(BtPbSearchHit));
+
+	if (view == NULL || key == NULL)
+		return hits;
+
+	if (attribute == BT_PB_SEARCH_NUMBER)
+		sorted = view->by_number;
+	else
+		sorted = view->by_name;
+
+	if (match == BT_PB_SEARCH_SUBSTRING) {
+		for (i = 0; i < sorted->len; i++) {
+			BtPbSearchHit *hit;
+
+			hit = &g_array_index(sorted, BtPbSearchHit, i);
+			if (strstr(__bluetooth_pb_search_hit_key(hit, attribute),
+					key) != NULL)
+				g_array_append_val(hits, *hit);
+		}
+	} else {
+		/* first key not below the prefix, the matches follow it */
+		high = sorted->len;
+		while (low < high) {
+			guint mid = low + (high - low) / 2;
+			BtPbSearchHit *hit;
+
+			hit = &g_array_index(sorted, BtPbSearchHit, mid);
+			if (strcmp(__bluetooth_pb_search_hit_key(hit, attribute),
+					key) < 0)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+
+		for (i = low; i < sorted->len; i++) {
+			BtPbSearchHit *hit;
+
+			hit = &g_array_index(sorted, BtPbSearchHit, i);
+			if (!g_str_has_prefix(
+				__bluetooth_pb_search_hit_key(hit, attribute),
+				key))
+				break;
+
+			g_array_append_val(hits, *hit);
+		}
+	}
+
+	g_array_sort(hits, __bluetooth_pb_search_hit_handle_cmp);
+
+	return hits;
+}
+
+static gboolean __bluetooth_pb_search_call_of(gpointer key,
+					gpointer value,
+					gpointer user_data)
+{
+	BtPbSearchEntry *entry = value;
+	GHashTable *contacts = user_data;
+
+	/* an unmatched number may belong to a new contact */
+	if (entry->projection.contact_id == 0)
+		return TRUE;
+
+	return g_hash_table_lookup_extended(contacts,
+			GINT_TO_POINTER(entry->projection.contact_id),
+			NULL, NULL);
+}
+
+void _bluetooth_pb_search_contacts_changed(const GArray *changed)
+{
+	GHashTable *contacts;
+	guint removed = 0;
+	guint i;
+
+	if (search.contacts == NULL)
+		return;
+
+	if (changed == NULL) {
+		g_hash_table_remove_all(search.contacts);
+		g_hash_table_remove_all(search.calls);
+		search.contact_generation++;
+		search.call_generation++;
+		return;
+	}
+
+	contacts = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+	for (i = 0; i < changed->len; i++) {
+		gpointer id = GINT_TO_POINTER(g_array_index(changed, gint, i));
+
+		if (g_hash_table_remove(search.contacts, id))
+			removed++;
+
+		g_hash_table_insert(contacts, id, id);
+	}
+
+	if (removed > 0)
+		search.contact_generation++;
+
+	/* call entries take their names from contacts */
+	if (g_hash_table_foreach_remove(search.calls,
+			__bluetooth_pb_search_call_of, contacts) > 0)
+		search.call_generation++;
+
+	g_hash_table_destroy(contacts);
+}
+
+static gboolean __bluetooth_pb_search_call_absent(gpointer key,
+						gpointer value,
+						gpointer user_data)
+{
+	GHashTable *present = user_data;
+
+	return !g_hash_table_lookup_extended(present, key, NULL, NULL);
+}
+
+void _bluetooth_pb_search_calls_prune(GHashTable *present)
+{
+	if (search.calls == NULL || present == NULL)
+		return;
+
+	if (g_hash_table_foreach_remove(search.calls,
+			__bluetooth_pb_search_call_absent, present) > 0)
+		search.call_generation++;
+}
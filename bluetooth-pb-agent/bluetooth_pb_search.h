@@ -0,0 +1,92 @@
+/*
+ * Bluetooth-frwk
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact:  Hocheol Seo <hocheol.seo@samsung.com>
+ *		 Girishashok Joshi <girish.joshi@samsung.com>
+ *		 Chanyeol Park <chanyeol.park@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __DEF_BT_PB_SEARCH_H_
+#define __DEF_BT_PB_SEARCH_H_
+
+#include <glib.h>
+
+#include "bluetooth_pb_vcard.h"
+
+/* PBAP SearchAttribute values */
+#define BT_PB_SEARCH_NAME	0x00
+#define BT_PB_SEARCH_NUMBER	0x01
+
+typedef enum {
+	BT_PB_SEARCH_PREFIX,
+	BT_PB_SEARCH_SUBSTRING,
+} BtPbSearchMatch;
+
+typedef struct {
+	BtPbProjection projection;
+	gchar *name_key;	/* normalized, case folded FN */
+	gchar *number_key;	/* digits of the number */
+} BtPbSearchEntry;
+
+typedef struct {
+	const BtPbSearchEntry *entry;
+	guint handle;
+} BtPbSearchHit;
+
+/* The entries of one folder, sorted by key for prefix lookups */
+typedef struct {
+	GArray *by_name;	/* BtPbSearchHit */
+	GArray *by_number;	/* BtPbSearchHit */
+	gboolean calls;
+	guint generation;	/* of the entries pointed to */
+} BtPbSearchView;
+
+void _bluetooth_pb_search_init(void);
+
+void _bluetooth_pb_search_deinit(void);
+
+/* Returns the normalized form of value for attribute, free with g_free */
+gchar *_bluetooth_pb_search_key(guint8 attribute,
+				const gchar *value);
+
+/* Indexes the ids not indexed yet with one batched projection fetch and
+ * returns the view of a folder whose handle n is ids[n - 1] */
+BtPbSearchView *_bluetooth_pb_search_contacts_view(const GArray *ids);
+
+BtPbSearchView *_bluetooth_pb_search_calls_view(const GArray *ids);
+
+/* A view goes stale once entries it points to are dropped */
+gboolean _bluetooth_pb_search_view_valid(const BtPbSearchView *view);
+
+void _bluetooth_pb_search_view_free(BtPbSearchView *view);
+
+/* Returns the BtPbSearchHit matching key in handle order. Prefix queries
+ * are a binary search, substring queries a scan of the keys */
+GArray *_bluetooth_pb_search_view_find(const BtPbSearchView *view,
+				guint8 attribute,
+				BtPbSearchMatch match,
+				const gchar *key);
+
+/* Drops the entries of the changed contact ids and the calls of these
+ * or of no contact, or every entry when changed is NULL */
+void _bluetooth_pb_search_contacts_changed(const GArray *changed);
+
+/* Drops the call entries whose phonelog id is not in present */
+void _bluetooth_pb_search_calls_prune(GHashTable *present);
+
+#endif
@@ -24,6 +24,8 @@
 #include <time.h>
 #include <string.h>
 #include <stdarg.h>
+#include <stdio.h>
+#include <sys/stat.h>
 
 
 #include <glib.h>
@@ -36,6 +38,7 @@
 #include "vconf-keys.h"
 
 #include "bluetooth_pb_vcard.h"
+#include "bluetooth_pb_vcard_cache.h"
 
 #define BT_PB_AGENT	"BT_PB_AGENT"
 #define DBG(fmt, args...) SLOG(LOG_DEBUG, BT_PB_AGENT, "%s():%d "fmt, __func__, __LINE__, ##args)
@@ -81,33 +84,44 @@
 #define QP_ENC_LEN	3
 #define LINEBREAK_LEN	75
 
+/* photo file read size, a multiple of 3 keeps base64 state empty */
+#define PHOTO_BLOCK_LEN		(3 * 1024)
+/* g_base64_encode_step output room for one block, without line breaks */
+#define PHOTO_ENC_LEN		((PHOTO_BLOCK_LEN / 3 + 1) * 4 + 4)
 
-static gchar *__bluetooth_pb_vcard_escape(const gchar *str);
+/* encoded photos kept for re-use, 0 disables the cache */
+#define PHOTO_CACHE_MAX		(1024 * 1024)
+#define PHOTO_CACHE_ENTRY_MAX	(96 * 1024)
 
-static gchar *__bluetooth_pb_vcard_strv_concat(gchar **strv,
-					const gchar *delimeter);
+typedef struct {
+	gchar *path;
+	time_t mtime;
+	off_t size;
+	GString *encoded;	/* folded base64 body */
+	GList *link;		/* link in photo_lru */
+} BtPbPhotoEntry;
 
+static GHashTable *photo_cache = NULL;	/* image path -> BtPbPhotoEntry */
+static GQueue photo_lru = G_QUEUE_INIT;	/* most recently used first */
+static gsize photo_cache_size = 0;
 
-static gboolean __bluetooth_pb_vcard_qp_encode_check(const gchar *str);
 
-static gint __bluetooth_pb_vcard_qp_encode_strlen(const gchar *str,
-						gint len);
 
-static void __bluetooth_pb_vcard_qp_encode_append_to_hex(GString *string,
-							const gchar *str,
-							gint len,
-							gint *line_pos);
+static gchar *__bluetooth_pb_vcard_escape(const gchar *str);
 
-static void __bluetooth_pb_vcard_qp_encode_append_printable_c(GString *string,
-							gchar ch,
-							gint *line_pos);
+static gchar *__bluetooth_pb_vcard_escape_v30(const gchar *str);
 
-static void __bluetooth_pb_vcard_qp_encode_append(GString *string,
-						const gchar *str,
-						gint len,
-						gint *line_pos);
+static gchar *__bluetooth_pb_vcard_escape_value(const gchar *str,
+					guint8 format);
 
-static gchar *__bluetooth_pb_vcard_qp_encode(const gchar *str);
+static gchar *__bluetooth_pb_vcard_strv_concat(gchar **strv,
+					const gchar *separator);
+
+
+static gboolean __bluetooth_pb_vcard_qp_encode_check(const gchar *str);
+
+static void __bluetooth_pb_vcard_qp_encode_append(GString *string,
+						const gchar *str);
 
 static gchar *__bluetooth_pb_vcard_owner(guint64 filter,
 					guint8 format);
@@ -120,75 +134,104 @@ static void __bluetooth_pb_vcard_append_qp_encode_v21(GString *string,
 					const gchar *param,
 					const gchar *value);
 
-static void __bluetooth_pb_vcard_append_base64_encode_v21(GString *string,
-							const gchar *name,
-							const gchar *param,
-							const gchar *value,
-							gsize len,
-							gboolean folding);
+static void __bluetooth_pb_vcard_base64_fold_append(GString *string,
+						const gchar *enc,
+						gsize len,
+						gint *line_pos);
 
-static void __bluetooth_pb_vcard_append_n_v21(GString *string,
-					CTSstruct *contact);
+static gboolean __bluetooth_pb_vcard_base64_file_append(GString *string,
+							FILE *fp);
 
-static void __bluetooth_pb_vcard_append_tel_v21(GString *string,
-						CTSstruct *contact);
+static BtPbPhotoEntry *__bluetooth_pb_vcard_photo_cache_lookup(const gchar *path,
+							struct stat *st);
 
-static void __bluetooth_pb_vcard_append_fn_v21(GString *string,
-					CTSstruct *contact);
+static void __bluetooth_pb_vcard_photo_cache_insert(const gchar *path,
+						struct stat *st,
+						const gchar *encoded,
+						gsize len);
 
-static void __bluetooth_pb_vcard_append_photo_v21(GString *string,
-						CTSstruct *contact);
+static void __bluetooth_pb_vcard_append_n(GString *string,
+					CTSstruct *contact,
+					guint8 format);
 
-static void __bluetooth_pb_vcard_append_bday_v21(GString *string,
-						CTSstruct *contact);
+static void __bluetooth_pb_vcard_append_tel(GString *string,
+						CTSstruct *contact,
+						guint8 format);
 
-static void __bluetooth_pb_vcard_append_adr_v21(GString *string,
-						CTSstruct *contact);
+static void __bluetooth_pb_vcard_append_fn(GString *string,
+					CTSstruct *contact,
+					guint8 format);
+
+static void __bluetooth_pb_vcard_append_nickname(GString *string,
+						CTSstruct *contact,
+						guint8 format);
+
+static void __bluetooth_pb_vcard_append_photo(GString *string,
+						CTSstruct *contact,
+						guint8 format);
+
+static void __bluetooth_pb_vcard_append_bday(GString *string,
+						CTSstruct *contact,
+						guint8 format);
 
-static void __bluetooth_pb_vcard_append_email_v21(GString *string,
-						CTSstruct *contact);
+static void __bluetooth_pb_vcard_append_adr(GString *string,
+						CTSstruct *contact,
+						guint8 format);
 
-static void __bluetooth_pb_vcard_append_title_v21(GString *string,
-						CTSstruct *contact);
+static void __bluetooth_pb_vcard_append_email(GString *string,
+						CTSstruct *contact,
+						guint8 format);
 
-static void __bluetooth_pb_vcard_append_role_v21(GString *string,
-						CTSstruct *contact);
+static void __bluetooth_pb_vcard_append_title(GString *string,
+						CTSstruct *contact,
+						guint8 format);
 
-static void __bluetooth_pb_vcard_append_org_v21(GString *string,
-						CTSstruct *contact);
+static void __bluetooth_pb_vcard_append_role(GString *string,
+						CTSstruct *contact,
+						guint8 format);
 
-static void __bluetooth_pb_vcard_append_note_v21(GString *string,
-						CTSstruct *contact);
+static void __bluetooth_pb_vcard_append_org(GString *string,
+						CTSstruct *contact,
+						guint8 format);
 
-static void __bluetooth_pb_vcard_append_rev_v21(GString *string,
-						CTSstruct *contact);
+static void __bluetooth_pb_vcard_append_note(GString *string,
+						CTSstruct *contact,
+						guint8 format);
 
-static void __bluetooth_pb_vcard_append_url_v21(GString *string,
-						CTSstruct *contact);
+static void __bluetooth_pb_vcard_append_rev(GString *string,
+						CTSstruct *contact,
+						guint8 format);
 
-static void __bluetooth_pb_vcard_append_uid_v21(GString *string,
-						CTSstruct *contact);
+static void __bluetooth_pb_vcard_append_url(GString *string,
+						CTSstruct *contact,
+						guint8 format);
+
+static void __bluetooth_pb_vcard_append_uid(GString *string,
+						CTSstruct *contact,
+						guint8 format);
 
 static void __bluetooth_pb_vcard_append_v30(GString *string,
 					const gchar *name,
 					const gchar *param,
 					const gchar *value);
 
-static void __bluetooth_pb_vcard_remove_v30(GString *string,
-					const gchar *property_name);
+static void __bluetooth_pb_vcard_fold_append_v30(GString *string,
+						const gchar *value,
+						gsize line_pos);
 
-static gchar *__bluetooth_pb_vcard_filter_v30(const gchar *vcard,
-					guint64 filter);
+static void __bluetooth_pb_vcard_append_property(GString *string,
+						guint8 format,
+						const gchar *name,
+						const gchar *param,
+						const gchar *value);
 
-static gchar *__bluetooth_pb_vcard_real_contact_valist_v21(gint contact_id,
-							gint phonelog_id,
-							guint64 filter,
-							const gchar *first_name,
-							va_list args);
+static gchar *__bluetooth_pb_vcard_type_param(gchar **paramv,
+					guint8 format);
 
-static gchar *__bluetooth_pb_vcard_real_contact_valist_v30(gint contact_id,
+static gchar *__bluetooth_pb_vcard_real_contact_valist(gint contact_id,
 							gint phonelog_id,
 							guint64 filter,
+							guint8 format,
 							const gchar *first_name,
 							va_list args);
 
@@ -214,13 +257,15 @@ static gchar *__bluetooth_pb_vcard_real_call(gint phonelog_id,
 
 static gchar **__bluetooth_pb_contact_add_field_str(CTSvalue *value,
 						int *field,
-						gint field_size);
+						gint field_size,
+						guint8 format);
 
 static gchar **__bluetooth_pb_contact_tel_param(CTSvalue *value);
 
 static gchar *__bluetooth_pb_contact_photo_type(const gchar *filename);
 
-static gchar **__bluetooth_pb_contact_addr(CTSvalue *value);
+static gchar **__bluetooth_pb_contact_addr(CTSvalue *value,
+					guint8 format);
 
 static gchar **__bluetooth_pb_contact_addr_param(CTSvalue *value);
 
@@ -228,12 +273,22 @@ static gchar *__bluetooth_pb_phonelog_datetime(gint phonelog_id);
 
 static gchar *__bluetooth_pb_fn_from_contact(CTSstruct *contact);
 
-static gchar *__bluetooth_pb_name_from_contact(CTSstruct *contact);
+static gchar *__bluetooth_pb_name_from_contact(CTSstruct *contact,
+					guint8 format);
 
 static gchar *__bluetooth_pb_number_from_contact(CTSstruct *contact);
 
+static gint __bluetooth_pb_contact_id_from_phonelog(CTSvalue *value);
+
 static gint __bluetooth_pb_contact_id_from_phonelog_id(gint phonelog_id);
 
+static void __bluetooth_pb_projection_contact(BtPbProjection *projection,
+					gint contact_id,
+					gboolean number);
+
+static BtPbProjection *__bluetooth_pb_projection_phonelog(gint phonelog_id,
+						GHashTable *contacts);
+
 static gchar *__bluetooth_pb_vcard_escape(const gchar *str)
 {
 	GString *escaped;
@@ -266,6 +321,50 @@ static gchar *__bluetooth_pb_vcard_escape(const gchar *str)
 	return g_string_free(escaped, FALSE);
 }
 
+/* RFC 2426 text value: '\\', ';' and ',' are escaped, line breaks are \n */
+static gchar *__bluetooth_pb_vcard_escape_v30(const gchar *str)
+{
+	GString *escaped;
+	const gchar *pos;
+
+	if (str == NULL)
+		return NULL;
+
+	escaped = g_string_sized_new(strlen(str));
+
+	for (pos = str; *pos != '\0'; pos++) {
+		switch (*pos) {
+		case '\\':
+		case ';':
+		case ',':
+			g_string_append_c(escaped, '\\');
+			g_string_append_c(escaped, *pos);
+			break;
+		case '\r':
+			if (*(pos + 1) == '\n')
+				pos++;
+			/* fall through */
+		case '\n':
+			g_string_append(escaped, "\\n");
+			break;
+		default:
+			g_string_append_c(escaped, *pos);
+			break;
+		}
+	}
+
+	return g_string_free(escaped, FALSE);
+}
+
+static gchar *__bluetooth_pb_vcard_escape_value(const gchar *str,
+					guint8 format)
+{
+	if (format == VCARD_FORMAT_3_0)
+		return __bluetooth_pb_vcard_escape_v30(str);
+
+	return __bluetooth_pb_vcard_escape(str);
+}
+
 static gchar *__bluetooth_pb_vcard_strv_concat(gchar **strv,
 					const gchar *separator)
 {
@@ -274,7 +373,7 @@ static gchar *__bluetooth_pb_vcard_strv_concat(gchar **strv,
 
 	for (i = 0; strv[i] != NULL; i++) {
 		if (i > 0)
-			g_string_append(string, ";");
+			g_string_append(string, separator);
 
 		g_string_append(string, strv[i]);
 	}
@@ -300,211 +399,208 @@ static gboolean __bluetooth_pb_vcard_qp_encode_check(const gchar *str)
 	return FALSE;
 }
 
-/* get string length, which convert to quoted-printable encoding */
-static gint __bluetooth_pb_vcard_qp_encode_strlen(const gchar *str,
-						gint len)
+/* Byte classes of the quoted-printable encoder */
+#define QP_PLAIN	0	/* printable ascii, copied as is */
+#define QP_SPACE	1	/* ' ' and '\t', copied and start a new word */
+#define QP_NEWLINE	2	/* '\r' and '\n' */
+#define QP_ESCAPE	3	/* control characters, '=' and DEL */
+#define QP_UTF8		4	/* non-ascii, escaped one utf-8 character at a time */
+
+static const guint8 qp_class[256] = {
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 1, 2, 3, 3, 2, 3, 3,	/* 0x00 */
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,	/* 0x10 */
+	1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	/* 0x20 */
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 0, 0,	/* 0x30 */
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	/* 0x40 */
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	/* 0x50 */
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	/* 0x60 */
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3,	/* 0x70 */
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,	/* 0x80 */
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,	/* 0x90 */
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,	/* 0xA0 */
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,	/* 0xB0 */
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,	/* 0xC0 */
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,	/* 0xD0 */
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,	/* 0xE0 */
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,	/* 0xF0 */
+};
+
+static const gchar qp_hex[] = "0123456789ABCDEF";
+
+#define QP_ONES		G_GUINT64_CONSTANT(0x0101010101010101)
+#define QP_HIGHS	G_GUINT64_CONSTANT(0x8080808080808080)
+
+typedef struct {
+	GString *string;
+	gint line_pos;
+} BtPbQpEncoder;
+
+/* length of the QP_PLAIN run at pos, eight bytes at a time */
+static gsize __bluetooth_pb_vcard_qp_plain_run(const guchar *pos, gsize len)
 {
-	gchar *pos;
-
-	gint count = 0;
-	gint length = len;
-
-	if (str == NULL)
-		return 0;
-
-	if (strlen(str) < len )
-		length = -1;
+	gsize run = 0;
 
-	pos = (gchar *)str;
-
-	while (*pos != '\0' && (((pos - str) < length) || length < 0)) {
-		if ((guchar)*pos == '\t') {
-			count++;
-			pos++;
-			continue;
-		}
+	while (len - run >= sizeof(guint64)) {
+		guint64 v;
+		guint64 eq;
 
-		if ((guchar)*pos < ' ' || (guchar)*pos == '=') {
-			count += QP_ENC_LEN;
-			pos++;
-			continue;
-		}
+		memcpy(&v, pos + run, sizeof(v));
+		eq = v ^ (QP_ONES * '=');
 
-		/* check no-ascii utf-8 character */
-		if ((guchar)*pos > '~') {
+		/* any byte below '!', above '~' or equal to '=' */
+		if ((((v - QP_ONES * '!') & ~v) |
+				((v + QP_ONES * (0x7f - '~')) | v) |
+				((eq - QP_ONES) & ~eq)) & QP_HIGHS)
+			break;
 
-			gchar *next;
+		run += sizeof(guint64);
+	}
 
-			next = g_utf8_next_char(pos);
+	while (run < len && qp_class[pos[run]] == QP_PLAIN)
+		run++;
 
-			count += QP_ENC_LEN * (next - pos);
-			pos = next;
-			continue;
-		}
+	return run;
+}
 
-		pos++;
-		count++;
+static void __bluetooth_pb_vcard_qp_soft_break(BtPbQpEncoder *enc, gint width)
+{
+	if (enc->line_pos + width > LINEBREAK_LEN) {
+		g_string_append_len(enc->string, "=\r\n", 3);
+		enc->line_pos = 0;
 	}
-
-	return count;
 }
 
-/* convert to quoted printable code */
-static void __bluetooth_pb_vcard_qp_encode_append_to_hex(GString *string,
-							const gchar *str,
-							gint len,
-							gint *line_pos)
+static void __bluetooth_pb_vcard_qp_escape(BtPbQpEncoder *enc,
+					const guchar *pos, gsize len)
 {
-	int i;
+	gsize old_len;
+	gchar *out;
+	gsize i;
 
-	if (str == NULL || len == 0)
-		return;
+	/* a utf-8 character is never split by a soft line break */
+	__bluetooth_pb_vcard_qp_soft_break(enc, QP_ENC_LEN * len);
 
-	/* add soft linebreak when it exceed */
-	if ((*line_pos + (QP_ENC_LEN * len) > LINEBREAK_LEN)) {
-		g_string_append(string, "=\r\n");
-		*line_pos = 0;
-	}
+	old_len = enc->string->len;
+	g_string_set_size(enc->string, old_len + QP_ENC_LEN * len);
+	out = enc->string->str + old_len;
 
 	for (i = 0; i < len; i++) {
-		g_string_append_printf(string, "=%02X", (guchar)*(str+i));
-		*line_pos += QP_ENC_LEN;
+		*out++ = '=';
+		*out++ = qp_hex[pos[i] >> 4];
+		*out++ = qp_hex[pos[i] & 0x0f];
 	}
-}
 
-/* append plain visiable ascii character */
-static void __bluetooth_pb_vcard_qp_encode_append_printable_c(GString *string,
-							gchar ch,
-							gint *line_pos)
-{
-	/* add soft linebreak when it exceed */
-	if (*line_pos + 1 > LINEBREAK_LEN) {
-		g_string_append(string, "=\r\n");
-		*line_pos = 0;
-	}
-	g_string_append_c(string, ch);
-	(*line_pos)++;
+	enc->line_pos += QP_ENC_LEN * len;
 }
 
-static void __bluetooth_pb_vcard_qp_encode_append(GString *string,
-						const gchar *str,
-						gint len,
-						gint *line_pos)
+/* Encodes one word, which starts with its ' ' or '\t' delimiter if any.
+ * A word that does not fit the current line moves to the next one as a
+ * whole, so the encoding restarts once the overflow is known */
+static void __bluetooth_pb_vcard_qp_encode_word(BtPbQpEncoder *enc,
+					const guchar *word, gsize len)
 {
-	gint length;
-	gint encode_len;
-
-	gint i = 0;
-
-	if (string == NULL)
-		return;
-
-	encode_len = __bluetooth_pb_vcard_qp_encode_strlen(str, len);
-
-	/* add soft linebreak when it exceed */
-	if (((*line_pos + encode_len) > LINEBREAK_LEN) && (*line_pos > 1)) {
-		g_string_append(string, "=\r\n");
-		*line_pos = 0;
-	}
-
-	length = strlen(str);
-	if (length > len)
-		length = len;
+	gsize start_len = enc->string->len;
+	gint start_pos = enc->line_pos;
+	gboolean wrapped = (start_pos <= 1);
+	gsize i = 0;
 
 	while (i < len) {
-		gchar *pos;
+		gsize n;
 
-		pos = ((gchar *)str) + i;
+		switch (qp_class[word[i]]) {
+		case QP_PLAIN:
+			n = __bluetooth_pb_vcard_qp_plain_run(word + i, len - i);
+			break;
+		case QP_SPACE:
+			n = 1;
+			break;
+		case QP_UTF8:
+			n = MIN((gsize)g_utf8_skip[word[i]], len - i);
+			break;
+		default:
+			n = 1;
+			break;
+		}
 
-		/* converts invisiable character and escape character '=' to quoted-printable */
-		if ((guchar)*pos != '\t' &&
-				((guchar)*pos < ' ' || (guchar)*pos == '=')) {
-			__bluetooth_pb_vcard_qp_encode_append_to_hex(string, pos,
-					1, line_pos);
-			i++;
+		if (!wrapped) {
+			gsize enc_len = enc->string->len - start_len;
+			gsize unit_len = n;
 
-			continue;
+			if (qp_class[word[i]] >= QP_ESCAPE)
+				unit_len = QP_ENC_LEN * n;
+
+			if (start_pos + enc_len + unit_len > LINEBREAK_LEN) {
+				g_string_truncate(enc->string, start_len);
+				g_string_append_len(enc->string, "=\r\n", 3);
+				enc->line_pos = 0;
+				wrapped = TRUE;
+				i = 0;
+				continue;
+			}
 		}
 
-		/* converts non-ascii utf-8 character to quoted-printable */
-		if ((guchar)*pos > '~') {
-			gchar *next;
-			int ch_len;
+		if (qp_class[word[i]] >= QP_ESCAPE) {
+			__bluetooth_pb_vcard_qp_escape(enc, word + i, n);
+		} else {
+			gsize done = 0;
 
-			next = g_utf8_next_char(pos);
+			while (done < n) {
+				gsize room;
 
-			ch_len = next - pos;
-			__bluetooth_pb_vcard_qp_encode_append_to_hex(string, pos,
-					ch_len, line_pos);
-			i += ch_len;
+				__bluetooth_pb_vcard_qp_soft_break(enc, 1);
 
-			continue;
+				room = MIN(n - done, (gsize)(LINEBREAK_LEN - enc->line_pos));
+				g_string_append_len(enc->string,
+						(const gchar *)word + i + done, room);
+				enc->line_pos += room;
+				done += room;
+			}
 		}
 
-		__bluetooth_pb_vcard_qp_encode_append_printable_c(string, *pos, line_pos);
-		i++;
+		i += n;
 	}
 }
 
-static gchar* __bluetooth_pb_vcard_qp_encode(const gchar *str)
+/* convert to quoted printable code */
+static void __bluetooth_pb_vcard_qp_encode_append(GString *string,
+						const gchar *str)
 {
-	GString *enc;
-
-	gchar *st_pos;
-	gchar *pos;
+	BtPbQpEncoder enc = { string, 0 };
 
-	gint line_pos = 0;
+	const guchar *pos = (const guchar *)str;
+	const guchar *word = pos;
 
 	if (str == NULL)
-		return NULL;
-
-	enc = g_string_new(NULL);
-
-	st_pos = (gchar *)str;
-	pos = (gchar *)str;
+		return;
 
 	while (*pos != '\0') {
-		/* split string with given delimeter  ' ' or  '\t' */
-		if (*pos == ' '  || *pos == '\t') {
-			__bluetooth_pb_vcard_qp_encode_append(enc, st_pos,
-					(pos - st_pos), &line_pos);
-
-			st_pos = pos;
-			pos++;
-
-			continue;
-		}
-
-		/* split string with given delimeter '\r', '\n' or '\r\n' - newline */
-		if (*pos == '\r' || *pos == '\n' ) {
-			__bluetooth_pb_vcard_qp_encode_append(enc, st_pos,
-					(pos - st_pos), &line_pos);
-
-			/* convers newline to qp_encode with soft linebreak
-			 for example, converts \r\n to  =0D=0A=\r\n */
-			__bluetooth_pb_vcard_qp_encode_append_to_hex(enc, "\r\n",
-					2, &line_pos);
-			g_string_append(enc, "=\r\n ");
+		switch (qp_class[*pos]) {
+		case QP_SPACE:
+			__bluetooth_pb_vcard_qp_encode_word(&enc, word, pos - word);
+			word = pos++;
+			break;
+		case QP_NEWLINE:
+			__bluetooth_pb_vcard_qp_encode_word(&enc, word, pos - word);
 
-			line_pos = 1;
+			/* converts \r, \n or \r\n to =0D=0A with soft linebreak */
+			__bluetooth_pb_vcard_qp_escape(&enc, (const guchar *)"\r\n", 2);
+			g_string_append_len(string, "=\r\n ", 4);
+			enc.line_pos = 1;
 
 			if (*pos == '\r' && *(pos + 1) == '\n')
 				pos += 2;
 			else
 				pos++;
 
-			st_pos = pos;
-
-			continue;
+			word = pos;
+			break;
+		default:
+			pos++;
+			break;
 		}
-
-		pos++;
 	}
 
-	__bluetooth_pb_vcard_qp_encode_append(enc, st_pos,
-			(pos - st_pos), &line_pos);
-
-	return g_string_free(enc, FALSE);
+	__bluetooth_pb_vcard_qp_encode_word(&enc, word, pos - word);
 }
 
 
@@ -565,104 +661,163 @@ static void __bluetooth_pb_vcard_append_qp_encode_v21(GString *string,
 						const gchar *param,
 						const gchar *value)
 {
-	GString *property = NULL;
-
 	if (name == NULL)
 		return;
 
-	property = g_string_new(name);
-	__bluetooth_pb_vcard_append_param_v21(property, param);
+	g_string_append(string, name);
+	__bluetooth_pb_vcard_append_param_v21(string, param);
 
 	if (__bluetooth_pb_vcard_qp_encode_check(value)) {
-		gchar *enc = NULL;
-
-		__bluetooth_pb_vcard_append_param_v21(property,
+		__bluetooth_pb_vcard_append_param_v21(string,
 				"ENCODING=QUOTED-PRINTABLE");
-		__bluetooth_pb_vcard_append_param_v21(property,
+		__bluetooth_pb_vcard_append_param_v21(string,
 				"CHARSET=utf-8");
-		g_string_append(property, ":");
-
-		enc = __bluetooth_pb_vcard_qp_encode(value);
+		g_string_append(string, ":");
 
-		if (enc) {
-			g_string_append(property, enc);
-			g_free(enc);
-		}
+		__bluetooth_pb_vcard_qp_encode_append(string, value);
 	} else {
-		g_string_append(property, ":");
+		g_string_append(string, ":");
 		if (value)
-			g_string_append(property , value);
+			g_string_append(string, value);
 	}
 
-	g_string_append_printf(string, "%s\r\n", property->str);
-
-	g_string_free(property, TRUE);
+	g_string_append(string, "\r\n");
 }
 
 
-static void __bluetooth_pb_vcard_append_base64_encode_v21(GString *string,
-							const gchar *name,
-							const gchar *param,
-							const gchar *value,
-							gsize len,
-							gboolean folding)
+/* appends base64 folded in LINEBREAK_LEN lines, including the leading ' ' */
+static void __bluetooth_pb_vcard_base64_fold_append(GString *string,
+						const gchar *enc,
+						gsize len,
+						gint *line_pos)
 {
-	gchar *enc = NULL;
+	gint fline_len = LINEBREAK_LEN - 1;
 
-	if (name == NULL)
-		return;
+	while (len > 0) {
+		gsize n;
 
-	g_string_append(string, name);
+		if (*line_pos == fline_len) {
+			g_string_append(string, "\r\n ");
+			*line_pos = 0;
+		}
 
-	__bluetooth_pb_vcard_append_param_v21(string, param);
-	__bluetooth_pb_vcard_append_param_v21(string, "ENCODING=BASE64");
+		n = MIN(len, (gsize)(fline_len - *line_pos));
+		g_string_append_len(string, enc, n);
 
-	g_string_append(string, ":");
+		*line_pos += n;
+		enc += n;
+		len -= n;
+	}
+}
 
-	if (value  == NULL)
-		return;
+static gboolean __bluetooth_pb_vcard_base64_file_append(GString *string,
+							FILE *fp)
+{
+	guchar block[PHOTO_BLOCK_LEN];
+	gchar enc[PHOTO_ENC_LEN];
 
-	enc = g_base64_encode((const guchar *)value, len);
+	gint state = 0;
+	gint save = 0;
+	gint line_pos = LINEBREAK_LEN - 1;
 
+	gsize n;
+	gsize len;
 
-	if (folding == FALSE) {
-		g_string_append(string, enc);
-	} else {
-		gint enc_len = strlen(enc);
-		gint i = 0;
+	/* one block in memory at a time, encoded straight into string */
+	while ((n = fread(block, 1, sizeof(block), fp)) > 0) {
+		len = g_base64_encode_step(block, n, FALSE, enc, &state, &save);
+		__bluetooth_pb_vcard_base64_fold_append(string, enc, len, &line_pos);
+	}
 
-		/* count ' ' size for folding */
-		gint fline_len = LINEBREAK_LEN -1;
+	if (ferror(fp))
+		return FALSE;
 
-		for (i = 0; (i * fline_len) < enc_len; i++) {
-			g_string_append(string, "\r\n ");
-			if ((i * fline_len) + fline_len >  enc_len)
-				g_string_append(string, enc + (i * fline_len));
-			else
-				g_string_append_len(string, enc + (i * fline_len), fline_len);
-		}
+	len = g_base64_encode_close(FALSE, enc, &state, &save);
+	__bluetooth_pb_vcard_base64_fold_append(string, enc, len, &line_pos);
 
-		/* some application requires more \r\n */
-		g_string_append(string, "\r\n");
+	return TRUE;
+}
+
+static void __bluetooth_pb_vcard_photo_entry_free(BtPbPhotoEntry *entry)
+{
+	g_queue_delete_link(&photo_lru, entry->link);
+	photo_cache_size -= entry->encoded->len;
+
+	g_hash_table_remove(photo_cache, entry->path);
+
+	g_string_free(entry->encoded, TRUE);
+	g_free(entry->path);
+	g_free(entry);
+}
+
+static BtPbPhotoEntry *__bluetooth_pb_vcard_photo_cache_lookup(const gchar *path,
+							struct stat *st)
+{
+	BtPbPhotoEntry *entry;
+
+	if (photo_cache == NULL)
+		return NULL;
+
+	entry = g_hash_table_lookup(photo_cache, path);
+	if (entry == NULL)
+		return NULL;
+
+	/* the image was replaced */
+	if (entry->mtime != st->st_mtime || entry->size != st->st_size) {
+		__bluetooth_pb_vcard_photo_entry_free(entry);
+		return NULL;
 	}
-	g_string_append(string, "\r\n");
 
-	g_free(enc);
+	g_queue_unlink(&photo_lru, entry->link);
+	g_queue_push_head_link(&photo_lru, entry->link);
+
+	return entry;
+}
+
+static void __bluetooth_pb_vcard_photo_cache_insert(const gchar *path,
+						struct stat *st,
+						const gchar *encoded,
+						gsize len)
+{
+	BtPbPhotoEntry *entry;
+
+	if (PHOTO_CACHE_MAX == 0 || len > PHOTO_CACHE_ENTRY_MAX)
+		return;
+
+	if (photo_cache == NULL)
+		photo_cache = g_hash_table_new(g_str_hash, g_str_equal);
+
+	while (photo_cache_size + len > PHOTO_CACHE_MAX)
+		__bluetooth_pb_vcard_photo_entry_free(g_queue_peek_tail(&photo_lru));
+
+	entry = g_new0(BtPbPhotoEntry, 1);
+	entry->path = g_strdup(path);
+	entry->mtime = st->st_mtime;
+	entry->size = st->st_size;
+	entry->encoded = g_string_new_len(encoded, len);
+
+	g_hash_table_insert(photo_cache, entry->path, entry);
+
+	g_queue_push_head(&photo_lru, entry);
+	entry->link = g_queue_peek_head_link(&photo_lru);
+	photo_cache_size += len;
 }
 
-static void __bluetooth_pb_vcard_append_n_v21(GString *string,
-					CTSstruct *contact)
+static void __bluetooth_pb_vcard_append_n(GString *string,
+					CTSstruct *contact,
+					guint8 format)
 {
 	gchar *str;
 
-	str = __bluetooth_pb_name_from_contact(contact);
-	__bluetooth_pb_vcard_append_qp_encode_v21(string, "N", NULL, str);
+	str = __bluetooth_pb_name_from_contact(contact, format);
+	__bluetooth_pb_vcard_append_property(string, format, "N", NULL, str);
 
 	g_free(str);
 }
 
-static void __bluetooth_pb_vcard_append_tel_v21(GString *string,
-						CTSstruct *contact)
+static void __bluetooth_pb_vcard_append_tel(GString *string,
+						CTSstruct *contact,
+						guint8 format)
 {
 	GSList *list = NULL;
 	GSList *pos = NULL;
@@ -682,19 +837,20 @@ static void __bluetooth_pb_vcard_append_tel_v21(GString *string,
 		escaped = __bluetooth_pb_vcard_escape(tel);
 
 		paramv = __bluetooth_pb_contact_tel_param(value);
-		param = __bluetooth_pb_vcard_strv_concat(paramv, ";");
+		param = __bluetooth_pb_vcard_type_param(paramv, format);
 
 		g_strfreev(paramv);
 
-		__bluetooth_pb_vcard_append_qp_encode_v21(string, "TEL", param, escaped);
+		__bluetooth_pb_vcard_append_property(string, format, "TEL", param, escaped);
 
 		g_free(escaped);
 		g_free(param);
 	}
 }
 
-static void __bluetooth_pb_vcard_append_fn_v21(GString *string,
-					CTSstruct *contact)
+static void __bluetooth_pb_vcard_append_fn(GString *string,
+					CTSstruct *contact,
+					guint8 format)
 {
 	CTSvalue *value = NULL;
 
@@ -704,26 +860,76 @@ static void __bluetooth_pb_vcard_append_fn_v21(GString *string,
 	contacts_svc_struct_get_value(contact, CTS_CF_NAME_VALUE, &value);
 
 	tmp = __bluetooth_pb_fn_from_contact(contact);
-	fn = __bluetooth_pb_vcard_escape(tmp);
+	fn = __bluetooth_pb_vcard_escape_value(tmp, format);
 
-	__bluetooth_pb_vcard_append_qp_encode_v21(string, "FN", NULL, fn);
+	__bluetooth_pb_vcard_append_property(string, format, "FN", NULL, fn);
 
 	g_free(tmp);
 	g_free(fn);
 }
 
-static void __bluetooth_pb_vcard_append_photo_v21(GString *string,
-						CTSstruct *contact)
+/* vCard 3.0 only, the nicknames of a contact form one text list */
+static void __bluetooth_pb_vcard_append_nickname(GString *string,
+						CTSstruct *contact,
+						guint8 format)
+{
+	GSList *list = NULL;
+	GSList *pos = NULL;
+
+	GString *nickname = NULL;
+
+	if (format != VCARD_FORMAT_3_0)
+		return;
+
+	contacts_svc_struct_get_list(contact, CTS_CF_NICKNAME_LIST, &list);
+
+	for (pos = list; pos != NULL; pos = pos->next) {
+		CTSvalue *value = (CTSvalue *)(pos->data);
+
+		const gchar *name;
+		gchar *escaped;
+
+		if (value == NULL)
+			continue;
+
+		name = contacts_svc_value_get_str(value, CTS_NICKNAME_VAL_NAME_STR);
+		if (name == NULL || *name == '\0')
+			continue;
+
+		if (nickname == NULL)
+			nickname = g_string_new(NULL);
+		else
+			g_string_append_c(nickname, ',');
+
+		escaped = __bluetooth_pb_vcard_escape_v30(name);
+		g_string_append(nickname, escaped);
+		g_free(escaped);
+	}
+
+	if (nickname == NULL)
+		return;
+
+	__bluetooth_pb_vcard_append_property(string, format, "NICKNAME", NULL,
+						nickname->str);
+
+	g_string_free(nickname, TRUE);
+}
+
+static void __bluetooth_pb_vcard_append_photo(GString *string,
+						CTSstruct *contact,
+						guint8 format)
 {
 	CTSvalue *value = NULL;
+	BtPbPhotoEntry *entry = NULL;
+	FILE *fp = NULL;
 
 	const gchar *filename = NULL;
 
 	gchar *type = NULL;
-	gchar *param = NULL;
-	gchar *contents = NULL;
+	gsize header;
+	gsize start;
 
-	gsize len = 0;
+	struct stat st;
 
 	contacts_svc_struct_get_value(contact, CTS_CF_BASE_INFO_VALUE, &value);
 	filename = contacts_svc_value_get_str(value, CTS_BASE_VAL_IMG_PATH_STR);
@@ -732,27 +938,70 @@ static void __bluetooth_pb_vcard_append_photo_v21(GString *string,
 		return;
 	}
 
+	if (stat(filename, &st) < 0 || !S_ISREG(st.st_mode)) {
+		ERR("can not read file contents:%s\n", filename);
+		return;
+	}
+
+	entry = __bluetooth_pb_vcard_photo_cache_lookup(filename, &st);
+	if (entry == NULL) {
+		fp = fopen(filename, "rb");
+		if (fp == NULL) {
+			ERR("can not read file contents:%s\n", filename);
+			return;
+		}
+	}
+
 	type = __bluetooth_pb_contact_photo_type(filename);
 
+	header = string->len;
+	g_string_append(string, "PHOTO");
+
+	if (format == VCARD_FORMAT_3_0)
+		g_string_append(string, ";ENCODING=b");
+
 	if (type) {
-		param = g_strdup_printf("TYPE=%s", type);
+		g_string_append_printf(string, ";TYPE=%s", type);
 		g_free(type);
 	}
 
-	if (g_file_get_contents(filename, &contents, &len, NULL) == FALSE) {
-		ERR("can not read file contents:%s\n", filename);
-		return;
-	}
+	if (format == VCARD_FORMAT_3_0)
+		g_string_append(string, ":");
+	else
+		g_string_append(string, ";ENCODING=BASE64:");
+
+	start = string->len;
+
+	if (entry) {
+		g_string_append_len(string, entry->encoded->str,
+					entry->encoded->len);
+	} else {
+		gboolean ret;
 
-	__bluetooth_pb_vcard_append_base64_encode_v21(string,
-			"PHOTO", param, contents, len, TRUE);
+		ret = __bluetooth_pb_vcard_base64_file_append(string, fp);
+		fclose(fp);
 
-	g_free(param);
-	g_free(contents);
+		if (ret == FALSE) {
+			ERR("can not read file contents:%s\n", filename);
+			/* no PHOTO rather than a partial one */
+			g_string_truncate(string, header);
+			return;
+		}
+
+		__bluetooth_pb_vcard_photo_cache_insert(filename, &st,
+				string->str + start, string->len - start);
+	}
+
+	/* some application requires more \r\n */
+	if (format == VCARD_FORMAT_3_0)
+		g_string_append(string, "\r\n");
+	else
+		g_string_append(string, "\r\n\r\n");
 }
 
-static void __bluetooth_pb_vcard_append_bday_v21(GString *string,
-						CTSstruct *contact)
+static void __bluetooth_pb_vcard_append_bday(GString *string,
+						CTSstruct *contact,
+						guint8 format)
 {
 	GSList *list = NULL;
 	GSList *pos = NULL;
@@ -774,15 +1023,16 @@ static void __bluetooth_pb_vcard_append_bday_v21(GString *string,
 
 			bday = g_strdup_printf("%04d-%02d-%02d",
 					(date/10000), (date/100)%100, date%100);
-			__bluetooth_pb_vcard_append_qp_encode_v21(string, "BDAY",
+			__bluetooth_pb_vcard_append_property(string, format, "BDAY",
 					NULL, bday);
 			g_free(bday);
 		}
 	}
 }
 
-static void __bluetooth_pb_vcard_append_adr_v21(GString *string,
-						CTSstruct *contact)
+static void __bluetooth_pb_vcard_append_adr(GString *string,
+						CTSstruct *contact,
+						guint8 format)
 {
 	GSList *list = NULL;
 	GSList *pos = NULL;
@@ -801,7 +1051,7 @@ static void __bluetooth_pb_vcard_append_adr_v21(GString *string,
 		if (value == NULL)
 			continue;
 
-		addrv = __bluetooth_pb_contact_addr(value);
+		addrv = __bluetooth_pb_contact_addr(value, format);
 
 		if (addrv == NULL)
 			continue;
@@ -810,10 +1060,10 @@ static void __bluetooth_pb_vcard_append_adr_v21(GString *string,
 		g_strfreev(addrv);
 
 		paramv = __bluetooth_pb_contact_addr_param(value);
-		param = __bluetooth_pb_vcard_strv_concat(paramv, ";");
+		param = __bluetooth_pb_vcard_type_param(paramv, format);
 		g_strfreev(paramv);
 
-		__bluetooth_pb_vcard_append_qp_encode_v21(string, "ADR",
+		__bluetooth_pb_vcard_append_property(string, format, "ADR",
 				param, addr);
 
 		g_free(param);
@@ -821,8 +1071,9 @@ static void __bluetooth_pb_vcard_append_adr_v21(GString *string,
 	}
 }
 
-static void __bluetooth_pb_vcard_append_email_v21(GString *string,
-						CTSstruct *contact)
+static void __bluetooth_pb_vcard_append_email(GString *string,
+						CTSstruct *contact,
+						guint8 format)
 {
 	GSList *list = NULL;
 	GSList *pos = NULL;
@@ -843,15 +1094,16 @@ static void __bluetooth_pb_vcard_append_email_v21(GString *string,
 			continue;
 
 		escaped = __bluetooth_pb_vcard_escape(email);
-		__bluetooth_pb_vcard_append_qp_encode_v21(string, "EMAIL", NULL, escaped);
+		__bluetooth_pb_vcard_append_property(string, format, "EMAIL", NULL, escaped);
 
 		g_free(escaped);
 	}
 
 }
 
-static void __bluetooth_pb_vcard_append_title_v21(GString *string,
-						CTSstruct *contact)
+static void __bluetooth_pb_vcard_append_title(GString *string,
+						CTSstruct *contact,
+						guint8 format)
 {
 	CTSvalue *value = NULL;
 
@@ -868,14 +1120,15 @@ static void __bluetooth_pb_vcard_append_title_v21(GString *string,
 	if (title == NULL)
 		return;
 
-	escaped = __bluetooth_pb_vcard_escape(title);
-	__bluetooth_pb_vcard_append_qp_encode_v21(string, "TITLE", NULL, escaped);
+	escaped = __bluetooth_pb_vcard_escape_value(title, format);
+	__bluetooth_pb_vcard_append_property(string, format, "TITLE", NULL, escaped);
 
 	g_free(escaped);
 }
 
-static void __bluetooth_pb_vcard_append_role_v21(GString *string,
-						CTSstruct *contact)
+static void __bluetooth_pb_vcard_append_role(GString *string,
+						CTSstruct *contact,
+						guint8 format)
 {
 	CTSvalue *value = NULL;
 	const gchar *role;
@@ -891,14 +1144,15 @@ static void __bluetooth_pb_vcard_append_role_v21(GString *string,
 	if (role == NULL)
 		return;
 
-	escaped = __bluetooth_pb_vcard_escape(role);
-	__bluetooth_pb_vcard_append_qp_encode_v21(string, "ROLE", NULL, escaped);
+	escaped = __bluetooth_pb_vcard_escape_value(role, format);
+	__bluetooth_pb_vcard_append_property(string, format, "ROLE", NULL, escaped);
 
 	g_free(escaped);
 }
 
-static void __bluetooth_pb_vcard_append_org_v21(GString *string,
-						CTSstruct *contact)
+static void __bluetooth_pb_vcard_append_org(GString *string,
+						CTSstruct *contact,
+						guint8 format)
 {
 	CTSvalue *value = NULL;
 
@@ -920,7 +1174,7 @@ static void __bluetooth_pb_vcard_append_org_v21(GString *string,
 	if (name) {
 		gchar *escaped;
 
-		escaped = __bluetooth_pb_vcard_escape(name);
+		escaped = __bluetooth_pb_vcard_escape_value(name, format);
 		g_string_append(org, escaped);
 		g_free(escaped);
 	}
@@ -930,18 +1184,19 @@ static void __bluetooth_pb_vcard_append_org_v21(GString *string,
 	if (department) {
 		gchar *escaped;
 
-		escaped = __bluetooth_pb_vcard_escape(department);
+		escaped = __bluetooth_pb_vcard_escape_value(department, format);
 		g_string_append(org, escaped);
 		g_free(escaped);
 	}
 
-	__bluetooth_pb_vcard_append_qp_encode_v21(string, "ORG", NULL, org->str);
+	__bluetooth_pb_vcard_append_property(string, format, "ORG", NULL, org->str);
 
 	g_string_free(org, TRUE);
 }
 
-static void __bluetooth_pb_vcard_append_note_v21(GString *string,
-						CTSstruct *contact)
+static void __bluetooth_pb_vcard_append_note(GString *string,
+						CTSstruct *contact,
+						guint8 format)
 {
 	CTSvalue *value = NULL;
 
@@ -958,14 +1213,15 @@ static void __bluetooth_pb_vcard_append_note_v21(GString *string,
 	if (note == NULL)
 		return;
 
-	escaped = __bluetooth_pb_vcard_escape(note);
-	__bluetooth_pb_vcard_append_qp_encode_v21(string, "NOTE", NULL, escaped);
+	escaped = __bluetooth_pb_vcard_escape_value(note, format);
+	__bluetooth_pb_vcard_append_property(string, format, "NOTE", NULL, escaped);
 
 	g_free(escaped);
 }
 
-static void __bluetooth_pb_vcard_append_rev_v21(GString *string,
-						CTSstruct *contact)
+static void __bluetooth_pb_vcard_append_rev(GString *string,
+						CTSstruct *contact,
+						guint8 format)
 {
 	CTSvalue *value = NULL;
 
@@ -990,13 +1246,14 @@ static void __bluetooth_pb_vcard_append_rev_v21(GString *string,
 			(1900 + result.tm_year), (1 + result.tm_mon), result.tm_mday,
 			result.tm_hour, result.tm_min, result.tm_sec);
 
-	__bluetooth_pb_vcard_append_qp_encode_v21(string, "REV", NULL, rev);
+	__bluetooth_pb_vcard_append_property(string, format, "REV", NULL, rev);
 
 	g_free(rev);
 }
 
-static void __bluetooth_pb_vcard_append_url_v21(GString *string,
-						CTSstruct *contact)
+static void __bluetooth_pb_vcard_append_url(GString *string,
+						CTSstruct *contact,
+						guint8 format)
 {
 	GSList *list = NULL;
 	GSList *pos = NULL;
@@ -1018,14 +1275,15 @@ static void __bluetooth_pb_vcard_append_url_v21(GString *string,
 			continue;
 
 		escaped = __bluetooth_pb_vcard_escape(url);
-		__bluetooth_pb_vcard_append_qp_encode_v21(string, "URL", NULL, escaped);
+		__bluetooth_pb_vcard_append_property(string, format, "URL", NULL, escaped);
 
 		g_free(escaped);
 	}
 }
 
-static void __bluetooth_pb_vcard_append_uid_v21(GString *string,
-						CTSstruct *contact)
+static void __bluetooth_pb_vcard_append_uid(GString *string,
+						CTSstruct *contact,
+						guint8 format)
 {
 	CTSvalue *value = NULL;
 
@@ -1043,7 +1301,7 @@ static void __bluetooth_pb_vcard_append_uid_v21(GString *string,
 		return;
 
 	escaped = __bluetooth_pb_vcard_escape(uid);
-	__bluetooth_pb_vcard_append_qp_encode_v21(string, "UID", NULL, escaped);
+	__bluetooth_pb_vcard_append_property(string, format, "UID", NULL, escaped);
 
 	g_free(escaped);
 }
@@ -1053,11 +1311,15 @@ static void __bluetooth_pb_vcard_append_v30(GString *string,
 					const gchar *param,
 					const gchar *value)
 {
+	gsize start;
+
 	if (string == NULL)
 		return;
 	if (name == NULL)
 		return;
 
+	start = string->len;
+
 	g_string_append(string, name);
 
 	if (param)
@@ -1066,114 +1328,112 @@ static void __bluetooth_pb_vcard_append_v30(GString *string,
 	g_string_append(string, ":");
 
 	if (value)
-		g_string_append(string, value);
+		__bluetooth_pb_vcard_fold_append_v30(string, value,
+				string->len - start);
 
 	g_string_append(string, "\r\n");
 }
 
-static void __bluetooth_pb_vcard_remove_v30(GString *string,
-					const gchar *property_name)
+/* folds at LINEBREAK_LEN octets without splitting a utf-8 character,
+ * line breaks in the value are written as \n */
+static void __bluetooth_pb_vcard_fold_append_v30(GString *string,
+						const gchar *value,
+						gsize line_pos)
 {
-	gchar *pos = NULL;
-	gchar *st_pos = NULL;
+	const gchar *pos = value;
 
-	gboolean matched = FALSE;
+	while (*pos != '\0') {
+		gsize room;
+		gsize n = 0;
 
-	if(string == NULL || property_name == NULL)
-		return;
+		if (line_pos >= LINEBREAK_LEN) {
+			g_string_append(string, "\r\n ");
+			line_pos = 1;
+		}
 
-	pos = string->str;
+		room = LINEBREAK_LEN - line_pos;
 
-	while(*pos != '\0') {
-		if (matched == FALSE) {
-			if (g_ascii_strncasecmp(pos, "\r\n", 2) == 0) {
-				gint attrlen = 0;
+		if (*pos == '\r' || *pos == '\n') {
+			if (room < 2) {
+				line_pos = LINEBREAK_LEN;
+				continue;
+			}
+
+			g_string_append(string, "\\n");
+			line_pos += 2;
 
-				st_pos = pos;
+			if (*pos == '\r' && *(pos + 1) == '\n')
 				pos += 2;
+			else
+				pos++;
+			continue;
+		}
 
-				attrlen = strlen(property_name);
-				if (g_ascii_strncasecmp(pos, property_name, attrlen) == 0) {
-					pos += attrlen;
+		while (n < room && pos[n] != '\0' &&
+				pos[n] != '\r' && pos[n] != '\n')
+			n++;
 
-					if (*pos == ':' || *pos == ';') {
-						matched = TRUE;
-						pos++;
-					}
-				}
-				continue;
-			}
-		}
-		else {
-			if (g_ascii_strncasecmp(pos, "\r\n", 2) == 0) {
-				pos += 2;
+		if (n == room) {
+			gsize end = n;
+
+			while (end > 0 && ((guchar)pos[end] & 0xc0) == 0x80)
+				end--;
 
-				if (*pos != ' ' && *pos != '\t') {
-					/* +2 means move over \r\n */
-					g_string_erase(string, (st_pos+2)-(string->str), pos-(st_pos +2));
-					pos = st_pos;
-					matched = FALSE;
-				}
+			if (end > 0) {
+				n = end;
+			} else if (line_pos > 1) {
+				line_pos = LINEBREAK_LEN;
 				continue;
 			}
 		}
 
-		pos++;
+		g_string_append_len(string, pos, n);
+		line_pos += n;
+		pos += n;
 	}
 }
 
-static gchar *__bluetooth_pb_vcard_filter_v30(const gchar *vcard,
-					guint64 filter)
+static void __bluetooth_pb_vcard_append_property(GString *string,
+						guint8 format,
+						const gchar *name,
+						const gchar *param,
+						const gchar *value)
 {
-	GString *string = NULL;
-
-	if (vcard == NULL)
-		return NULL;
-
-	string = g_string_new(vcard);
-
-	if ((filter & VCARD_PHOTO) == 0)
-		__bluetooth_pb_vcard_remove_v30(string, "PHOTO");
-
-	if ((filter & VCARD_BDAY) == 0)
-		__bluetooth_pb_vcard_remove_v30(string, "BDAY");
-
-	if ((filter & VCARD_ADR) == 0 )
-		__bluetooth_pb_vcard_remove_v30(string, "ADR");
-
-	if ((filter & VCARD_EMAIL) == 0 )
-		__bluetooth_pb_vcard_remove_v30(string, "EMAIL");
-
-	if ((filter & VCARD_TITLE) == 0 )
-		__bluetooth_pb_vcard_remove_v30(string, "TITLE");
-
-	if ((filter & VCARD_ROLE) == 0 )
-		__bluetooth_pb_vcard_remove_v30(string, "ROLE");
-
-	if ((filter & VCARD_ORG) == 0 )
-		__bluetooth_pb_vcard_remove_v30(string, "ORG");
-
-	if ((filter & VCARD_NOTE) == 0 )
-		__bluetooth_pb_vcard_remove_v30(string, "NOTE");
+	switch (format) {
+	case VCARD_FORMAT_3_0:
+		__bluetooth_pb_vcard_append_v30(string, name, param, value);
+		break;
+	case VCARD_FORMAT_2_1:
+	default:
+		__bluetooth_pb_vcard_append_qp_encode_v21(string, name, param, value);
+		break;
+	}
+}
 
-	if ((filter & VCARD_REV) == 0 )
-		__bluetooth_pb_vcard_remove_v30(string, "REV");
+/* "HOME;VOICE" in vCard 2.1, "TYPE=HOME,VOICE" in vCard 3.0 */
+static gchar *__bluetooth_pb_vcard_type_param(gchar **paramv,
+					guint8 format)
+{
+	gchar *types;
+	gchar *param;
 
-	if ((filter & VCARD_URL) == 0 )
-		__bluetooth_pb_vcard_remove_v30(string, "URL");
+	if (paramv == NULL || paramv[0] == NULL)
+		return NULL;
 
-	if ((filter & VCARD_UID) == 0 )
-		__bluetooth_pb_vcard_remove_v30(string, "UID");
+	if (format != VCARD_FORMAT_3_0)
+		return __bluetooth_pb_vcard_strv_concat(paramv, ";");
 
-	if ((filter & VCARD_NICKNAME) == 0 )
-		__bluetooth_pb_vcard_remove_v30(string, "NICKNAME");
+	types = __bluetooth_pb_vcard_strv_concat(paramv, ",");
+	param = g_strdup_printf("TYPE=%s", types);
+	g_free(types);
 
-	return g_string_free(string, FALSE);
+	return param;
 }
 
-static gchar *__bluetooth_pb_vcard_real_contact_valist_v21(gint contact_id,
+static gchar *__bluetooth_pb_vcard_real_contact_valist(gint contact_id,
 							gint phonelog_id,
 							guint64 filter,
+							guint8 format,
 							const gchar *first_name,
 							va_list args)
 {
@@ -1189,50 +1449,70 @@ static gchar *__bluetooth_pb_vcard_real_contact_valist_v21(gint contact_id,
 	if (ret < 0)
 		return NULL;
 
-	if (f == 0)
-		f = ~f;
+	switch (format) {
+	case VCARD_FORMAT_3_0:
+		/* temporary fixed for some application crash */
+		if (f == 0)
+			f = ~VCARD_NOTE;
 
-	str = g_string_new("BEGIN:VCARD\r\nVERSION:2.1\r\n");
+		/* FN is mandatory in vCard 3.0 */
+		f |= VCARD_FN;
+
+		str = g_string_new("BEGIN:VCARD\r\nVERSION:3.0\r\n");
+		break;
+	case VCARD_FORMAT_2_1:
+	default:
+		if (f == 0)
+			f = ~f;
+
+		str = g_string_new("BEGIN:VCARD\r\nVERSION:2.1\r\n");
+		break;
+	}
 
 	/* N, TEL is default */
-	__bluetooth_pb_vcard_append_n_v21(str, contact);
+	__bluetooth_pb_vcard_append_n(str, contact, format);
 
 	if (phonelog_id > 0) {
 		gchar *number;
 
 		number = _bluetooth_pb_number_from_phonelog_id(phonelog_id);
-		__bluetooth_pb_vcard_append_qp_encode_v21(str, "TEL", "X-0", number);
-		g_free(number);
 
+		if (format == VCARD_FORMAT_3_0)
+			__bluetooth_pb_vcard_append_v30(str, "TEL", NULL, number);
+		else
+			__bluetooth_pb_vcard_append_qp_encode_v21(str, "TEL", "X-0", number);
 
+		g_free(number);
 	} else {
-		__bluetooth_pb_vcard_append_tel_v21(str, contact);
+		__bluetooth_pb_vcard_append_tel(str, contact, format);
 	}
 
 	if (f & VCARD_FN)
-		__bluetooth_pb_vcard_append_fn_v21(str, contact);
+		__bluetooth_pb_vcard_append_fn(str, contact, format);
+	if (f & VCARD_NICKNAME)
+		__bluetooth_pb_vcard_append_nickname(str, contact, format);
 	if (f & VCARD_PHOTO)
-		__bluetooth_pb_vcard_append_photo_v21(str, contact);
+		__bluetooth_pb_vcard_append_photo(str, contact, format);
 	if (f & VCARD_BDAY)
-		__bluetooth_pb_vcard_append_bday_v21(str, contact);
+		__bluetooth_pb_vcard_append_bday(str, contact, format);
 	if (f & VCARD_ADR)
-		__bluetooth_pb_vcard_append_adr_v21(str, contact);
+		__bluetooth_pb_vcard_append_adr(str, contact, format);
 	if (f & VCARD_EMAIL)
-		__bluetooth_pb_vcard_append_email_v21(str, contact);
+		__bluetooth_pb_vcard_append_email(str, contact, format);
 	if (f & VCARD_TITLE)
-		__bluetooth_pb_vcard_append_title_v21(str, contact);
+		__bluetooth_pb_vcard_append_title(str, contact, format);
 	if (f & VCARD_ROLE)
-		__bluetooth_pb_vcard_append_role_v21(str, contact);
+		__bluetooth_pb_vcard_append_role(str, contact, format);
 	if (f & VCARD_ORG)
-		__bluetooth_pb_vcard_append_org_v21(str, contact);
+		__bluetooth_pb_vcard_append_org(str, contact, format);
 	if (f & VCARD_NOTE)
-		__bluetooth_pb_vcard_append_note_v21(str, contact);
+		__bluetooth_pb_vcard_append_note(str, contact, format);
 	if (f & VCARD_REV)
-		__bluetooth_pb_vcard_append_rev_v21(str, contact);
+		__bluetooth_pb_vcard_append_rev(str, contact, format);
 	if (f & VCARD_URL)
-		__bluetooth_pb_vcard_append_url_v21(str, contact);
+		__bluetooth_pb_vcard_append_url(str, contact, format);
 	if (f & VCARD_UID)
-		__bluetooth_pb_vcard_append_uid_v21(str, contact);
+		__bluetooth_pb_vcard_append_uid(str, contact, format);
 
 	while (name) {
 		const gchar *param = va_arg(args, const gchar *);
@@ -1242,7 +1522,8 @@ static gchar *__bluetooth_pb_vcard_real_contact_valist_v21(gint contact_id,
 			gchar *escaped = NULL;
 
 			escaped = __bluetooth_pb_vcard_escape(value);
-			__bluetooth_pb_vcard_append_qp_encode_v21(str, name, param, escaped);
+			__bluetooth_pb_vcard_append_property(str, format,
+					name, param, escaped);
 
 			g_free(escaped);
 		}
@@ -1252,102 +1533,11 @@ static gchar *__bluetooth_pb_vcard_real_contact_valist_v21(gint contact_id,
 
 	g_string_append(str, "END:VCARD\r\n");
 
-	return g_string_free(str, FALSE);
-}
-
-
-static gchar *__bluetooth_pb_vcard_real_contact_valist_v30(gint contact_id,
-							gint phonelog_id,
-							guint64 filter,
-							const gchar *first_name,
-							va_list args)
-{
-	CTSstruct *contact = NULL;
-
-	gint ret = 0;
-
-	const gchar *name = first_name;
-	gchar *vcard = NULL;
-
-	ret = contacts_svc_get_person(contact_id, &contact);
-	if (ret < 0)
-		return NULL;
-
-	ret = contacts_svc_get_vcard_from_contact(contact, &vcard);
-
-	if(vcard == NULL)
-		return NULL;
-
-	/* append contents on vcard */
-	while (name) {
-		const gchar *param = va_arg(args, const gchar *);
-		const gchar *value = va_arg(args, const gchar *);
-		const gchar *local_value = NULL;
-
-		gchar *new_vcard = NULL;
-
-		GString *content = g_string_new(name);
-
-		if (param)
-			g_string_append_printf(content, ";%s", param);
-
-		if (value)
-			local_value = value;
-		else
-			local_value = "";
-
-		new_vcard = contacts_svc_vcard_put_content(vcard, content->str, local_value);
-
-		if(new_vcard) {
-			g_free(vcard);
-			vcard = new_vcard;
-		}
-
-		g_string_free(content, TRUE);
-
-		name = va_arg(args, const gchar *);
-	}
-
-	/* temporary fixed for some application crash */
-	if (filter == 0)
-		filter = ~VCARD_NOTE;
-
-	if (filter) {
-		gchar *new_vcard = NULL;
-
-		new_vcard = __bluetooth_pb_vcard_filter_v30(vcard, filter);
-
-		if (new_vcard) {
-			g_free(vcard);
-			vcard = new_vcard;
-		}
-	}
-
-	/* if phonelog_id exist, we shall show only the phone number that was used for that call */
-	if (phonelog_id > 0) {
-		GString *string = g_string_new(vcard);
-
-		gchar *new_vcard ;
-		gchar *number;
-
-		__bluetooth_pb_vcard_remove_v30(string , "TEL");
-
-		number = _bluetooth_pb_number_from_phonelog_id(phonelog_id);
-		new_vcard = contacts_svc_vcard_put_content(string->str, "TEL", number);
-		g_free(number);
-
-		if (new_vcard) {
-			g_free(vcard);
-			vcard = new_vcard;
-		}
-
-		g_string_free(string, TRUE);
-	}
+	contacts_svc_struct_free(contact);
 
-	return vcard;
+	return g_string_free(str, FALSE);
 }
 
-
 static gchar *__bluetooth_pb_vcard_real_contact_with_properties(gint contact_id,
 								gint phonelog_id,
 								guint64 filter,
@@ -1361,19 +1551,9 @@ static gchar *__bluetooth_pb_vcard_real_contact_with_properties(gint contact_id,
 
 	va_start(args, first_name);
 
-	switch(format) {
-	case VCARD_FORMAT_3_0:
-		vcard = __bluetooth_pb_vcard_real_contact_valist_v30(contact_id,
-				phonelog_id, filter,
-				first_name, args);
-		break;
-	case VCARD_FORMAT_2_1:
-	default:
-		vcard = __bluetooth_pb_vcard_real_contact_valist_v21(contact_id,
-				phonelog_id, filter,
-				first_name, args);
-		break;
-	}
+	vcard = __bluetooth_pb_vcard_real_contact_valist(contact_id,
+			phonelog_id, filter, format,
+			first_name, args);
 
 	va_end(args);
 
@@ -1466,7 +1646,8 @@ static gchar *__bluetooth_pb_vcard_real_call(gint phonelog_id,
 
 static gchar **__bluetooth_pb_contact_add_field_str(CTSvalue *value,
 						int *field,
-						gint field_size)
+						gint field_size,
+						guint8 format)
 {
 	gchar **strv;
 	gint i;
@@ -1496,7 +1677,7 @@ static gchar **__bluetooth_pb_contact_add_field_str(CTSvalue *value,
 		if (tmp == NULL)
 			strv[i] = g_strdup("");
 		else
-			strv[i] = __bluetooth_pb_vcard_escape(tmp);
+			strv[i] = __bluetooth_pb_vcard_escape_value(tmp, format);
 	}
 
 	return strv;
@@ -1641,7 +1822,8 @@ static gchar *__bluetooth_pb_contact_photo_type(const gchar *filename)
 	return g_strdup(filetype);
 }
 
-static gchar **__bluetooth_pb_contact_addr(CTSvalue *value)
+static gchar **__bluetooth_pb_contact_addr(CTSvalue *value,
+					guint8 format)
 {
 	const gint ADDR_LEN = 7;
 
@@ -1655,7 +1837,8 @@ static gchar **__bluetooth_pb_contact_addr(CTSvalue *value)
 			CTS_POSTAL_VAL_POSTALCODE_STR,
 			CTS_POSTAL_VAL_COUNTRY_STR };
 
-	strv = __bluetooth_pb_contact_add_field_str(value, addr, ADDR_LEN);
+	strv = __bluetooth_pb_contact_add_field_str(value, addr, ADDR_LEN,
+							format);
 	return strv;
 }
 
@@ -1766,7 +1949,8 @@ static gchar *__bluetooth_pb_fn_from_contact(CTSstruct *contact)
 	return g_string_free(string, FALSE);
 }
 
-static gchar *__bluetooth_pb_name_from_contact(CTSstruct *contact)
+static gchar *__bluetooth_pb_name_from_contact(CTSstruct *contact,
+					guint8 format)
 {
 	CTSvalue *value = NULL;
 	GString *string = g_string_new(NULL);
@@ -1792,7 +1976,7 @@ static gchar *__bluetooth_pb_name_from_contact(CTSstruct *contact)
 		if (tmp) {
 			gchar *escape = NULL;
 
-			escape = __bluetooth_pb_vcard_escape(tmp);
+			escape = __bluetooth_pb_vcard_escape_value(tmp, format);
 			g_string_append(string, escape);
 
 			g_free(escape);
@@ -1811,6 +1995,9 @@ static gchar *__bluetooth_pb_number_from_contact(CTSstruct *contact)
 
 	contacts_svc_struct_get_list(contact, CTS_CF_NUMBER_LIST, &list);
 
+	if (list == NULL)
+		return NULL;
+
 	for (pos = list;pos != NULL;pos = pos->next) {
 		has_default = contacts_svc_value_get_bool((CTSvalue *)(pos->data),
 							CTS_NUM_VAL_DEFAULT_BOOL);
@@ -1826,18 +2013,9 @@ static gchar *__bluetooth_pb_number_from_contact(CTSstruct *contact)
 						CTS_NUM_VAL_NUMBER_STR));
 }
 
-static gint __bluetooth_pb_contact_id_from_phonelog_id(gint phonelog_id)
+static gint __bluetooth_pb_contact_id_from_phonelog(CTSvalue *value)
 {
-	CTSvalue *value = NULL;
-
 	gint contact_id = 0;
-	gint status = 0;
-
-	status = contacts_svc_get_phonelog(phonelog_id, &value);
-	if (status != CTS_SUCCESS) {
-		DBG("can not get phonelog from id\n");
-		return 0;
-	}
 
 	contact_id = contacts_svc_value_get_int(value,
 			CTS_PLOG_VAL_RELATED_ID_INT);
@@ -1862,6 +2040,106 @@ static gint __bluetooth_pb_contact_id_from_phonelog_id(gint phonelog_id)
 	return contact_id;
 }
 
+static gint __bluetooth_pb_contact_id_from_phonelog_id(gint phonelog_id)
+{
+	CTSvalue *value = NULL;
+
+	gint contact_id = 0;
+	gint status = 0;
+
+	status = contacts_svc_get_phonelog(phonelog_id, &value);
+	if (status != CTS_SUCCESS) {
+		DBG("can not get phonelog from id\n");
+		return 0;
+	}
+
+	contact_id = __bluetooth_pb_contact_id_from_phonelog(value);
+
+	contacts_svc_value_free(value);
+
+	return contact_id;
+}
+
+/* fills name and fn, and number if asked, from one contact fetch */
+static void __bluetooth_pb_projection_contact(BtPbProjection *projection,
+					gint contact_id,
+					gboolean number)
+{
+	CTSstruct *contact = NULL;
+
+	contacts_svc_get_person(contact_id, &contact);
+
+	projection->name = __bluetooth_pb_name_from_contact(contact,
+							VCARD_FORMAT_2_1);
+	projection->fn = __bluetooth_pb_fn_from_contact(contact);
+
+	if (number)
+		projection->number = __bluetooth_pb_number_from_contact(contact);
+
+	contacts_svc_struct_free(contact);
+}
+
+/* contacts maps contact id to BtPbProjection, may be NULL */
+static BtPbProjection *__bluetooth_pb_projection_phonelog(gint phonelog_id,
+						GHashTable *contacts)
+{
+	BtPbProjection *projection;
+	CTSvalue *value = NULL;
+
+	gint contact_id = 0;
+	gint status;
+
+	projection = g_new0(BtPbProjection, 1);
+
+	status = contacts_svc_get_phonelog(phonelog_id, &value);
+	if (status == CTS_SUCCESS) {
+		projection->number = g_strdup(contacts_svc_value_get_str(value,
+						CTS_PLOG_VAL_NUMBER_STR));
+
+		contact_id = __bluetooth_pb_contact_id_from_phonelog(value);
+
+		contacts_svc_value_free(value);
+	} else {
+		DBG("can not get phonelog from id\n");
+	}
+
+	if (contact_id > 0) {
+		BtPbProjection *contact = NULL;
+
+		projection->contact_id = contact_id;
+
+		if (contacts)
+			contact = g_hash_table_lookup(contacts,
+					GINT_TO_POINTER(contact_id));
+
+		if (contact == NULL) {
+			contact = g_new0(BtPbProjection, 1);
+			__bluetooth_pb_projection_contact(contact, contact_id, FALSE);
+
+			if (contacts == NULL) {
+				projection->name = contact->name;
+				projection->fn = contact->fn;
+				g_free(contact);
+
+				return projection;
+			}
+
+			g_hash_table_insert(contacts,
+					GINT_TO_POINTER(contact_id), contact);
+		}
+
+		projection->name = g_strdup(contact->name);
+		projection->fn = g_strdup(contact->fn);
+	} else {
+		const gchar *number = projection->number ? projection->number : "";
+
+		projection->name = g_strdup_printf("%s;;;;", number);
+		projection->fn = g_strdup(number);
+	}
+
+	return projection;
+}
+
 /* API for vcard */
 gboolean _bluetooth_pb_is_incoming_call(gint phonelog_id)
 {
@@ -1955,9 +2233,16 @@ gchar *_bluetooth_pb_vcard_contact(gint contact_id,
 		return str;
 	}
 
+	str = _bluetooth_pb_vcard_cache_lookup(contact_id, filter, format);
+	if (str)
+		return str;
+
 	str = __bluetooth_pb_vcard_real_contact_with_properties(contact_id, 0,
 			filter, format,
 			NULL);
+
+	_bluetooth_pb_vcard_cache_insert(contact_id, filter, format, str);
+
 	return str;
 }
 
@@ -2026,7 +2311,7 @@ gchar *_bluetooth_pb_name_from_contact_id(gint contact_id)
 
 	contacts_svc_get_person(contact_id, &contact);
 
-	str = __bluetooth_pb_name_from_contact(contact);
+	str = __bluetooth_pb_name_from_contact(contact, VCARD_FORMAT_2_1);
 
 	contacts_svc_struct_free(contact);
 
@@ -2124,3 +2409,70 @@ gchar *_bluetooth_pb_number_owner(void)
 {
 	return vconf_get_str(VCONFKEY_TELEPHONY_SUBSCRIBER_NUMBER);
 }
+
+BtPbProjection *_bluetooth_pb_projection_from_contact_id(gint contact_id)
+{
+	BtPbProjection *projection;
+
+	projection = g_new0(BtPbProjection, 1);
+	__bluetooth_pb_projection_contact(projection, contact_id, TRUE);
+
+	return projection;
+}
+
+BtPbProjection *_bluetooth_pb_projection_from_phonelog_id(gint phonelog_id)
+{
+	return __bluetooth_pb_projection_phonelog(phonelog_id, NULL);
+}
+
+GPtrArray *_bluetooth_pb_projection_from_contact_ids(const gint *ids,
+						guint count)
+{
+	GPtrArray *array;
+	guint i;
+
+	array = g_ptr_array_sized_new(count);
+	g_ptr_array_set_free_func(array,
+			(GDestroyNotify)_bluetooth_pb_projection_free);
+
+	for (i = 0; i < count; i++)
+		g_ptr_array_add(array,
+			_bluetooth_pb_projection_from_contact_id(ids[i]));
+
+	return array;
+}
+
+GPtrArray *_bluetooth_pb_projection_from_phonelog_ids(const gint *ids,
+						guint count)
+{
+	GPtrArray *array;
+	GHashTable *contacts;
+	guint i;
+
+	array = g_ptr_array_sized_new(count);
+	g_ptr_array_set_free_func(array,
+			(GDestroyNotify)_bluetooth_pb_projection_free);
+
+	/* a contact called several times in the range is fetched once */
+	contacts = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+			NULL, (GDestroyNotify)_bluetooth_pb_projection_free);
+
+	for (i = 0; i < count; i++)
+		g_ptr_array_add(array,
+			__bluetooth_pb_projection_phonelog(ids[i], contacts));
+
+	g_hash_table_destroy(contacts);
+
+	return array;
+}
+
+void _bluetooth_pb_projection_free(BtPbProjection *projection)
+{
+	if (projection == NULL)
+		return;
+
+	g_free(projection->name);
+	g_free(projection->fn);
+	g_free(projection->number);
+	g_free(projection);
+}
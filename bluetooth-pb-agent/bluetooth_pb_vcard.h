@@ -77,4 +77,25 @@ gchar *_bluetooth_pb_name_owner(void);
 
 gchar *_bluetooth_pb_number_owner(void);
 
+/* name (N), formatted name (FN) and primary number of one listing entry */
+typedef struct {
+	gchar *name;
+	gchar *fn;
+	gchar *number;
+	gint contact_id;	/* a call's contact, 0 when its number has none */
+} BtPbProjection;
+
+BtPbProjection *_bluetooth_pb_projection_from_contact_id(gint contact_id);
+
+BtPbProjection *_bluetooth_pb_projection_from_phonelog_id(gint phonelog_id);
+
+/* Returns a GPtrArray of BtPbProjection, one for each of ids */
+GPtrArray *_bluetooth_pb_projection_from_contact_ids(const gint *ids,
+						guint count);
+
+GPtrArray *_bluetooth_pb_projection_from_phonelog_ids(const gint *ids,
+						guint count);
+
+void _bluetooth_pb_projection_free(BtPbProjection *projection);
+
 #endif
@@ -0,0 +1,436 @@
+/*
+ * Bluetooth-frwk
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact:  Hocheol Seo <hocheol.seo@samsung.com>
+ *		 Girishashok Joshi <girish.joshi@samsung.com>
+ *		 Chanyeol Park <chanyeol.park@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+
+#include <dlog.h>
+#include <contacts-svc.h>
+
+#include "bluetooth_pb_vcard_cache.h"
+
+#define BT_PB_AGENT	"BT_PB_AGENT"
+#define DBG(fmt, args...) SLOG(LOG_DEBUG, BT_PB_AGENT, "%s():%d "fmt, __func__, __LINE__, ##args)
+#define ERR(fmt, args...) SLOG(LOG_ERROR, BT_PB_AGENT, "%s():%d "fmt, __func__, __LINE__, ##args)
+
+/* contacts-svc addressbook of the phone itself */
+#define BT_PB_VCARD_CACHE_ADDRESSBOOK	0
+
+typedef struct {
+	gint contact_id;
+	guint64 filter;
+	guint8 format;
+} BtPbVcardKey;
+
+typedef struct {
+	BtPbVcardKey key;
+	gchar *vcard;		/* NULL while the vCard lives in the spill file */
+	gsize len;
+	gsize spill_offset;
+	GList *link;		/* link in memory_lru or spilled */
+} BtPbVcardEntry;
+
+typedef struct {
+	GHashTable *entries;	/* BtPbVcardKey -> BtPbVcardEntry */
+	GHashTable *contacts;	/* contact id -> GSList of BtPbVcardEntry */
+	GQueue *memory_lru;	/* in-memory entries, most recently used first */
+	GQueue *spilled;	/* entries in the spill file */
+	gsize memory_used;
+	gsize memory_max;
+
+	gint spill_fd;
+	guint8 *spill_map;
+	gsize spill_used;
+	gsize spill_max;
+
+	gint version;		/* contacts-svc change version seen last */
+} BtPbVcardCache;
+
+static BtPbVcardCache cache = { 0, };
+
+static guint __bluetooth_pb_vcard_key_hash(gconstpointer v)
+{
+	const BtPbVcardKey *key = v;
+
+	return (guint)key->contact_id ^ (guint)(key->filter >> 32) ^
+			(guint)key->filter ^ ((guint)key->format << 24);
+}
+
+static gboolean __bluetooth_pb_vcard_key_equal(gconstpointer a,
+					gconstpointer b)
+{
+	const BtPbVcardKey *ka = a;
+	const BtPbVcardKey *kb = b;
+
+	return ka->contact_id == kb->contact_id &&
+			ka->filter == kb->filter &&
+			ka->format == kb->format;
+}
+
+/* Collects into changed the contacts modified after since, changed may be
+ * NULL, since < 0 only reads the current version */
+static gint __bluetooth_pb_vcard_cache_version(gint since, GArray *changed)
+{
+	CTSiter *iter = NULL;
+	gint version = MAX(since, 0);
+
+	if (contacts_svc_get_updated_contacts(BT_PB_VCARD_CACHE_ADDRESSBOOK,
+				MAX(since, 0), &iter) != CTS_SUCCESS)
+		return -1;
+
+	while (contacts_svc_iter_next(iter) == CTS_SUCCESS) {
+		CTSvalue *value = NULL;
+		gint ver;
+
+		value = contacts_svc_iter_get_info(iter);
+		if (value == NULL)
+			continue;
+
+		ver = contacts_svc_value_get_int(value, CTS_LIST_CHANGE_VER_INT);
+		if (ver > version)
+			version = ver;
+
+		if (since >= 0 && changed) {
+			gint contact_id;
+
+			contact_id = contacts_svc_value_get_int(value,
+						CTS_LIST_CHANGE_ID_INT);
+			g_array_append_val(changed, contact_id);
+		}
+
+		contacts_svc_value_free(value);
+	}
+
+	contacts_svc_iter_remove(iter);
+
+	return version;
+}
+
+static void __bluetooth_pb_vcard_cache_unlink(BtPbVcardEntry *entry)
+{
+	GSList *list;
+
+	list = g_hash_table_lookup(cache.contacts,
+				GINT_TO_POINTER(entry->key.contact_id));
+	list = g_slist_remove(list, entry);
+
+	if (list)
+		g_hash_table_insert(cache.contacts,
+				GINT_TO_POINTER(entry->key.contact_id), list);
+	else
+		g_hash_table_remove(cache.contacts,
+				GINT_TO_POINTER(entry->key.contact_id));
+
+	if (entry->vcard) {
+		g_queue_delete_link(cache.memory_lru, entry->link);
+		cache.memory_used -= entry->len;
+	} else {
+		g_queue_delete_link(cache.spilled, entry->link);
+	}
+
+	g_hash_table_remove(cache.entries, &entry->key);
+}
+
+static void __bluetooth_pb_vcard_cache_entry_free(BtPbVcardEntry *entry)
+{
+	__bluetooth_pb_vcard_cache_unlink(entry);
+
+	g_free(entry->vcard);
+	g_free(entry);
+}
+
+static void __bluetooth_pb_vcard_cache_spill_reset(void)
+{
+	BtPbVcardEntry *entry;
+
+	while ((entry = g_queue_peek_head(cache.spilled)) != NULL)
+		__bluetooth_pb_vcard_cache_entry_free(entry);
+
+	cache.spill_used = 0;
+}
+
+/* Moves the least recently used entry out of memory */
+static void __bluetooth_pb_vcard_cache_evict(void)
+{
+	BtPbVcardEntry *entry;
+
+	entry = g_queue_peek_tail(cache.memory_lru);
+	if (entry == NULL)
+		return;
+
+	if (cache.spill_map == NULL || entry->len > cache.spill_max) {
+		__bluetooth_pb_vcard_cache_entry_free(entry);
+		return;
+	}
+
+	/* The spill file is a ring that is emptied when it wraps */
+	if (cache.spill_used + entry->len > cache.spill_max)
+		__bluetooth_pb_vcard_cache_spill_reset();
+
+	memcpy(cache.spill_map + cache.spill_used, entry->vcard, entry->len);
+	entry->spill_offset = cache.spill_used;
+	cache.spill_used += entry->len;
+
+	g_queue_delete_link(cache.memory_lru, entry->link);
+	cache.memory_used -= entry->len;
+
+	g_free(entry->vcard);
+	entry->vcard = NULL;
+
+	g_queue_push_head(cache.spilled, entry);
+	entry->link = g_queue_peek_head_link(cache.spilled);
+}
+
+static void __bluetooth_pb_vcard_cache_spill_open(const gchar *spill_path,
+						gsize spill_max)
+{
+	gint fd;
+	void *map;
+
+	if (spill_path == NULL || spill_max == 0)
+		return;
+
+	unlink(spill_path);
+
+	fd = open(spill_path, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+	if (fd < 0) {
+		ERR("can not open %s\n", spill_path);
+		return;
+	}
+
+	/* Nothing outlives the agent, the file goes away with the fd */
+	unlink(spill_path);
+
+	if (ftruncate(fd, spill_max) < 0) {
+		ERR("can not size %s\n", spill_path);
+		close(fd);
+		return;
+	}
+
+	map = mmap(NULL, spill_max, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		ERR("can not map %s\n", spill_path);
+		close(fd);
+		return;
+	}
+
+	cache.spill_fd = fd;
+	cache.spill_map = map;
+	cache.spill_max = spill_max;
+}
+
+void _bluetooth_pb_vcard_cache_init(gsize memory_max,
+				const gchar *spill_path,
+				gsize spill_max)
+{
+	if (cache.entries)
+		return;
+
+	cache.entries = g_hash_table_new(__bluetooth_pb_vcard_key_hash,
+					__bluetooth_pb_vcard_key_equal);
+	cache.contacts = g_hash_table_new(g_direct_hash, g_direct_equal);
+	cache.memory_lru = g_queue_new();
+	cache.spilled = g_queue_new();
+	cache.memory_max = memory_max;
+	cache.spill_fd = -1;
+
+	__bluetooth_pb_vcard_cache_spill_open(spill_path, spill_max);
+
+	cache.version = __bluetooth_pb_vcard_cache_version(-1, NULL);
+
+	DBG("memory %d spill %d version %d\n", (gint)memory_max,
+				(gint)cache.spill_max, cache.version);
+}
+
+void _bluetooth_pb_vcard_cache_deinit(void)
+{
+	if (cache.entries == NULL)
+		return;
+
+	_bluetooth_pb_vcard_cache_clear();
+
+	g_hash_table_destroy(cache.entries);
+	g_hash_table_destroy(cache.contacts);
+	g_queue_free(cache.memory_lru);
+	g_queue_free(cache.spilled);
+
+	if (cache.spill_map) {
+		munmap(cache.spill_map, cache.spill_max);
+		close(cache.spill_fd);
+	}
+
+	memset(&cache, 0, sizeof(cache));
+}
+
+gchar *_bluetooth_pb_vcard_cache_lookup(gint contact_id,
+				guint64 filter,
+				guint8 format)
+{
+	BtPbVcardKey key = { contact_id, filter, format };
+	BtPbVcardEntry *entry;
+
+	if (cache.entries == NULL)
+		return NULL;
+
+	entry = g_hash_table_lookup(cache.entries, &key);
+	if (entry == NULL)
+		return NULL;
+
+	if (entry->vcard) {
+		g_queue_unlink(cache.memory_lru, entry->link);
+		g_queue_push_head_link(cache.memory_lru, entry->link);
+
+		return g_strndup(entry->vcard, entry->len);
+	}
+
+	/* Bring a spilled vCard back into memory */
+	g_queue_delete_link(cache.spilled, entry->link);
+
+	entry->vcard = g_strndup((gchar *)cache.spill_map + entry->spill_offset,
+				entry->len);
+	cache.memory_used += entry->len;
+
+	g_queue_push_head(cache.memory_lru, entry);
+	entry->link = g_queue_peek_head_link(cache.memory_lru);
+
+	while (cache.memory_used > cache.memory_max &&
+			g_queue_peek_tail(cache.memory_lru) != entry)
+		__bluetooth_pb_vcard_cache_evict();
+
+	return g_strndup(entry->vcard, entry->len);
+}
+
+void _bluetooth_pb_vcard_cache_insert(gint contact_id,
+				guint64 filter,
+				guint8 format,
+				const gchar *vcard)
+{
+	BtPbVcardKey key = { contact_id, filter, format };
+	BtPbVcardEntry *entry;
+	GSList *list;
+
+	if (cache.entries == NULL || vcard == NULL)
+		return;
+
+	entry = g_hash_table_lookup(cache.entries, &key);
+	if (entry)
+		__bluetooth_pb_vcard_cache_entry_free(entry);
+
+	entry = g_new0(BtPbVcardEntry, 1);
+	entry->key = key;
+	entry->len = strlen(vcard);
+
+	if (entry->len > cache.memory_max) {
+		g_free(entry);
+		return;
+	}
+
+	entry->vcard = g_strndup(vcard, entry->len);
+
+	while (cache.memory_used + entry->len > cache.memory_max)
+		__bluetooth_pb_vcard_cache_evict();
+
+	g_hash_table_insert(cache.entries, &entry->key, entry);
+
+	list = g_hash_table_lookup(cache.contacts, GINT_TO_POINTER(contact_id));
+	g_hash_table_insert(cache.contacts, GINT_TO_POINTER(contact_id),
+				g_slist_prepend(list, entry));
+
+	g_queue_push_head(cache.memory_lru, entry);
+	entry->link = g_queue_peek_head_link(cache.memory_lru);
+	cache.memory_used += entry->len;
+}
+
+void _bluetooth_pb_vcard_cache_invalidate(gint contact_id)
+{
+	GSList *list;
+
+	if (cache.entries == NULL)
+		return;
+
+	list = g_hash_table_lookup(cache.contacts, GINT_TO_POINTER(contact_id));
+
+	while (list) {
+		BtPbVcardEntry *entry = list->data;
+
+		/* unlink() updates the contact list, so re-read it */
+		__bluetooth_pb_vcard_cache_entry_free(entry);
+
+		list = g_hash_table_lookup(cache.contacts,
+					GINT_TO_POINTER(contact_id));
+	}
+}
+
+void _bluetooth_pb_vcard_cache_clear(void)
+{
+	BtPbVcardEntry *entry;
+
+	if (cache.entries == NULL)
+		return;
+
+	while ((entry = g_queue_peek_head(cache.memory_lru)) != NULL)
+		__bluetooth_pb_vcard_cache_entry_free(entry);
+
+	__bluetooth_pb_vcard_cache_spill_reset();
+}
+
+GArray *_bluetooth_pb_vcard_cache_contacts_changed(void)
+{
+	GArray *changed;
+	gint version;
+	guint i;
+
+	if (cache.entries == NULL)
+		return NULL;
+
+	if (cache.version < 0) {
+		_bluetooth_pb_vcard_cache_clear();
+		cache.version = __bluetooth_pb_vcard_cache_version(-1, NULL);
+		return NULL;
+	}
+
+	changed = g_array_new(FALSE, FALSE, sizeof(gint));
+	version = __bluetooth_pb_vcard_cache_version(cache.version, changed);
+
+	/* Nothing reported for the phone addressbook, so the change is
+	 * somewhere this cache can not track */
+	if (version <= cache.version) {
+		g_array_free(changed, TRUE);
+		_bluetooth_pb_vcard_cache_clear();
+		return NULL;
+	}
+
+	DBG("version %d -> %d\n", cache.version, version);
+
+	for (i = 0; i < changed->len; i++)
+		_bluetooth_pb_vcard_cache_invalidate(
+				g_array_index(changed, gint, i));
+
+	cache.version = version;
+
+	return changed;
+}
@@ -0,0 +1,63 @@
+/*
+ * Bluetooth-frwk
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact:  Hocheol Seo <hocheol.seo@samsung.com>
+ *		 Girishashok Joshi <girish.joshi@samsung.com>
+ *		 Chanyeol Park <chanyeol.park@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __DEF_BT_PB_VCARD_CACHE_H_
+#define __DEF_BT_PB_VCARD_CACHE_H_
+
+#include <glib.h>
+
+/* Bytes of rendered vCards kept in memory */
+#define BT_PB_VCARD_CACHE_MEMORY_MAX	(1024 * 1024)
+
+/* Bytes of the mapped spill file, 0 disables spilling */
+#define BT_PB_VCARD_CACHE_SPILL_MAX	(4 * 1024 * 1024)
+#define BT_PB_VCARD_CACHE_SPILL_FILE	"/tmp/.bluetooth_pb_vcard_cache"
+
+/* spill_path may be NULL to keep the cache in memory only */
+void _bluetooth_pb_vcard_cache_init(gsize memory_max,
+				const gchar *spill_path,
+				gsize spill_max);
+
+void _bluetooth_pb_vcard_cache_deinit(void);
+
+/* Returns a newly allocated copy, or NULL on a miss */
+gchar *_bluetooth_pb_vcard_cache_lookup(gint contact_id,
+				guint64 filter,
+				guint8 format);
+
+void _bluetooth_pb_vcard_cache_insert(gint contact_id,
+				guint64 filter,
+				guint8 format,
+				const gchar *vcard);
+
+void _bluetooth_pb_vcard_cache_invalidate(gint contact_id);
+
+void _bluetooth_pb_vcard_cache_clear(void);
+
+/* Drops the vCards of contacts modified since the last call. Returns the
+ * ids of those contacts for the other per-contact caches, free with
+ * g_array_free, or NULL when the change could not be tracked and every
+ * vCard was dropped */
+GArray *_bluetooth_pb_vcard_cache_contacts_changed(void);
+
+#endif
@@ -41,6 +41,7 @@ typedef struct {
 	DBusGProxy *proxy;
 	DBusGProxy *dbus_proxy;
 	DBusGProxy *manager_proxy;
+	char adapter_path[BT_ADAPTER_PATH_LEN];	/* Updated by Manager signals */
 } telephony_dbus_info_t;
 
 static GObject *object;
@@ -97,10 +98,13 @@ static void __bluetooth_telephony_name_owner_changed(DBusGProxy *dbus_proxy,
 					const char *new, gpointer user_data);
 static void __bluetooth_telephony_adapter_added_cb(DBusGProxy *manager_proxy,
 				const char *adapter_path, gpointer user_data);
+static void __bluetooth_telephony_adapter_removed_cb(DBusGProxy *manager_proxy,
+				const char *adapter_path, gpointer user_data);
 static int __bluetooth_telephony_proxy_init(void);
 static void __bluetooth_telephony_proxy_deinit(void);
 static int __bluetooth_telephony_register(void);
 static int __bluetooth_telephony_unregister(void);
+static int __bluetooth_telephony_init_adapter_path(void);
 static int __bluetooth_get_default_adapter_path(DBusGConnection *GConn,
 							char *path);
 static gboolean __bluetooth_telephony_is_headset(uint32_t device_class);
@@ -662,6 +666,7 @@ static void __bluetooth_telephony_name_owner_changed(DBusGProxy *dbus_proxy,
 	if (g_strcmp0(name, BLUEZ_SERVICE_NAME) == 0 && *new == '\0') {
 		DBG("BlueZ is terminated and flag need to be reset");
 		is_active = FALSE;
+		telephony_dbus_info.adapter_path[0] = '\0';
 		DBG("Send disabled to application\n");
 	}
 
@@ -679,6 +684,8 @@ static void __bluetooth_telephony_adapter_added_cb(DBusGProxy *manager_proxy,
 	if (strstr(adapter_path, "hci0")) {
 		DBG("BlueZ is Activated and flag need to be reset");
 		is_active = TRUE;
+		g_strlcpy(telephony_dbus_info.adapter_path, adapter_path,
+						BT_ADAPTER_PATH_LEN);
 		DBG("Send enabled to application\n");
 
 		ret = __bluetooth_telephony_register();
@@ -707,6 +714,15 @@ static void __bluetooth_telephony_adapter_added_cb(DBusGProxy *manager_proxy,
 	}
 }
 
+static void __bluetooth_telephony_adapter_removed_cb(DBusGProxy *manager_proxy,
+				const char *adapter_path, gpointer user_data)
+{
+	DBG("Adapter removed [%s] \n", adapter_path);
+
+	if (g_strcmp0(telephony_dbus_info.adapter_path, adapter_path) == 0)
+		telephony_dbus_info.adapter_path[0] = '\0';
+}
+
 static int __bluetooth_telephony_proxy_init(void)
 {
 	DBG("__bluetooth_audio_proxy_init +\n");
@@ -771,14 +787,14 @@ static  int __bluetooth_telephony_unregister(void)
 	return ret;
 }
 
-static int __bluetooth_get_default_adapter_path(DBusGConnection *GConn,
-							char *path)
+static int __bluetooth_telephony_init_adapter_path(void)
 {
 	GError *err = NULL;
 	char *adapter_path = NULL;
 
-	DBG("__bluetooth_get_default_adapter_path + \n");
+	DBG("__bluetooth_telephony_init_adapter_path + \n");
 
+	telephony_dbus_info.adapter_path[0] = '\0';
 
 	if (!dbus_g_proxy_call(telephony_dbus_info.manager_proxy,
 				"DefaultAdapter", &err, G_TYPE_INVALID,
@@ -798,12 +814,29 @@ static int __bluetooth_get_default_adapter_path(DBusGConnection *GConn,
 
 	if (strlen(adapter_path) >= BT_ADAPTER_PATH_LEN) {
 		DBG("Path too long.\n");
+		g_free(adapter_path);
 		return BLUETOOTH_TELEPHONY_ERROR_INTERNAL;
 	}
 
 	DBG("path = %s\n", adapter_path);
-	g_strlcpy(path, adapter_path, BT_ADAPTER_PATH_LEN);
-	DBG("__bluetooth_get_default_adapter_path -\n");
+	g_strlcpy(telephony_dbus_info.adapter_path, adapter_path,
+						BT_ADAPTER_PATH_LEN);
+	g_free(adapter_path);
+	DBG("__bluetooth_telephony_init_adapter_path -\n");
+	return BLUETOOTH_TELEPHONY_ERROR_NONE;
+}
+
+/* Served from the adapter path kept up to date by the AdapterAdded,
+   AdapterRemoved and NameOwnerChanged handlers */
+static int __bluetooth_get_default_adapter_path(DBusGConnection *GConn,
+							char *path)
+{
+	if (telephony_dbus_info.adapter_path[0] == '\0') {
+		DBG("No default adapter\n");
+		return BLUETOOTH_TELEPHONY_ERROR_INTERNAL;
+	}
+
+	g_strlcpy(path, telephony_dbus_info.adapter_path, BT_ADAPTER_PATH_LEN);
 	return BLUETOOTH_TELEPHONY_ERROR_NONE;
 }
 
@@ -1035,7 +1068,6 @@ BT_EXPORT_API int bluetooth_telephony_init(bt_telephony_func_ptr cb,
 	DBusConnection *conn;
 	int ret;
 	GError *error = NULL;
-	char object_path[BT_ADAPTER_PATH_LEN] = {0};
 	DBG("bluetooth_telephony_init +\n");
 
 	if (NULL == cb)
@@ -1114,6 +1146,14 @@ BT_EXPORT_API int bluetooth_telephony_init(bt_telephony_func_ptr cb,
 			G_CALLBACK(__bluetooth_telephony_adapter_added_cb),
 			NULL, NULL);
 
+	dbus_g_proxy_add_signal(telephony_dbus_info.manager_proxy,
+				"AdapterRemoved",
+				DBUS_TYPE_G_OBJECT_PATH, G_TYPE_INVALID);
+	dbus_g_proxy_connect_signal(telephony_dbus_info.manager_proxy,
+			"AdapterRemoved",
+			G_CALLBACK(__bluetooth_telephony_adapter_removed_cb),
+			NULL, NULL);
+
 	/*Callback and user applicaton data*/
 	telephony_info.cb = cb;
 	telephony_info.user_data = user_data;
@@ -1137,8 +1177,7 @@ BT_EXPORT_API int bluetooth_telephony_init(bt_telephony_func_ptr cb,
 	}
 
 	/*Check for BT status*/
-	ret = __bluetooth_get_default_adapter_path(telephony_dbus_info.conn,
-								object_path);
+	ret = __bluetooth_telephony_init_adapter_path();
 	if (ret != BLUETOOTH_TELEPHONY_ERROR_NONE)
 		return BLUETOOTH_TELEPHONY_ERROR_NOT_ENABLED;
 
@@ -1173,6 +1212,13 @@ fail:
 		G_CALLBACK(__bluetooth_telephony_adapter_added_cb),
 		NULL);
 
+	dbus_g_proxy_disconnect_signal(
+		telephony_dbus_info.manager_proxy,
+		"AdapterRemoved",
+		G_CALLBACK(__bluetooth_telephony_adapter_removed_cb),
+		NULL);
+	telephony_dbus_info.adapter_path[0] = '\0';
+
 	dbus_g_connection_unref(telephony_dbus_info.conn);
 	telephony_dbus_info.conn = NULL;
 	g_object_unref(telephony_dbus_info.manager_proxy);
@@ -1215,6 +1261,13 @@ BT_EXPORT_API int bluetooth_telephony_deinit(void)
 		G_CALLBACK(__bluetooth_telephony_adapter_added_cb),
 		NULL);
 
+	dbus_g_proxy_disconnect_signal(
+		telephony_dbus_info.manager_proxy,
+		"AdapterRemoved",
+		G_CALLBACK(__bluetooth_telephony_adapter_removed_cb),
+		NULL);
+	telephony_dbus_info.adapter_path[0] = '\0';
+
 	g_object_unref(telephony_dbus_info.manager_proxy);
 	telephony_dbus_info.manager_proxy = NULL;
 
@@ -331,8 +331,7 @@ Bluetooth event type
 		<td>If bonded device is locally removed, this event reported. This is broadcasting event. Removing is not sent to a unbonded peer device because it means removing locally stored key for the device.</td></tr>
 
 	<tr>		<td>BLUETOOTH_EVENT_BONDED_DEVICE_FOUND</td>
-		<td>Bonded device is reported with this event if you uses bluetooth_get_bonded_device_list() API. Only the API caller receives this event.</td></tr>
-@n (Not supported yet)
+		<td>Bonded device is reported with this event if you uses bluetooth_get_bonded_device_list_async() API. Only the API caller receives this event.</td></tr>
 
 	<tr>		<td>BLUETOOTH_EVENT_REMOTE_DEVICE_READ</td>
 		<td>Information directly getting from peer device is reported with this event if you uses bluetooth_get_remote_device() API.</td></tr>
@@ -349,6 +348,14 @@ Bluetooth event type
 @n Only the API caller receives this event.
 @n (Not supported yet)
 
+	<tr>		<td>BLUETOOTH_EVENT_BONDED_DEVICE_LIST_FINISHED</td>
+		<td>This event ends the enumeration started by bluetooth_get_bonded_device_list_async() API and carries the number of reported devices.</td></tr>
+@n Only the API caller receives this event.
+
+	<tr>		<td>BLUETOOTH_EVENT_REMOTE_DEVICE_LIST_UPDATED</td>
+		<td>When a report interval is set with bluetooth_set_discovery_report_interval() API, devices found or changed during discovery are delivered in batches with this event.</td></tr>
+@n This event is only reported while discovery is running.
+
 	<tr>		<td>BLUETOOTH_EVENT_SERVICE_SEARCHED</td>
 		<td>This event reports the result of bluetooth_search_service() API.</td></tr>
 @n Only the API caller receives this event.
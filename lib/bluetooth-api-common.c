@@ -68,8 +68,6 @@ void _bluetooth_internal_event_cb(int event, int result, void *param_data)
 
 bool _bluetooth_internal_is_adapter_enabled(void)
 {
-	GError *err = NULL;
-	const char *adapter_path = NULL;
 	bt_info_t *bt_internal_info = NULL;
 
 	bt_internal_info = _bluetooth_internal_get_information();
@@ -79,24 +77,31 @@ bool _bluetooth_internal_is_adapter_enabled(void)
 		return FALSE;
 	}
 
-	if (!dbus_g_proxy_call(bt_internal_info->manager_proxy, "DefaultAdapter", &err,
-				G_TYPE_INVALID, DBUS_TYPE_G_OBJECT_PATH, &adapter_path,
-				G_TYPE_INVALID)) {
-		if (err != NULL) {
-			DBG("DefaultAdapter err:[%s]", err->message);
-			g_error_free(err);
-		}
+	/* adapter_path is maintained by the AdapterAdded / AdapterRemoved /
+	   NameOwnerChanged handlers, so no DefaultAdapter round-trip is needed */
+	if (bt_internal_info->adapter_path[0] == '\0') {
+		DBG("adapter_path is NULL");
 		return FALSE;
 	}
 
-	if (adapter_path == NULL) {
-		DBG("adapter_path is NULL");
-		return FALSE;
+	return TRUE;
+}
+
+int _bluetooth_internal_get_cached_adapter_path(char *path)
+{
+	_bluetooth_internal_session_init();
+
+	if (path == NULL)
+		return BLUETOOTH_ERROR_INVALID_PARAM;
+
+	if (bt_info.adapter_path[0] == '\0') {
+		DBG("No default adapter\n");
+		return BLUETOOTH_ERROR_DEVICE_NOT_ENABLED;
 	}
 
-	DBG("adapter_path is %s", adapter_path);
+	g_strlcpy(path, bt_info.adapter_path, BT_ADAPTER_OBJECT_PATH_MAX);
 
-	return TRUE;
+	return BLUETOOTH_ERROR_NONE;
 }
 
 void bluetooth_internal_convert_uuid_num_to_string(const bluetooth_service_uuid_list_t uuid_num,
@@ -116,93 +121,33 @@ void bluetooth_internal_convert_uuid_num_to_string(const bluetooth_service_uuid_
 
 int _bluetooth_internal_get_adapter_path(DBusGConnection *conn, char *path)
 {
-	GError *err = NULL;
-	DBusGProxy *manager_proxy = NULL;
-	char *adapter_path = NULL;
-
 	DBG("+\n");
 
 	if (conn == NULL)
 		return BLUETOOTH_ERROR_INTERNAL;
 
-	manager_proxy = dbus_g_proxy_new_for_name(conn, BLUEZ_SERVICE_NAME,
-				BLUEZ_MANAGER_OBJ_PATH, BLUEZ_MANAGER_INTERFACE);
-
-	if (manager_proxy == NULL) {
-		DBG("Could not create a dbus proxy\n");
-		return BLUETOOTH_ERROR_INTERNAL;
-	}
-
-	if (!dbus_g_proxy_call(manager_proxy, "DefaultAdapter", &err,
-			       G_TYPE_INVALID, DBUS_TYPE_G_OBJECT_PATH, &adapter_path,
-				G_TYPE_INVALID)) {
-		if (err != NULL) {
-			DBG("Getting DefaultAdapter failed: [%s]\n", err->message);
-			g_error_free(err);
-		}
-		g_object_unref(manager_proxy);
-		return BLUETOOTH_ERROR_INTERNAL;
-	}
-
-	if (adapter_path == NULL || strlen(adapter_path) >= BT_ADAPTER_OBJECT_PATH_MAX) {
-		DBG("Adapter path is inproper\n");
-		g_object_unref(manager_proxy);
+	if (_bluetooth_internal_get_cached_adapter_path(path) < 0)
 		return BLUETOOTH_ERROR_INTERNAL;
-	}
-
-	strncpy(path, adapter_path, BT_ADAPTER_OBJECT_PATH_MAX);
-	DBG("path = %s\n", adapter_path);
 
-	g_object_unref(manager_proxy);
+	DBG("path = %s\n", path);
 
 	return BLUETOOTH_ERROR_NONE;
 }
 
 DBusGProxy *_bluetooth_internal_get_adapter_proxy(DBusGConnection *conn)
 {
-	GError *err = NULL;
-	DBusGProxy *manager_proxy = NULL;
-	DBusGProxy *adapter_proxy = NULL;
-	char *adapter_path = NULL;
+	char adapter_path[BT_ADAPTER_OBJECT_PATH_MAX] = { 0 };
 
 	DBG("+\n");
 
 	if (conn == NULL)
 		return NULL;
 
-	manager_proxy = dbus_g_proxy_new_for_name(conn, BLUEZ_SERVICE_NAME,
-				BLUEZ_MANAGER_OBJ_PATH, BLUEZ_MANAGER_INTERFACE);
-
-	if (manager_proxy == NULL) {
-		DBG("Could not create a dbus proxy\n");
+	if (_bluetooth_internal_get_cached_adapter_path(adapter_path) < 0)
 		return NULL;
-	}
 
-	if (!dbus_g_proxy_call(manager_proxy, "DefaultAdapter", &err,
-			       G_TYPE_INVALID, DBUS_TYPE_G_OBJECT_PATH, &adapter_path,
-				G_TYPE_INVALID)) {
-		if (err != NULL) {
-			DBG("Getting DefaultAdapter failed: [%s]\n", err->message);
-			g_error_free(err);
-		}
-		g_object_unref(manager_proxy);
-		return NULL;
-	}
-
-	if (adapter_path == NULL || strlen(adapter_path) >= BT_ADAPTER_OBJECT_PATH_MAX) {
-		DBG("Adapter path is inproper\n");
-		g_object_unref(manager_proxy);
-		return NULL;
-	}
-
-	adapter_proxy = dbus_g_proxy_new_for_name(conn,
-					BLUEZ_SERVICE_NAME,
-					adapter_path,
-					BLUEZ_ADAPTER_INTERFACE);
-
-	g_object_unref(manager_proxy);
-
-	return adapter_proxy;
+	return dbus_g_proxy_new_for_name(conn, BLUEZ_SERVICE_NAME,
+					adapter_path, BLUEZ_ADAPTER_INTERFACE);
 }
 
 
@@ -313,32 +258,170 @@ static int __bluetooth_internal_store_get_value(const char *key,
 	return ret;
 }
 
+static guint __bluetooth_internal_addr_hash(gconstpointer key)
+{
+	const unsigned char *addr = ((const bluetooth_device_address_t *)key)->addr;
+
+	/* The NAP/UAP bytes are mostly shared, the LAP carries the entropy */
+	return (addr[2] << 24) | (addr[3] << 16) | (addr[4] << 8) | addr[5];
+}
+
+static gboolean __bluetooth_internal_addr_equal(gconstpointer a, gconstpointer b)
+{
+	return memcmp(a, b, sizeof(bluetooth_device_address_t)) == 0;
+}
+
+bt_device_entry_t *_bluetooth_internal_get_device_entry(const char *dev_path)
+{
+	bt_device_entry_t *entry;
+
+	if (bt_info.device_path_hash == NULL || dev_path == NULL)
+		return NULL;
+
+	entry = g_hash_table_lookup(bt_info.device_path_hash, dev_path);
+
+	if (entry && entry->lru_link) {
+		g_queue_unlink(bt_info.device_lru, entry->lru_link);
+		g_queue_push_head_link(bt_info.device_lru, entry->lru_link);
+	}
+
+	return entry;
+}
+
 DBusGProxy *_bluetooth_internal_find_device_by_path(const char *dev_path)
 {
-	GList *list = bt_info.device_proxy_list;
-	DBusGProxy *device_proxy = NULL;
-	const char *proxy_path = NULL;
-	int list_length, i;
+	bt_device_entry_t *entry;
 
-	if (list == NULL || dev_path == NULL) {
+	entry = _bluetooth_internal_get_device_entry(dev_path);
+
+	return entry ? entry->proxy : NULL;
+}
+
+DBusGProxy *_bluetooth_internal_find_device_by_address(
+				const bluetooth_device_address_t *device_address)
+{
+	bt_device_entry_t *entry;
+
+	if (bt_info.device_addr_hash == NULL || device_address == NULL)
+		return NULL;
+
+	entry = g_hash_table_lookup(bt_info.device_addr_hash, device_address);
+	if (entry == NULL)
 		return NULL;
+
+	return _bluetooth_internal_find_device_by_path(entry->path);
+}
+
+void _bluetooth_internal_drop_device_properties(bt_device_entry_t *entry)
+{
+	if (entry == NULL)
+		return;
+
+	if (entry->lru_link) {
+		g_queue_delete_link(bt_info.device_lru, entry->lru_link);
+		entry->lru_link = NULL;
 	}
 
-	list_length = g_list_length(list);
+	if (entry->properties) {
+		g_hash_table_unref(entry->properties);
+		entry->properties = NULL;
+	}
+}
 
-	for (i = 0; i < list_length; i++) {
-		device_proxy = (DBusGProxy *) g_list_nth_data(list, i);
+void _bluetooth_internal_set_device_properties(bt_device_entry_t *entry,
+						GHashTable *properties)
+{
+	bt_device_entry_t *oldest;
 
-		if (device_proxy != NULL) {
-			proxy_path = dbus_g_proxy_get_path(device_proxy);
+	if (entry == NULL) {
+		if (properties)
+			g_hash_table_unref(properties);
+		return;
+	}
 
-			if (strcmp(proxy_path, dev_path) == 0) {
-				return device_proxy;
-			}
-		}
+	_bluetooth_internal_drop_device_properties(entry);
+
+	if (properties == NULL)
+		return;
+
+	entry->properties = properties;
+
+	g_queue_push_head(bt_info.device_lru, entry);
+	entry->lru_link = g_queue_peek_head_link(bt_info.device_lru);
+
+	/* Only the property cache is bounded; the proxy has to live as long as
+	   the bluez object to keep receiving its signals */
+	while (g_queue_get_length(bt_info.device_lru) > BT_DEVICE_PROPERTIES_CACHE_MAX) {
+		oldest = g_queue_peek_tail(bt_info.device_lru);
+		DBG("Evict cached properties [%s]", oldest->path);
+		_bluetooth_internal_drop_device_properties(oldest);
+	}
+}
+
+GHashTable *_bluetooth_internal_get_device_properties(const char *dev_path)
+{
+	bt_device_entry_t *entry;
+	GHashTable *hash = NULL;
+	GError *error = NULL;
+
+	if (dev_path == NULL)
+		return NULL;
+
+	entry = _bluetooth_internal_get_device_entry(dev_path);
+	if (entry == NULL) {
+		if (_bluetooth_internal_add_device(dev_path) == NULL)
+			return NULL;
+
+		entry = _bluetooth_internal_get_device_entry(dev_path);
+		if (entry == NULL)
+			return NULL;
+	}
+
+	if (entry->properties)
+		return g_hash_table_ref(entry->properties);
+
+	/* Filled once, then kept current by the PropertyChanged handler */
+	dbus_g_proxy_call(entry->proxy, "GetProperties", &error,
+			  G_TYPE_INVALID,
+			  dbus_g_type_get_map("GHashTable", G_TYPE_STRING, G_TYPE_VALUE),
+			  &hash, G_TYPE_INVALID);
+
+	if (error != NULL) {
+		ERR("GetProperties [%s] failed: %s", dev_path, error->message);
+		g_error_free(error);
+		return NULL;
 	}
 
-	return NULL;
+	_bluetooth_internal_set_device_properties(entry, hash);
+
+	if (entry->properties == NULL)
+		return NULL;
+
+	/* Eviction or removal of the device must not free it under the caller */
+	return g_hash_table_ref(entry->properties);
+}
+
+static void __bluetooth_internal_update_device_property(const char *dev_path,
+							const char *property,
+							const GValue *value)
+{
+	bt_device_entry_t *entry;
+	GValue *copy;
+
+	if (bt_info.device_path_hash == NULL || dev_path == NULL ||
+	    property == NULL || value == NULL)
+		return;
+
+	/* A signal is not a use, leave the LRU order untouched */
+	entry = g_hash_table_lookup(bt_info.device_path_hash, dev_path);
+	if (entry == NULL || entry->properties == NULL)
+		return;
+
+	copy = g_new0(GValue, 1);
+	g_value_init(copy, G_VALUE_TYPE(value));
+	g_value_copy(value, copy);
+
+	g_hash_table_replace(entry->properties, g_strdup(property), copy);
 }
 
 void _bluetooth_change_uuids_to_sdp_info(GValue *value, bt_sdp_info_t *sdp_data)
@@ -386,6 +469,8 @@ static void __bluetooth_internal_device_property_changed(DBusGProxy *device_prox
 
 	DBG("+ remote device[%s] property[%s]\n", dev_path, property);
 
+	__bluetooth_internal_update_device_property(dev_path, property, value);
+
 	if (g_strcmp0(property, "Paired") == 0) {
 		bt_info_t *bt_internal_info = NULL;
 		gboolean paired = g_value_get_boolean(value);
@@ -436,10 +521,7 @@ static void __bluetooth_internal_device_property_changed(DBusGProxy *device_prox
 		guint remote_class;
 		gboolean paired = FALSE;
 
-		dbus_g_proxy_call(device_proxy, "GetProperties", NULL,
-				  G_TYPE_INVALID,
-				  dbus_g_type_get_map("GHashTable", G_TYPE_STRING, G_TYPE_VALUE),
-				&hash, G_TYPE_INVALID);
+		hash = _bluetooth_internal_get_device_properties(dev_path);
 
 		if (hash != NULL) {
 			property_value = g_hash_table_lookup(hash, "Address");
@@ -453,6 +535,8 @@ static void __bluetooth_internal_device_property_changed(DBusGProxy *device_prox
 
 			_bluetooth_internal_remote_device_name_updated_cb(address,
 						name, 0, remote_class, paired);
+
+			g_hash_table_unref(hash);
 		}
 	} else if (g_strcmp0(property, "UUIDs") == 0) {
 		bt_sdp_info_t sdp_data;
@@ -512,21 +596,105 @@ static void __bluetooth_internal_remove_device_signal(DBusGProxy *device_proxy)
 					NULL);
 }
 
+static void __bluetooth_internal_device_entry_free(gpointer data)
+{
+	bt_device_entry_t *entry = data;
+
+	if (entry == NULL)
+		return;
+
+	_bluetooth_internal_drop_device_properties(entry);
+
+	__bluetooth_internal_remove_device_signal(entry->proxy);
+	g_object_unref(entry->proxy);
+
+	g_free(entry->path);
+	g_free(entry);
+}
+
+static void __bluetooth_internal_device_registry_init(void)
+{
+	if (bt_info.device_path_hash)
+		return;
+
+	/* The path table owns the entries, the address table only indexes them */
+	bt_info.device_path_hash = g_hash_table_new_full(g_str_hash, g_str_equal,
+					NULL, __bluetooth_internal_device_entry_free);
+	bt_info.device_addr_hash = g_hash_table_new(__bluetooth_internal_addr_hash,
+					__bluetooth_internal_addr_equal);
+	bt_info.device_lru = g_queue_new();
+}
+
+static void __bluetooth_internal_device_registry_clear(void)
+{
+	if (bt_info.device_path_hash == NULL)
+		return;
+
+	g_hash_table_destroy(bt_info.device_addr_hash);
+	bt_info.device_addr_hash = NULL;
+
+	g_hash_table_destroy(bt_info.device_path_hash);
+	bt_info.device_path_hash = NULL;
+
+	g_queue_free(bt_info.device_lru);
+	bt_info.device_lru = NULL;
+}
+
 DBusGProxy *_bluetooth_internal_add_device(const char *path)
 {
 	DBusGProxy *device_proxy = NULL;
+	bt_device_entry_t *entry;
+	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
+
+	if (path == NULL)
+		return NULL;
+
+	__bluetooth_internal_device_registry_init();
+
+	entry = g_hash_table_lookup(bt_info.device_path_hash, path);
+	if (entry)
+		return entry->proxy;
 
 	device_proxy = dbus_g_proxy_new_for_name(bt_info.conn, BLUEZ_SERVICE_NAME,
 						path, BLUEZ_DEVICE_INTERFACE);
-	if (device_proxy) {
-		bt_info.device_proxy_list = g_list_append(bt_info.device_proxy_list,
-								device_proxy);
-		__bluetooth_internal_add_device_signal(device_proxy);
-	}
+	if (device_proxy == NULL)
+		return NULL;
+
+	entry = g_new0(bt_device_entry_t, 1);
+	entry->path = g_strdup(path);
+	entry->proxy = device_proxy;
+
+	_bluetooth_internal_device_path_to_address(path, address);
+	_bluetooth_internal_convert_addr_string_to_addr_type(&entry->addr, address);
+
+	g_hash_table_insert(bt_info.device_path_hash, entry->path, entry);
+	/* The key lives inside the entry, so it must be swapped with the value:
+	 * g_hash_table_insert() would keep the key of a previous entry for the
+	 * same address, which is freed when that entry leaves the path table */
+	g_hash_table_replace(bt_info.device_addr_hash, &entry->addr, entry);
+
+	__bluetooth_internal_add_device_signal(device_proxy);
 
 	return device_proxy;
 }
 
+void _bluetooth_internal_remove_device(const char *path)
+{
+	bt_device_entry_t *entry;
+
+	if (bt_info.device_path_hash == NULL || path == NULL)
+		return;
+
+	entry = g_hash_table_lookup(bt_info.device_path_hash, path);
+	if (entry == NULL)
+		return;
+
+	if (g_hash_table_lookup(bt_info.device_addr_hash, &entry->addr) == entry)
+		g_hash_table_remove(bt_info.device_addr_hash, &entry->addr);
+
+	g_hash_table_remove(bt_info.device_path_hash, path);
+}
+
 static void __bluetooth_internal_device_created(DBusGProxy *adapter,
 					const char *path, gpointer user_data)
 {
@@ -589,10 +757,7 @@ static void __bluetooth_internal_device_removed(DBusGProxy *adapter,
 
 		_bluetooth_internal_bonding_removed_cb(address, (gpointer) device_proxy);
 
-		__bluetooth_internal_remove_device_signal(device_proxy);
-		bt_info.device_proxy_list = g_list_remove(bt_info.device_proxy_list,
-							device_proxy);
-		g_object_unref(device_proxy);
+		_bluetooth_internal_remove_device(path);
 		device_proxy = NULL;
 	}
 
@@ -748,14 +913,12 @@ static void __bluetooth_internal_remote_device_found(DBusGProxy *adapter,
 	const gchar *name;
 	guint remote_class;
 	gint rssi;
-	gboolean is_name_include = FALSE;
 	gboolean paired = FALSE;
 
 	DBG("+ address[%s]", address);
 
 	if (hash != NULL) {
 		value = g_hash_table_lookup(hash, "Name");
-		is_name_include = value ? TRUE : FALSE;
 		name = value ? g_value_get_string(value) : NULL;
 
 		value = g_hash_table_lookup(hash, "Class");
@@ -767,18 +930,9 @@ static void __bluetooth_internal_remote_device_found(DBusGProxy *adapter,
 		value = g_hash_table_lookup(hash, "Paired");
 		paired = value ? g_value_get_boolean(value) : FALSE;
 
-		if (is_name_include) {
-			_bluetooth_internal_remote_device_name_updated_cb(address,
-									name,
-									rssi,
-									remote_class,
-									paired);
-		} else {
-			_bluetooth_internal_remote_device_found_cb(address,
-								rssi,
-								remote_class,
-								paired);
-		}
+		/* Merged per address by the discovery aggregator */
+		_bluetooth_internal_remote_device_found_cb(address, name, rssi,
+							remote_class, paired);
 	}
 
 	DBG("-");
@@ -899,21 +1053,7 @@ static int __bluetooth_internal_remove_signal(void)
 
 	_bluetooth_network_client_remove_filter();
 
-	if (bt_info.device_proxy_list != NULL) {
-		int i, list_length = 0;
-		DBusGProxy *device_proxy = NULL;
-
-		list_length = g_list_length(bt_info.device_proxy_list);
-
-		for (i = 0; i < list_length; i++) {
-			device_proxy = g_list_nth_data(bt_info.device_proxy_list, i);
-			__bluetooth_internal_remove_device_signal(device_proxy);
-			g_object_unref(device_proxy);
-			device_proxy = NULL;
-		}
-		g_list_free(bt_info.device_proxy_list);
-		bt_info.device_proxy_list = NULL;
-	}
+	__bluetooth_internal_device_registry_clear();
 
 	g_object_unref(bt_info.adapter_proxy);
 	bt_info.adapter_proxy = NULL;
@@ -1009,6 +1149,8 @@ static void __bluetooth_internal_adapter_removed_cb(DBusGProxy *manager_proxy,
 
 	if (strstr(adapter_path, "hci0")) {
 		__bluetooth_internal_remove_signal();
+		if (g_strcmp0(bt_info.adapter_path, adapter_path) == 0)
+			bt_info.adapter_path[0] = '\0';
 	} else {
 		DBG("path is not include hci0");
 	}
@@ -1025,6 +1167,7 @@ static void __bluetooth_internal_name_owner_changed(DBusGProxy *dbus_proxy, cons
 	if (g_strcmp0(name, BLUEZ_SERVICE_NAME) == 0 && *new == '\0') {
 		DBG("BlueZ is terminated");
 		bt_info.bt_adapter_state = BLUETOOTH_ADAPTER_DISABLED;
+		bt_info.adapter_path[0] = '\0';
 
 		DBG("Send event to application");
 		_bluetooth_internal_disabled_cb();
@@ -1118,6 +1261,346 @@ int _bluetooth_get_default_adapter_name(bluetooth_device_name_t *dev_name, int s
 	return BLUETOOTH_ERROR_NONE;
 }
 
+/* Shared system bus signal dispatcher */
+#define BT_SIGNAL_KEY_MAX (DBUS_MAXIMUM_NAME_LENGTH * 2 + 2)
+#define BT_SIGNAL_ANY_MEMBER "*"
+
+typedef struct {
+	char *rule;			/**< Match rule registered on the bus */
+	char *path_prefix;		/**< Object path filter, NULL for any */
+	bt_signal_handler_t handler;
+	void *user_data;
+	gboolean is_removed;		/**< Removed while a dispatch was running */
+	guint serial;			/**< Dispatch serial current when added */
+} bt_signal_subscriber_t;
+
+typedef struct {
+	DBusGConnection *conn;
+	DBusConnection *sys_conn;
+	GHashTable *handlers;		/**< "interface member" -> GSList of subscribers */
+	GHashTable *rules;		/**< match rule -> reference count */
+	guint dispatch_depth;
+	guint serial;			/**< Bumped for every dispatched signal */
+	gboolean need_purge;
+} bt_signal_dispatcher_t;
+
+static bt_signal_dispatcher_t bt_signal_dispatcher;
+
+static void __bluetooth_internal_signal_key(char *key, const char *interface,
+						const char *member)
+{
+	snprintf(key, BT_SIGNAL_KEY_MAX, "%s %s", interface,
+			member ? member : BT_SIGNAL_ANY_MEMBER);
+}
+
+static void __bluetooth_internal_signal_dispatch(const char *key,
+						guint serial,
+						DBusConnection *conn,
+						DBusMessage *msg,
+						const char *path)
+{
+	GSList *l;
+	bt_signal_subscriber_t *sub;
+
+	l = g_hash_table_lookup(bt_signal_dispatcher.handlers, key);
+
+	for (; l != NULL; l = g_slist_next(l)) {
+		sub = l->data;
+
+		/* Added by a handler of this very signal */
+		if (sub->is_removed || sub->serial >= serial)
+			continue;
+
+		if (sub->path_prefix &&
+		    (path == NULL || !g_str_has_prefix(path, sub->path_prefix)))
+			continue;
+
+		sub->handler(conn, msg, sub->user_data);
+	}
+}
+
+static void __bluetooth_internal_signal_subscriber_free(bt_signal_subscriber_t *sub)
+{
+	g_free(sub->rule);
+	g_free(sub->path_prefix);
+	g_free(sub);
+}
+
+static gboolean __bluetooth_internal_signal_purge_bucket(gpointer key, GSList *list)
+{
+	GSList *l = list;
+	bt_signal_subscriber_t *sub;
+
+	while (l != NULL) {
+		sub = l->data;
+		l = g_slist_next(l);
+
+		if (sub->is_removed) {
+			list = g_slist_remove(list, sub);
+			__bluetooth_internal_signal_subscriber_free(sub);
+		}
+	}
+
+	if (list == NULL)
+		return TRUE;
+
+	/* The head may have changed, store it back without freeing the key */
+	g_hash_table_steal(bt_signal_dispatcher.handlers, key);
+	g_hash_table_insert(bt_signal_dispatcher.handlers, key, list);
+
+	return FALSE;
+}
+
+static DBusHandlerResult __bluetooth_internal_signal_filter(DBusConnection *conn,
+							DBusMessage *msg, void *data);
+
+static void __bluetooth_internal_signal_dispatcher_deinit(void)
+{
+	if (bt_signal_dispatcher.sys_conn)
+		dbus_connection_remove_filter(bt_signal_dispatcher.sys_conn,
+					__bluetooth_internal_signal_filter, NULL);
+
+	if (bt_signal_dispatcher.handlers)
+		g_hash_table_destroy(bt_signal_dispatcher.handlers);
+
+	if (bt_signal_dispatcher.rules)
+		g_hash_table_destroy(bt_signal_dispatcher.rules);
+
+	if (bt_signal_dispatcher.conn)
+		dbus_g_connection_unref(bt_signal_dispatcher.conn);
+
+	memset(&bt_signal_dispatcher, 0x00, sizeof(bt_signal_dispatcher));
+}
+
+static void __bluetooth_internal_signal_purge(void)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	GSList *pending = NULL;
+	GSList *l;
+
+	bt_signal_dispatcher.need_purge = FALSE;
+
+	/* Collect the keys first, purging may re-insert bucket heads */
+	g_hash_table_iter_init(&iter, bt_signal_dispatcher.handlers);
+	while (g_hash_table_iter_next(&iter, &key, &value))
+		pending = g_slist_prepend(pending, key);
+
+	for (l = pending; l != NULL; l = g_slist_next(l)) {
+		value = g_hash_table_lookup(bt_signal_dispatcher.handlers, l->data);
+		if (__bluetooth_internal_signal_purge_bucket(l->data, value))
+			g_hash_table_remove(bt_signal_dispatcher.handlers, l->data);
+	}
+
+	g_slist_free(pending);
+
+	if (g_hash_table_size(bt_signal_dispatcher.handlers) == 0)
+		__bluetooth_internal_signal_dispatcher_deinit();
+}
+
+static DBusHandlerResult __bluetooth_internal_signal_filter(DBusConnection *conn,
+							DBusMessage *msg, void *data)
+{
+	char key[BT_SIGNAL_KEY_MAX];
+	const char *interface;
+	const char *member;
+	const char *path;
+	guint serial;
+
+	if (dbus_message_get_type(msg) != DBUS_MESSAGE_TYPE_SIGNAL)
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+	if (bt_signal_dispatcher.handlers == NULL)
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+	interface = dbus_message_get_interface(msg);
+	member = dbus_message_get_member(msg);
+	path = dbus_message_get_path(msg);
+
+	if (interface == NULL || member == NULL)
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+	bt_signal_dispatcher.dispatch_depth++;
+	serial = ++bt_signal_dispatcher.serial;
+
+	__bluetooth_internal_signal_key(key, interface, member);
+	__bluetooth_internal_signal_dispatch(key, serial, conn, msg, path);
+
+	__bluetooth_internal_signal_key(key, interface, NULL);
+	__bluetooth_internal_signal_dispatch(key, serial, conn, msg, path);
+
+	bt_signal_dispatcher.dispatch_depth--;
+
+	if (bt_signal_dispatcher.dispatch_depth == 0 && bt_signal_dispatcher.need_purge)
+		__bluetooth_internal_signal_purge();
+
+	/* Signals are broadcast, let dbus-glib proxies and others see it too */
+	return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+}
+
+static int __bluetooth_internal_signal_dispatcher_init(void)
+{
+	GError *err = NULL;
+
+	if (bt_signal_dispatcher.sys_conn)
+		return BLUETOOTH_ERROR_NONE;
+
+	bt_signal_dispatcher.conn = dbus_g_bus_get(DBUS_BUS_SYSTEM, &err);
+	if (!bt_signal_dispatcher.conn) {
+		ERR("Can't get on system bus [%s]", err ? err->message : "");
+		if (err)
+			g_error_free(err);
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	bt_signal_dispatcher.sys_conn =
+		dbus_g_connection_get_connection(bt_signal_dispatcher.conn);
+
+	bt_signal_dispatcher.handlers = g_hash_table_new_full(g_str_hash, g_str_equal,
+								g_free, NULL);
+	bt_signal_dispatcher.rules = g_hash_table_new_full(g_str_hash, g_str_equal,
+								g_free, NULL);
+
+	dbus_connection_add_filter(bt_signal_dispatcher.sys_conn,
+				__bluetooth_internal_signal_filter, NULL, NULL);
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+static int __bluetooth_internal_signal_rule_ref(const char *rule)
+{
+	DBusError dbus_error;
+	guint count;
+
+	count = GPOINTER_TO_UINT(g_hash_table_lookup(bt_signal_dispatcher.rules, rule));
+	if (count == 0) {
+		dbus_error_init(&dbus_error);
+		dbus_bus_add_match(bt_signal_dispatcher.sys_conn, rule, &dbus_error);
+		if (dbus_error_is_set(&dbus_error)) {
+			ERR("Fail to add match [%s]: %s", rule, dbus_error.message);
+			dbus_error_free(&dbus_error);
+			return BLUETOOTH_ERROR_INTERNAL;
+		}
+	}
+
+	g_hash_table_insert(bt_signal_dispatcher.rules, g_strdup(rule),
+				GUINT_TO_POINTER(count + 1));
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+static void __bluetooth_internal_signal_rule_unref(const char *rule)
+{
+	guint count;
+
+	count = GPOINTER_TO_UINT(g_hash_table_lookup(bt_signal_dispatcher.rules, rule));
+	if (count > 1) {
+		g_hash_table_insert(bt_signal_dispatcher.rules, g_strdup(rule),
+					GUINT_TO_POINTER(count - 1));
+		return;
+	}
+
+	g_hash_table_remove(bt_signal_dispatcher.rules, rule);
+
+	/* No reply is needed, so this does not block */
+	dbus_bus_remove_match(bt_signal_dispatcher.sys_conn, rule, NULL);
+}
+
+int _bluetooth_internal_add_signal_handler(const char *interface,
+					const char *member,
+					const char *path_prefix,
+					bt_signal_handler_t handler,
+					void *user_data)
+{
+	char key[BT_SIGNAL_KEY_MAX];
+	bt_signal_subscriber_t *sub;
+	GSList *list;
+
+	if (interface == NULL || handler == NULL)
+		return BLUETOOTH_ERROR_INVALID_PARAM;
+
+	if (__bluetooth_internal_signal_dispatcher_init() < 0)
+		return BLUETOOTH_ERROR_INTERNAL;
+
+	sub = g_new0(bt_signal_subscriber_t, 1);
+	if (member)
+		sub->rule = g_strdup_printf("type='signal',interface='%s',member='%s'",
+						interface, member);
+	else
+		sub->rule = g_strdup_printf("type='signal',interface='%s'", interface);
+	sub->path_prefix = g_strdup(path_prefix);
+	sub->handler = handler;
+	sub->user_data = user_data;
+	sub->serial = bt_signal_dispatcher.serial;
+
+	if (__bluetooth_internal_signal_rule_ref(sub->rule) < 0) {
+		__bluetooth_internal_signal_subscriber_free(sub);
+		if (g_hash_table_size(bt_signal_dispatcher.handlers) == 0)
+			__bluetooth_internal_signal_dispatcher_deinit();
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	__bluetooth_internal_signal_key(key, interface, member);
+
+	/* Appended to the bucket a dispatch may be walking; the serial keeps
+	   it from being called for the signal being dispatched */
+	list = g_hash_table_lookup(bt_signal_dispatcher.handlers, key);
+	if (list == NULL)
+		g_hash_table_insert(bt_signal_dispatcher.handlers, g_strdup(key),
+					g_slist_append(NULL, sub));
+	else
+		g_slist_append(list, sub);
+
+	DBG("Signal handler added [%s]", key);
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+void _bluetooth_internal_remove_signal_handler(const char *interface,
+					const char *member,
+					bt_signal_handler_t handler,
+					void *user_data)
+{
+	char key[BT_SIGNAL_KEY_MAX];
+	bt_signal_subscriber_t *sub = NULL;
+	GSList *list;
+	GSList *l;
+
+	if (interface == NULL || bt_signal_dispatcher.handlers == NULL)
+		return;
+
+	__bluetooth_internal_signal_key(key, interface, member);
+
+	list = g_hash_table_lookup(bt_signal_dispatcher.handlers, key);
+
+	for (l = list; l != NULL; l = g_slist_next(l)) {
+		bt_signal_subscriber_t *tmp = l->data;
+
+		if (!tmp->is_removed && tmp->handler == handler &&
+		    tmp->user_data == user_data) {
+			sub = tmp;
+			break;
+		}
+	}
+
+	if (sub == NULL) {
+		DBG("No signal handler [%s]", key);
+		return;
+	}
+
+	__bluetooth_internal_signal_rule_unref(sub->rule);
+
+	DBG("Signal handler removed [%s]", key);
+
+	/* Freeing is deferred while a dispatch may still walk the bucket */
+	sub->is_removed = TRUE;
+	bt_signal_dispatcher.need_purge = TRUE;
+
+	if (bt_signal_dispatcher.dispatch_depth == 0)
+		__bluetooth_internal_signal_purge();
+}
+
 void _bluetooth_internal_session_init(void)
 {
 	GError *err = NULL;
@@ -41,6 +41,7 @@
 #include <vconf-keys.h>
 
 #include "bluetooth-api.h"
+#include "bluetooth-api-signal.h"
 
 #define BT_FRWK	"BT_FRWK"
 
@@ -80,6 +81,7 @@
 #define BT_128_UUID_LEN 36
 #define BT_ADAPTER_OBJECT_PATH_MAX 50
 #define BT_DISCOVERY_FINISHED_DELAY 200
+#define BT_DEVICE_PROPERTIES_CACHE_MAX 64
 
 #define RFKILL_NODE "/dev/rfkill"
 
@@ -153,6 +155,20 @@ typedef struct {
 	int success_search_index;
 } bt_info_for_searching_support_service_t;
 
+/**
+ *   @internal
+ *   Registry entry for a bluez device object
+ */
+typedef struct {
+	char *path;				/**< bluez device object path */
+	bluetooth_device_address_t addr;	/**< Device address parsed from the path */
+	DBusGProxy *proxy;			/**< bluez device ipc proxy */
+	GHashTable *properties;			/**< Cached device properties, NULL if
+							not cached */
+	GList *lru_link;			/**< Link in bt_info.device_lru while
+							properties are cached */
+} bt_device_entry_t;
+
 /**
  *   @internal
  *   This structure has information about BT
@@ -171,9 +187,14 @@ typedef struct {
 	DBusGProxy *agent_proxy;		/**< Agent ipc proxy */
 	DBusGProxy *network_server_proxy;
 	DBusGProxy *rfcomm_proxy;
-	char adapter_path[BT_ADAPTER_OBJECT_PATH_MAX];	/*bluez adapter path*/
+	char adapter_path[BT_ADAPTER_OBJECT_PATH_MAX];	/**< Cached bluez adapter path, empty
+							when no adapter. Updated only by the
+							Manager / NameOwnerChanged signals */
 	char *connecting_uuid;
-	GList *device_proxy_list;			/**< bluez device ipc proxy list */
+	GHashTable *device_path_hash;		/**< object path -> bt_device_entry_t */
+	GHashTable *device_addr_hash;		/**< device address -> bt_device_entry_t */
+	GQueue *device_lru;			/**< Entries holding cached properties,
+							most recently used first */
 
 	bluetooth_adapter_state_t bt_adapter_state;	/*Current bluetooth state*/
 	guint bt_change_state_timer;			/**< g_timeout for checking timeout
@@ -210,7 +231,19 @@ void _bluetooth_internal_session_init(void);
 bool _bluetooth_internal_is_adapter_enabled(void);
 
 DBusGProxy *_bluetooth_internal_find_device_by_path(const char *dev_path);
+DBusGProxy *_bluetooth_internal_find_device_by_address(
+				const bluetooth_device_address_t *device_address);
 DBusGProxy *_bluetooth_internal_add_device(const char *path);
+void _bluetooth_internal_remove_device(const char *path);
+
+bt_device_entry_t *_bluetooth_internal_get_device_entry(const char *dev_path);
+void _bluetooth_internal_set_device_properties(bt_device_entry_t *entry,
+						GHashTable *properties);
+void _bluetooth_internal_drop_device_properties(bt_device_entry_t *entry);
+
+/* Returns a reference to the cached property table of a device,
+   release it with g_hash_table_unref() */
+GHashTable *_bluetooth_internal_get_device_properties(const char *dev_path);
 
 void _bluetooth_change_uuids_to_sdp_info(GValue *value, bt_sdp_info_t *sdp_data);
 
@@ -226,6 +259,8 @@ void _bluetooth_internal_device_path_to_address(const char *device_path,
 
 int _bluetooth_get_default_adapter_name(bluetooth_device_name_t *dev_name, int size);
 
+int _bluetooth_internal_get_cached_adapter_path(char *path);
+
 int _bluetooth_internal_get_adapter_path(DBusGConnection *conn, char *path);
 
 DBusGProxy *_bluetooth_internal_get_adapter_proxy(DBusGConnection *conn);
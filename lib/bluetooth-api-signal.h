@@ -0,0 +1,68 @@
+/*
+ * Bluetooth-frwk
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact:  Hocheol Seo <hocheol.seo@samsung.com>
+ *		 Girishashok Joshi <girish.joshi@samsung.com>
+ *		 Chanyeol Park <chanyeol.park@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef _BLUETOOTH_API_SIGNAL_H_
+#define _BLUETOOTH_API_SIGNAL_H_
+
+#include <dbus/dbus.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif				/* __cplusplus */
+
+/**
+ *   @internal
+ *   Handler invoked by the shared system bus signal dispatcher. The return
+ *   value is ignored; every subscriber of a signal is always called.
+ */
+typedef DBusHandlerResult (*bt_signal_handler_t)(DBusConnection *conn,
+						DBusMessage *msg, void *user_data);
+
+/**
+ *   @internal
+ *   Subscribe to a system bus signal through the single filter owned by the
+ *   library. member may be NULL to receive every signal of the interface and
+ *   path_prefix may be NULL to accept any object path. The match rule is
+ *   added on the bus once and shared by all subscribers.
+ */
+int _bluetooth_internal_add_signal_handler(const char *interface,
+					const char *member,
+					const char *path_prefix,
+					bt_signal_handler_t handler,
+					void *user_data);
+
+/**
+ *   @internal
+ *   Drop a subscription added by _bluetooth_internal_add_signal_handler().
+ *   It is safe to call from inside a handler.
+ */
+void _bluetooth_internal_remove_signal_handler(const char *interface,
+					const char *member,
+					bt_signal_handler_t handler,
+					void *user_data);
+
+#ifdef __cplusplus
+}
+#endif				/* __cplusplus */
+#endif				/*_BLUETOOTH_API_SIGNAL_H_*/
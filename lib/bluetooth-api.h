@@ -229,6 +229,10 @@ typedef enum {
 	BLUETOOTH_EVENT_REMOTE_DEVICE_READ,	    /**< Bluetooth event read remote device */
 	BLUETOOTH_EVENT_DEVICE_AUTHORIZED,	    /**< Bluetooth event authorize device */
 	BLUETOOTH_EVENT_DEVICE_UNAUTHORIZED,	    /**< Bluetooth event unauthorize device */
+	BLUETOOTH_EVENT_BONDED_DEVICE_LIST_FINISHED,
+					/**< Bluetooth event asynchronous bonded list completed */
+	BLUETOOTH_EVENT_REMOTE_DEVICE_LIST_UPDATED,
+					/**< Bluetooth event batch of discovered devices */
 
 	BLUETOOTH_EVENT_SERVICE_SEARCHED = BLUETOOTH_EVENT_SDP_BASE,
 						    /**< Bluetooth event serice search base id */
@@ -242,6 +246,9 @@ typedef enum {
 
 	BLUETOOTH_EVENT_DEVICE_CONNECTED,	    /**< Bluetooth event device connected */
 	BLUETOOTH_EVENT_DEVICE_DISCONNECTED,	    /**< Bluetooth event device disconnected */
+	BLUETOOTH_EVENT_RFCOMM_DATA_SENT,	    /**< Rfcomm asynchronous write completed */
+	BLUETOOTH_EVENT_RFCOMM_DATA_RECEIVED_BUFFERS,
+						    /**< RFCOMM data received in the application buffers */
 
 	BLUETOOTH_EVENT_NETWORK_SERVER_ACTIVATED = BLUETOOTH_EVENT_NETWORK_BASE,
 								/**< Bluetooth Network event */
@@ -542,6 +549,15 @@ typedef struct {
 	gboolean trust;		/**< connected flag */
 } bluetooth_device_info_t;
 
+/**
+* structure to hold a batch of discovered devices
+*/
+typedef struct {
+	int count;				/**< number of entries in devices */
+	bluetooth_device_info_t *devices;	/**< devices added or changed since the
+							previous batch */
+} bluetooth_discovered_devices_t;
+
 /**
  * structure to hold the paired device information
  */
@@ -603,6 +619,40 @@ typedef struct {
 		/**< the receive data buffer */
 } bluetooth_rfcomm_received_data_t;
 
+/**
+ * Stucture to rfcomm receive buffer
+ */
+
+typedef struct {
+	char *buffer;
+		/**< the data buffer */
+	int buffer_size;/**< the length of the buffer, or of the received data in events */
+} bluetooth_rfcomm_buffer_t;
+
+/**
+ * Stucture to rfcomm data received in the application buffers
+ */
+
+typedef struct {
+	int socket_fd;
+		/**< the socket fd */
+	int total_size;/**< the length of the received data */
+	int buffer_count;/**< the number of filled buffers */
+	bluetooth_rfcomm_buffer_t *buffers;
+		/**< the filled buffers in receive order */
+} bluetooth_rfcomm_received_buffers_t;
+
+/**
+ * Stucture to rfcomm asynchronous write completion
+ */
+
+typedef struct {
+	int socket_fd;
+		/**< the socket fd */
+	int buffer_size;/**< the length of the completed write requests */
+	int pending_size;/**< the length of the data still queued on the socket */
+} bluetooth_rfcomm_sent_data_t;
+
 /**
 * Stucture to rfcomm connection
 */
@@ -1437,6 +1487,52 @@ ret = bluetooth_is_discovering ();
  */
 int bluetooth_is_discovering(void);
 
+/**
+ * @fn int bluetooth_set_discovery_report_interval(unsigned int interval)
+ * @brief Set how discovery results are delivered
+ *
+ *
+ * Inquiry results are always merged per device address, and results which do not match the
+ * classOfDeviceMask of bluetooth_start_discovery() are dropped. A result is only reported when
+ * the device is new, its name, class or paired state changed, or its RSSI moved noticeably.
+ *
+ * With an interval of 0 (default) every such result is reported at once with
+ * BLUETOOTH_EVENT_REMOTE_DEVICE_FOUND or BLUETOOTH_EVENT_REMOTE_DEVICE_NAME_UPDATED.
+ * Otherwise the changed devices are collected and delivered at most once per interval with a
+ * single BLUETOOTH_EVENT_REMOTE_DEVICE_LIST_UPDATED event, whose param_data is a
+ * bluetooth_discovered_devices_t valid only during the callback. A pending batch is always
+ * delivered before BLUETOOTH_EVENT_DISCOVERY_FINISHED.
+ *
+ * This function is a synchronous call.
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Success \n
+ * @param[in]   interval	Batch cadence in milliseconds, 0 to report immediately
+ * @remark      None
+ * @see		bluetooth_start_discovery, bluetooth_get_discovered_devices
+ */
+int bluetooth_set_discovery_report_interval(unsigned int interval);
+
+/**
+ * @fn int bluetooth_get_discovered_devices(bluetooth_device_info_t **dev_array, int *count)
+ * @brief Get the devices found by the current or last discovery
+ *
+ *
+ * This API returns a copy of every device merged so far, in the order they were found. The
+ * list is reset when a new discovery starts.
+ *
+ * This function is a synchronous call.
+ * On BLUETOOTH_ERROR_NONE, dev_array holds count entries and must be released with
+ * g_free(). When nothing was found, dev_array is NULL and count is 0.
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Success \n
+ *		BLUETOOTH_ERROR_INVALID_PARAM - Invalid parameter \n
+ * @param[out]  dev_array	Array of discovered device information
+ * @param[out]  count		Number of entries in dev_array
+ * @remark      None
+ * @see		bluetooth_start_discovery, bluetooth_set_discovery_report_interval
+ */
+int bluetooth_get_discovered_devices(bluetooth_device_info_t **dev_array, int *count);
+
 /**
  * @fn int bluetooth_bond_device(const bluetooth_device_address_t *device_address)
  * @brief Initiate a bonding process
@@ -1687,6 +1783,65 @@ void bt_get_bonded_devices(void)
  */
 int bluetooth_get_bonded_device_list(GPtrArray **dev_list);
 
+/**
+ * @fn int bluetooth_get_bonded_device_array(bluetooth_device_info_t **dev_array, int *count)
+ * @brief Get bonded(paired) devices as one contiguous array
+ *
+ *
+ * This API gets all bonded devices with a single ListDevices request. Devices whose
+ * properties are already cached are answered from memory, the remaining ones are fetched
+ * with all their requests in flight at once. Devices which can not be read are skipped
+ * instead of failing the whole list.
+ *
+ * This function is a synchronous call.
+ * On BLUETOOTH_ERROR_NONE, dev_array holds count entries and must be released with
+ * g_free(). When there is no bonded device, dev_array is NULL and count is 0.
+ *
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Success \n
+ *		BLUETOOTH_ERROR_INVALID_PARAM - Invalid parameter \n
+ *		BLUETOOTH_ERROR_DEVICE_NOT_ENABLED - Adapter is not enabled \n
+ *		BLUETOOTH_ERROR_INTERNAL - ListDevices failed \n
+ * @param[out]  dev_array	Array of bonded device information
+ * @param[out]  count		Number of entries in dev_array
+ * @remark      None
+ * @see		bluetooth_get_bonded_device_list, bluetooth_get_bonded_device_list_async
+ @code
+bluetooth_device_info_t *devices = NULL;
+int count = 0;
+int i;
+
+if (bluetooth_get_bonded_device_array(&devices, &count) == BLUETOOTH_ERROR_NONE) {
+	for (i = 0; i < count; i++)
+		printf("Name [%s]\n", devices[i].device_name.name);
+	g_free(devices);
+}
+ @endcode
+ */
+int bluetooth_get_bonded_device_array(bluetooth_device_info_t **dev_array, int *count);
+
+/**
+ * @fn int bluetooth_get_bonded_device_list_async(void)
+ * @brief Enumerate bonded(paired) devices asynchronously
+ *
+ *
+ * This API enumerates the bonded devices without blocking the caller. Each device is
+ * reported with a BLUETOOTH_EVENT_BONDED_DEVICE_FOUND event as soon as its properties
+ * are known; param_data is a bluetooth_device_info_t valid only during the callback.
+ * The enumeration ends with BLUETOOTH_EVENT_BONDED_DEVICE_LIST_FINISHED whose param_data
+ * is an int holding the number of reported devices.
+ *
+ * This function is an asynchronous call.
+ *
+ *
+ * @return	BLUETOOTH_ERROR_NONE - Success \n
+ *		BLUETOOTH_ERROR_DEVICE_NOT_ENABLED - Adapter is not enabled \n
+ *		BLUETOOTH_ERROR_INTERNAL - Request could not be sent \n
+ * @remark      None
+ * @see		bluetooth_get_bonded_device_array
+ */
+int bluetooth_get_bonded_device_list_async(void);
+
 /**
  * @fn int bluetooth_get_bonded_device(const bluetooth_device_address_t *device_address,
  *					bluetooth_device_info_t *dev_info)
@@ -1916,7 +2071,6 @@ int bluetooth_cancel_service_search(void);
  * @return  socket FD on Success \n
  *              BLUETOOTH_ERROR_DEVICE_NOT_ENABLED - Device is not enabled \n
  *              BLUETOOTH_ERROR_INTERNAL - Internal error\n
- *              BLUETOOTH_ERROR_MAX_CONNECTION - Maximum connection reached\n
  *              BLUETOOTH_ERROR_INVALID_PARAM - Invalid parameter \n
  * @param[in]   UUID (128 bits)
  *
@@ -2277,10 +2431,13 @@ int bluetooth_rfcomm_disconnect(int socket_fd);
  *
  *
  * This API is used to send the data over the rfcomm connection. This is a synchronous API. The same
- * API is used to send the data for server and the client.
+ * API is used to send the data for server and the client. If the socket cannot take all the data
+ * at once, or data queued by bluetooth_rfcomm_write_async is still pending, the remainder is
+ * appended to the transmit queue of the socket.
  *
  * @return  BLUETOOTH_ERROR_NONE  - Success \n
  *              BLUETOOTH_ERROR_INVALID_PARAM - Invalid parameter \n
+ *              BLUETOOTH_ERROR_DEVICE_BUSY - The queue is above the high-water mark \n
  *              BLUETOOTH_ERROR_NOT_IN_OPERATION - The Fd is currently not in operation\n
  * @param[in]  int fd
  * @param[in]  const char *buff  Data buffer to send
@@ -2301,6 +2458,122 @@ int bluetooth_rfcomm_disconnect(int socket_fd);
  */
 int bluetooth_rfcomm_write(int fd, const char *buf, int length);
 
+/**
+ * @fn int bluetooth_rfcomm_write_async(int fd, const char *buf, int length)
+ * @brief Queue data on the rfcomm connection
+ *
+ *
+ * This API copies the data into the transmit queue of the socket and returns immediately. The
+ * queue is drained from the main loop when the socket becomes writable, so several small writes
+ * are sent with a single wakeup. BLUETOOTH_EVENT_RFCOMM_DATA_SENT is delivered once the queued
+ * requests have been written to the socket.
+ *
+ * @return  BLUETOOTH_ERROR_NONE  - Success \n
+ *              BLUETOOTH_ERROR_INVALID_PARAM - Invalid parameter \n
+ *              BLUETOOTH_ERROR_DEVICE_BUSY - The queue is above the high-water mark \n
+ *              BLUETOOTH_ERROR_NOT_IN_OPERATION - The Fd is currently not in operation\n
+ * @param[in]  int fd
+ * @param[in]  const char *buff  Data buffer to send
+ * @param[in]  int length Length of the data
+ *
+ * @remark      On BLUETOOTH_ERROR_DEVICE_BUSY retry after the next
+ *		BLUETOOTH_EVENT_RFCOMM_DATA_SENT event.
+ * @see         bluetooth_rfcomm_write, bluetooth_rfcomm_set_write_high_water_mark
+ *
+  @code
+  char *buff = "Test data 123456789"
+  ret =  bluetooth_rfcomm_write_async(g_ret_fd, buff, 15);
+  if (ret == BLUETOOTH_ERROR_DEVICE_BUSY)
+	printf("Queue full, wait for BLUETOOTH_EVENT_RFCOMM_DATA_SENT");
+
+ @endcode
+ */
+int bluetooth_rfcomm_write_async(int fd, const char *buf, int length);
+
+/**
+ * @fn int bluetooth_rfcomm_set_write_high_water_mark(int fd, unsigned int size)
+ * @brief Set the transmit queue limit of the rfcomm connection
+ *
+ *
+ * The high-water mark is the maximum number of bytes queued on the socket. Writes that would
+ * exceed it are refused with BLUETOOTH_ERROR_DEVICE_BUSY. The default is 64 KB.
+ *
+ * @return  BLUETOOTH_ERROR_NONE  - Success \n
+ *              BLUETOOTH_ERROR_INVALID_PARAM - Invalid parameter \n
+ *              BLUETOOTH_ERROR_DEVICE_BUSY - More data than size is already queued \n
+ * @param[in]  int fd
+ * @param[in]  unsigned int size  Queue limit in bytes
+ *
+ * @remark      None
+ * @see         bluetooth_rfcomm_write_async
+ */
+int bluetooth_rfcomm_set_write_high_water_mark(int fd, unsigned int size);
+
+/**
+ * @fn int bluetooth_rfcomm_set_receive_buffer_size(int fd, int size)
+ * @brief Coalesce received rfcomm data into a socket buffer
+ *
+ *
+ * By default one BLUETOOTH_EVENT_RFCOMM_DATA_RECEIVED event is delivered for every 1 KB read
+ * from the socket. After this call the library drains the socket into a buffer of the given size
+ * until it would block and delivers all the data read in one wakeup with a single
+ * BLUETOOTH_EVENT_RFCOMM_DATA_RECEIVED event. The buffer is owned by the library and is only valid
+ * during the event callback.
+ *
+ * @return  BLUETOOTH_ERROR_NONE  - Success \n
+ *              BLUETOOTH_ERROR_INVALID_PARAM - Invalid parameter \n
+ *              BLUETOOTH_ERROR_NOT_CONNECTED - The Fd is not a connected rfcomm socket \n
+ * @param[in]  int fd
+ * @param[in]  int size  Buffer size in bytes, 0 restores the default mode
+ *
+ * @remark      Call it from the BLUETOOTH_EVENT_RFCOMM_CONNECTED callback.
+ * @see         bluetooth_rfcomm_set_receive_buffers
+ */
+int bluetooth_rfcomm_set_receive_buffer_size(int fd, int size);
+
+/**
+ * @fn int bluetooth_rfcomm_set_receive_buffers(int fd, const bluetooth_rfcomm_buffer_t *buffers,
+ *						int count)
+ * @brief Receive rfcomm data directly into application buffers
+ *
+ *
+ * Registers a pool of application buffers for the socket. The library fills the pool with readv()
+ * until the socket would block or the pool is full and then delivers
+ * BLUETOOTH_EVENT_RFCOMM_DATA_RECEIVED_BUFFERS with the filled buffers. The pool is reused for the
+ * next wakeup, so the data must be consumed in the event callback.
+ *
+ * @return  BLUETOOTH_ERROR_NONE  - Success \n
+ *              BLUETOOTH_ERROR_INVALID_PARAM - Invalid parameter \n
+ *              BLUETOOTH_ERROR_NOT_CONNECTED - The Fd is not a connected rfcomm socket \n
+ * @param[in]  int fd
+ * @param[in]  const bluetooth_rfcomm_buffer_t *buffers  Buffer pool, NULL restores the default mode
+ * @param[in]  int count  Number of buffers in the pool
+ *
+ * @remark      The buffers must stay valid until the socket is disconnected or the default mode
+ *		is restored.
+ * @see         bluetooth_rfcomm_set_receive_buffer_size
+ */
+int bluetooth_rfcomm_set_receive_buffers(int fd, const bluetooth_rfcomm_buffer_t *buffers,
+						int count);
+
+/**
+ * @fn int bluetooth_rfcomm_get_socket_by_address(const bluetooth_device_address_t *remote_bt_address)
+ * @brief Get the rfcomm socket connected to a remote device
+ *
+ *
+ * This API looks up the rfcomm connections of this process, server and client, without any
+ * IPC. If several channels are open to the device the most recent one is returned.
+ *
+ * @return  socket fd  - Success \n
+ *              BLUETOOTH_ERROR_INVALID_PARAM - Invalid parameter \n
+ *              BLUETOOTH_ERROR_NOT_CONNECTED - No connection to the device \n
+ * @param[in]  remote_bt_address  Remote device address
+ *
+ * @remark      None
+ * @see         bluetooth_rfcomm_connect, bluetooth_rfcomm_listen_and_accept
+ */
+int bluetooth_rfcomm_get_socket_by_address(const bluetooth_device_address_t *remote_bt_address);
+
 /**
  * @fn gboolean bluetooth_rfcomm_is_client_connected(void)
  * @brief Informs whether rfcomm client is connected.
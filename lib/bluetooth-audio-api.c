@@ -907,9 +907,56 @@ static DBusHandlerResult __bluetooth_audio_sink_event_filter(
 	return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
 }
 
+static void __bluetooth_audio_remove_filter(void)
+{
+	_bluetooth_internal_remove_signal_handler(AUDIO_AG_DBUS_INTERFACE,
+					"PropertyChanged",
+					__bluetooth_ag_event_filter, NULL);
+
+	_bluetooth_internal_remove_signal_handler(BLUEZ_MANAGER_INTERFACE,
+					"AdapterRemoved",
+					__bluetooth_ag_event_filter, NULL);
+
+	_bluetooth_internal_remove_signal_handler(AUDIO_SINK_DBUS_INTERFACE,
+					"PropertyChanged",
+					__bluetooth_audio_sink_event_filter, NULL);
+
+	_bluetooth_internal_remove_signal_handler(BLUEZ_MANAGER_INTERFACE,
+					"AdapterRemoved",
+					__bluetooth_audio_sink_event_filter, NULL);
+}
+
+static int __bluetooth_audio_add_filter(void)
+{
+	/* Both filters also reset their state on AdapterRemoved */
+	if (_bluetooth_internal_add_signal_handler(AUDIO_AG_DBUS_INTERFACE,
+					"PropertyChanged", NULL,
+					__bluetooth_ag_event_filter, NULL) < 0)
+		goto fail;
+
+	if (_bluetooth_internal_add_signal_handler(BLUEZ_MANAGER_INTERFACE,
+					"AdapterRemoved", NULL,
+					__bluetooth_ag_event_filter, NULL) < 0)
+		goto fail;
+
+	if (_bluetooth_internal_add_signal_handler(AUDIO_SINK_DBUS_INTERFACE,
+					"PropertyChanged", NULL,
+					__bluetooth_audio_sink_event_filter, NULL) < 0)
+		goto fail;
+
+	if (_bluetooth_internal_add_signal_handler(BLUEZ_MANAGER_INTERFACE,
+					"AdapterRemoved", NULL,
+					__bluetooth_audio_sink_event_filter, NULL) < 0)
+		goto fail;
+
+	return BLUETOOTH_AUDIO_ERROR_NONE;
+fail:
+	__bluetooth_audio_remove_filter();
+	return BLUETOOTH_AUDIO_ERROR_INTERNAL;
+}
+
 BT_EXPORT_API int bluetooth_audio_init(bt_audio_func_ptr cb, void  *user_data)
 {
-	DBusError dbus_error;
 	DBG("bluetooth_audio_init +\n");
 
 	if (NULL == cb)
@@ -923,35 +970,8 @@ BT_EXPORT_API int bluetooth_audio_init(bt_audio_func_ptr cb, void  *user_data)
 		return BLUETOOTH_AUDIO_ERROR_INTERNAL;
 	}
 
-	dbus_error_init(&dbus_error);
-
-	dbus_connection_add_filter(audio_connection,
-				__bluetooth_ag_event_filter,
-				NULL, NULL);
-
-	dbus_connection_add_filter(audio_connection,
-				__bluetooth_audio_sink_event_filter,
-				NULL, NULL);
-
-	dbus_bus_add_match(audio_connection,
-			"type='signal',interface='" AUDIO_AG_DBUS_INTERFACE
-			"',member='PropertyChanged'", &dbus_error);
-
-	if (dbus_error_is_set(&dbus_error)) {
-		DBG("Fail to add dbus filter signal\n");
-		dbus_error_free(&dbus_error);
-		__bluetooth_audio_proxy_deinit();
-		return BLUETOOTH_AUDIO_ERROR_INTERNAL;
-	}
-
-	dbus_bus_add_match(audio_connection,
-			   "type='signal',interface='"
-			   AUDIO_SINK_DBUS_INTERFACE
-			   "',member='PropertyChanged'", &dbus_error);
-
-	if (dbus_error_is_set(&dbus_error)) {
+	if (__bluetooth_audio_add_filter() < 0) {
 		DBG("Fail to add dbus filter signal\n");
-		dbus_error_free(&dbus_error);
 		__bluetooth_audio_proxy_deinit();
 		return BLUETOOTH_AUDIO_ERROR_INTERNAL;
 	}
@@ -966,14 +986,8 @@ BT_EXPORT_API int bluetooth_audio_deinit(void)
 
 	audio_info.audio_cb = NULL;
 
-	if (audio_connection) {
-		dbus_connection_remove_filter(audio_connection,
-				__bluetooth_ag_event_filter, NULL);
-
-		dbus_connection_remove_filter(audio_connection,
-				      __bluetooth_audio_sink_event_filter,
-				      NULL);
-	}
+	if (audio_connection)
+		__bluetooth_audio_remove_filter();
 
 	if (NULL != audio_dbus_info.audio_obj_path) {
 		g_free(audio_dbus_info.audio_obj_path);
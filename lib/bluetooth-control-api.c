@@ -32,6 +32,7 @@
 #include <string.h>
 
 #include "bluetooth-control-api.h"
+#include "bluetooth-api-signal.h"
 
 #define BLUEZ_SERVICE	"org.bluez"
 #define BLUEZ_MANAGER_INTERFACE "org.bluez.Manager"
@@ -432,7 +433,6 @@ BT_EXPORT_API int bluetooth_media_init(void)
 {
 	GError *err = NULL;
 	char default_obj_path[MEDIA_OBJECT_PATH_LENGTH] = {0,};
-	DBusError dbus_error;
 
 	DBG("bluetooth_media_init +\n");
 
@@ -449,19 +449,11 @@ BT_EXPORT_API int bluetooth_media_init(void)
 	g_avrcp_connection = dbus_g_connection_get_connection(
 						g_avrcp_dbus_info.avrcp_conn);
 
-	dbus_error_init(&dbus_error);
-
-	dbus_connection_add_filter(g_avrcp_connection,
-				__bluetooth_media_event_filter, NULL, NULL);
-
-	dbus_bus_add_match(g_avrcp_connection,
-			"type='signal',interface="  \
-			BT_MEDIA_PLAYER_DBUS_INTERFACE,
-			&dbus_error);
-
-	if (dbus_error_is_set(&dbus_error)) {
+	if (_bluetooth_internal_add_signal_handler(BT_MEDIA_PLAYER_DBUS_INTERFACE,
+					NULL, NULL,
+					__bluetooth_media_event_filter,
+					NULL) < 0) {
 		DBG("Fail to add dbus filter signal\n");
-		dbus_error_free(&dbus_error);
 		return BLUETOOTH_CONTROL_ERROR;
 	}
 
@@ -484,6 +476,9 @@ BT_EXPORT_API int bluetooth_media_init(void)
 	return BLUETOOTH_CONTROL_SUCCESS;
 
 error:
+	_bluetooth_internal_remove_signal_handler(BT_MEDIA_PLAYER_DBUS_INTERFACE,
+					NULL, __bluetooth_media_event_filter,
+					NULL);
 	dbus_g_connection_unref(g_avrcp_dbus_info.avrcp_conn);
 	g_avrcp_dbus_info.avrcp_conn = NULL;
 	g_avrcp_connection = NULL;
@@ -706,6 +701,10 @@ BT_EXPORT_API int bluetooth_media_deinit(void)
 	DBG("bluetooth_media_deinit +\n");
 
 	if (g_avrcp_dbus_info.avrcp_conn) {
+		_bluetooth_internal_remove_signal_handler(
+					BT_MEDIA_PLAYER_DBUS_INTERFACE,
+					NULL, __bluetooth_media_event_filter,
+					NULL);
 		dbus_g_connection_unref(g_avrcp_dbus_info.avrcp_conn);
 		g_avrcp_dbus_info.avrcp_conn = NULL;
 	}
@@ -28,9 +28,12 @@
 #include "bluetooth-gap-api.h"
 
 static bluetooth_discovery_option_t discovery_option = { 0 };
+static bt_discovery_aggregator_t discovery_agg = { 0 };
 
 static int __bluetooth_internal_bonding_req(void);
 static void __bluetooth_internal_get_service_list(GValue *value, bluetooth_device_info_t *dev);
+static bool __bluetooth_match_discovery_option(bluetooth_device_class_t device_class,
+						unsigned int mask);
 
 static int __bt_launch_terminate_popup(void)
 {
@@ -660,6 +663,69 @@ BT_EXPORT_API int bluetooth_set_discoverable_mode(bluetooth_discoverable_mode_t
 	return ret;
 }
 
+static void __bluetooth_internal_discovery_agg_clear(void)
+{
+	int i;
+
+	if (discovery_agg.flush_timer) {
+		g_source_remove(discovery_agg.flush_timer);
+		discovery_agg.flush_timer = 0;
+	}
+
+	if (discovery_agg.devices == NULL)
+		return;
+
+	g_hash_table_remove_all(discovery_agg.devices);
+	g_ptr_array_set_size(discovery_agg.pending, 0);
+
+	for (i = 0; i < discovery_agg.order->len; i++)
+		g_free(g_ptr_array_index(discovery_agg.order, i));
+	g_ptr_array_set_size(discovery_agg.order, 0);
+}
+
+static void __bluetooth_internal_discovery_agg_flush(void)
+{
+	int i;
+	bt_discovered_device_t *device;
+	bluetooth_discovered_devices_t batch = { 0 };
+
+	if (discovery_agg.flush_timer) {
+		g_source_remove(discovery_agg.flush_timer);
+		discovery_agg.flush_timer = 0;
+	}
+
+	if (discovery_agg.pending == NULL || discovery_agg.pending->len == 0)
+		return;
+
+	batch.count = discovery_agg.pending->len;
+	batch.devices = g_new0(bluetooth_device_info_t, batch.count);
+
+	for (i = 0; i < batch.count; i++) {
+		device = g_ptr_array_index(discovery_agg.pending, i);
+		memcpy(&batch.devices[i], &device->info, sizeof(batch.devices[i]));
+		device->reported_rssi = device->info.rssi;
+		device->reported = TRUE;
+		device->dirty = FALSE;
+	}
+
+	g_ptr_array_set_size(discovery_agg.pending, 0);
+
+	DBG("Deliver [%d] discovered devices", batch.count);
+
+	_bluetooth_internal_event_cb(BLUETOOTH_EVENT_REMOTE_DEVICE_LIST_UPDATED,
+					BLUETOOTH_ERROR_NONE, &batch);
+
+	g_free(batch.devices);
+}
+
+static gboolean __bluetooth_internal_discovery_agg_timeout_cb(gpointer data)
+{
+	discovery_agg.flush_timer = 0;
+	__bluetooth_internal_discovery_agg_flush();
+
+	return FALSE;
+}
+
 void _bluetooth_internal_discovery_started_cb(void)
 {
 	bt_info_t *bt_internal_info = NULL;
@@ -672,27 +738,133 @@ void _bluetooth_internal_discovery_started_cb(void)
 		bt_internal_info->is_discovery_req = 1;
 	}
 
+	/* The snapshot describes the current inquiry only */
+	__bluetooth_internal_discovery_agg_clear();
+
 	_bluetooth_internal_event_cb(BLUETOOTH_EVENT_DISCOVERY_STARTED,
 					BLUETOOTH_ERROR_NONE, NULL);
 	return;
 }
 
 void _bluetooth_internal_remote_device_found_cb(const char *address,
-					       int rssi, unsigned int remote_class, gboolean paired)
+					       const char *name, int rssi,
+					       unsigned int remote_class, gboolean paired)
 {
-	bt_info_t *bt_internal_info = NULL;
-	bluetooth_device_info_t dev_info = { { { 0 } } };
+	bt_discovered_device_t *device;
+	bluetooth_device_class_t device_class = { 0 };
+	gboolean name_changed = FALSE;
+	gboolean changed = FALSE;
 
-	bt_internal_info = _bluetooth_internal_get_information();
+	if (address == NULL)
+		return;
 
-	_bluetooth_internal_convert_addr_string_to_addr_type(&dev_info.device_address, address);
-	_bluetooth_internal_divide_device_class(&dev_info.device_class, remote_class);
-	dev_info.rssi = rssi;
-	dev_info.paired = paired;
+	/* Filter before anything is allocated for the result */
+	_bluetooth_internal_divide_device_class(&device_class, remote_class);
 
-	_bluetooth_internal_event_cb(BLUETOOTH_EVENT_REMOTE_DEVICE_FOUND,
-					BLUETOOTH_ERROR_NONE, &dev_info);
-	return;
+	if (__bluetooth_match_discovery_option(device_class,
+				discovery_option.classOfDeviceMask) == FALSE)
+		return;
+
+	if (discovery_agg.devices == NULL) {
+		discovery_agg.devices = g_hash_table_new_full(g_str_hash, g_str_equal,
+							g_free, NULL);
+		discovery_agg.order = g_ptr_array_new();
+		discovery_agg.pending = g_ptr_array_new();
+	}
+
+	device = g_hash_table_lookup(discovery_agg.devices, address);
+	if (device == NULL) {
+		device = g_new0(bt_discovered_device_t, 1);
+		_bluetooth_internal_convert_addr_string_to_addr_type(
+					&device->info.device_address, address);
+		g_hash_table_insert(discovery_agg.devices, g_strdup(address), device);
+		g_ptr_array_add(discovery_agg.order, device);
+		changed = TRUE;
+	}
+
+	if (name && strlen(name) <= BLUETOOTH_DEVICE_NAME_LENGTH_MAX &&
+	    g_strcmp0(device->info.device_name.name, name) != 0) {
+		g_strlcpy(device->info.device_name.name, name,
+				sizeof(device->info.device_name.name));
+		name_changed = TRUE;
+		changed = TRUE;
+	}
+
+	if (memcmp(&device->info.device_class, &device_class, sizeof(device_class)) ||
+	    device->info.paired != paired) {
+		device->info.device_class = device_class;
+		device->info.paired = paired;
+		changed = TRUE;
+	}
+
+	device->info.rssi = rssi;
+
+	/* Repeated inquiry results mostly differ by a few dBm only */
+	if (device->reported && ABS(rssi - device->reported_rssi) >=
+					BLUETOOTH_DISCOVERY_RSSI_DELTA)
+		changed = TRUE;
+
+	if (!changed)
+		return;
+
+	if (discovery_agg.interval == 0) {
+		device->reported_rssi = rssi;
+		device->reported = TRUE;
+
+		_bluetooth_internal_event_cb(device->info.device_name.name[0] ?
+					BLUETOOTH_EVENT_REMOTE_DEVICE_NAME_UPDATED :
+					BLUETOOTH_EVENT_REMOTE_DEVICE_FOUND,
+					BLUETOOTH_ERROR_NONE, &device->info);
+		return;
+	}
+
+	if (!device->dirty) {
+		device->dirty = TRUE;
+		g_ptr_array_add(discovery_agg.pending, device);
+	}
+
+	if (discovery_agg.flush_timer == 0)
+		discovery_agg.flush_timer = g_timeout_add(discovery_agg.interval,
+					__bluetooth_internal_discovery_agg_timeout_cb, NULL);
+
+	DBG("Queued [%s] name changed [%d]", address, name_changed);
+}
+
+BT_EXPORT_API int bluetooth_set_discovery_report_interval(unsigned int interval)
+{
+	discovery_agg.interval = interval;
+
+	/* Anything queued under the previous cadence goes out now */
+	__bluetooth_internal_discovery_agg_flush();
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+BT_EXPORT_API int bluetooth_get_discovered_devices(bluetooth_device_info_t **dev_array,
+							int *count)
+{
+	int i;
+	bt_discovered_device_t *device;
+
+	if (dev_array == NULL || count == NULL)
+		return BLUETOOTH_ERROR_INVALID_PARAM;
+
+	*dev_array = NULL;
+	*count = 0;
+
+	if (discovery_agg.order == NULL || discovery_agg.order->len == 0)
+		return BLUETOOTH_ERROR_NONE;
+
+	*dev_array = g_new0(bluetooth_device_info_t, discovery_agg.order->len);
+
+	for (i = 0; i < discovery_agg.order->len; i++) {
+		device = g_ptr_array_index(discovery_agg.order, i);
+		memcpy(&(*dev_array)[i], &device->info, sizeof(bluetooth_device_info_t));
+	}
+
+	*count = discovery_agg.order->len;
+
+	return BLUETOOTH_ERROR_NONE;
 }
 
 
@@ -799,6 +971,9 @@ void _bluetooth_internal_discovery_completed_cb(void)
 		bt_internal_info->is_discovery_cancel = FALSE;
 	}
 
+	/* Deliver the last partial batch before the finished event */
+	__bluetooth_internal_discovery_agg_flush();
+
 	_bluetooth_internal_event_cb(BLUETOOTH_EVENT_DISCOVERY_FINISHED,
 					result, NULL);
 
@@ -1025,15 +1200,12 @@ int _bluetooth_is_headset_device(DBusGProxy *proxy)
 	if (proxy == NULL)
 		return 0;
 
-	dbus_g_proxy_call(proxy, "GetProperties", NULL,
-			  G_TYPE_INVALID,
-			  dbus_g_type_get_map("GHashTable", G_TYPE_STRING,
-					      G_TYPE_VALUE), &hash,
-			  G_TYPE_INVALID);
+	hash = _bluetooth_internal_get_device_properties(dbus_g_proxy_get_path(proxy));
 
 	if (hash != NULL) {
 		value = g_hash_table_lookup(hash, "Class");
 		remote_class = value ? g_value_get_uint(value) : 0;
+		g_hash_table_unref(hash);
 	}
 
 	DBG("remote_class: %d", remote_class);
@@ -1116,10 +1288,9 @@ void _bluetooth_internal_bonding_created_cb(const char *bond_address, gpointer u
 
 	DBG("+\n");
 
-	dbus_g_proxy_call(device_proxy, "GetProperties", NULL,
-			  	G_TYPE_INVALID,
-			  	dbus_g_type_get_map("GHashTable", G_TYPE_STRING, G_TYPE_VALUE),
-				&hash, G_TYPE_INVALID);
+	if (device_proxy)
+		hash = _bluetooth_internal_get_device_properties(
+					dbus_g_proxy_get_path(device_proxy));
 
 	if (hash != NULL) {
 		value = g_hash_table_lookup(hash, "Name");
@@ -1169,6 +1340,10 @@ void _bluetooth_internal_bonding_created_cb(const char *bond_address, gpointer u
 							is_headset);
 	}
 
+	/* name and uuid_value point into the table */
+	if (hash != NULL)
+		g_hash_table_unref(hash);
+
 	DBG("-\n");
 
 	return;
@@ -1240,23 +1415,13 @@ static void __bluetooth_internal_bonding_req_finish_cb(DBusGProxy *proxy, DBusGP
 			__bluetooth_internal_bonding_req_reply_cb(BLUETOOTH_ERROR_IN_PROGRESS,
 								&device_info, 0);
 		} else if (!strcmp(err->message, "Authentication Failed")) {
-			dbus_g_proxy_call(bt_internal_info->adapter_proxy, "FindDevice", NULL,
-					  G_TYPE_STRING, bt_internal_info->bt_bonding_req_addrstr,
-					  G_TYPE_INVALID, DBUS_TYPE_G_OBJECT_PATH, &device_path,
-					  G_TYPE_INVALID);
-			if (!device_path) {
-				DBG("device_path is NULL");
-			}
-
 			/* Pairing fail case by wrong pin code */
-			device_proxy = _bluetooth_internal_find_device_by_path(device_path);
+			device_proxy = _bluetooth_internal_find_device_by_address(
+							&device_info.device_address);
 
 			if (device_proxy) {
-				dbus_g_proxy_call(device_proxy, "GetProperties", NULL,
-						  G_TYPE_INVALID,
-						  dbus_g_type_get_map("GHashTable", G_TYPE_STRING,
-								      G_TYPE_VALUE), &hash,
-						  G_TYPE_INVALID);
+				hash = _bluetooth_internal_get_device_properties(
+						dbus_g_proxy_get_path(device_proxy));
 			} else {
 				DBG("device proxy is NULL");
 			}
@@ -1264,6 +1429,7 @@ static void __bluetooth_internal_bonding_req_finish_cb(DBusGProxy *proxy, DBusGP
 			if (hash != NULL) {
 				value = g_hash_table_lookup(hash, "Class");
 				remote_class = value ? g_value_get_uint(value) : 0;
+				g_hash_table_unref(hash);
 			}
 
 			DBG("remote_class: %d", remote_class);
@@ -1299,17 +1465,14 @@ static void __bluetooth_internal_bonding_req_finish_cb(DBusGProxy *proxy, DBusGP
 		if (err != NULL)
 			g_error_free(err);
 	} else {
-		dbus_g_proxy_call(bt_internal_info->adapter_proxy, "FindDevice", NULL,
-				  G_TYPE_STRING, bt_internal_info->bt_bonding_req_addrstr,
-				  G_TYPE_INVALID, DBUS_TYPE_G_OBJECT_PATH, &device_path,
-				  G_TYPE_INVALID);
+		/* CreatePairedDevice already replied with the device path */
 		if (!device_path) {
 			DBG("device_path is NULL");
 		}
 
 		_bluetooth_internal_device_path_to_address(device_path, address);
 
-		device_proxy = _bluetooth_internal_find_device_by_path(device_path);
+		device_proxy = _bluetooth_internal_add_device(device_path);
 
 		_bluetooth_internal_bonding_created_cb(address,
 						(gpointer)device_proxy);
@@ -1793,171 +1956,260 @@ static void __bluetooth_internal_get_service_list(GValue *value, bluetooth_devic
 	DBG("-\n");
 }
 
-static int __bluetooth_internal_get_bonded_device_list_details(gchar *device_path,
-							     bluetooth_device_info_t *dev)
+static int __bluetooth_internal_fill_device_info(GHashTable *hash,
+						bluetooth_device_info_t *dev)
 {
-	DBG("+\n");
 	GValue *value = { 0 };
-	GError *err = NULL;
-
 	const gchar *address, *name;
 	unsigned int cod;
 	gint rssi;
 	gboolean trust;
 	gboolean paired;
 	gboolean connected;
+
+	if (hash == NULL) {
+		DBG("Hash is NULL\n");
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	value = g_hash_table_lookup(hash, "Paired");
+	paired = value ? g_value_get_boolean(value) : FALSE;
+
+	if (paired == FALSE)
+		return BLUETOOTH_ERROR_NOT_PAIRED;
+
+	value = g_hash_table_lookup(hash, "Address");
+	address = value ? g_value_get_string(value) : NULL;
+	if (address == NULL)
+		return BLUETOOTH_ERROR_INTERNAL;
+
+	value = g_hash_table_lookup(hash, "Alias");
+	name = value ? g_value_get_string(value) : NULL;
+	if (name != NULL)
+		DBG("Alias Name [%s]", name);
+	else {
+		value = g_hash_table_lookup(hash, "Name");
+		name = value ? g_value_get_string(value) : NULL;
+	}
+
+	value = g_hash_table_lookup(hash, "Class");
+	cod = value ? g_value_get_uint(value) : 0;
+	DBG("Address [%s], Name [%s], COD [0x%X]\n", address, name, cod);
+
+	value = g_hash_table_lookup(hash, "Connected");
+	connected = value ? g_value_get_boolean(value) : FALSE;
+
+	value = g_hash_table_lookup(hash, "Trusted");
+	trust = value ? g_value_get_boolean(value) : FALSE;
+
+	value = g_hash_table_lookup(hash, "RSSI");
+	rssi = value ? g_value_get_int(value) : 0;
+
+	value = g_hash_table_lookup(hash, "UUIDs");
+	__bluetooth_internal_get_service_list(value, dev);
+
+	_bluetooth_internal_convert_addr_string_to_addr_type(&dev->device_address,
+							    address);
+	g_strlcpy(dev->device_name.name, name ? name : address,
+			BLUETOOTH_DEVICE_NAME_LENGTH_MAX+1);
+
+	dev->rssi = rssi;
+	dev->trust = trust;
+	dev->paired = paired;
+	dev->connected = connected;
+	_bluetooth_internal_divide_device_class(&dev->device_class, cod);
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+static int __bluetooth_internal_get_bonded_device_list_details(gchar *device_path,
+							     bluetooth_device_info_t *dev)
+{
 	GHashTable *hash;
-	int ret_val = BLUETOOTH_ERROR_INTERNAL;
+	int ret_val;
+
+	DBG("+\n");
 
 	if ((dev == NULL) || (device_path == NULL))
 		return BLUETOOTH_ERROR_INVALID_PARAM;
 
-	DBusGProxy *device_proxy = _bluetooth_internal_find_device_by_path(device_path);
-	if (device_proxy == NULL) {
+	if (_bluetooth_internal_find_device_by_path(device_path) == NULL) {
 		DBG("Not Found device with path %s\n", device_path);
 
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
-	dbus_g_proxy_call(device_proxy, "GetProperties", &err,
-			  	G_TYPE_INVALID,
-				dbus_g_type_get_map("GHashTable", G_TYPE_STRING, G_TYPE_VALUE),
-				&hash, G_TYPE_INVALID);
+	hash = _bluetooth_internal_get_device_properties(device_path);
 
-	if (err != NULL) {
-		DBG("Error occured in Proxy call [%s]\n", err->message);
-		g_error_free(err);
+	ret_val = __bluetooth_internal_fill_device_info(hash, dev);
+
+	if (hash != NULL)
+		g_hash_table_unref(hash);
+
+	DBG("-\n");
+	return ret_val;
+}
+
+static int __bluetooth_internal_list_device_paths(GPtrArray **gp_array)
+{
+	bt_info_t *bt_internal_info = NULL;
+	GError *error = NULL;
+
+	bt_internal_info = _bluetooth_internal_get_information();
+
+	if (bt_internal_info->adapter_proxy == NULL)
+		return BLUETOOTH_ERROR_INTERNAL;
 
+	dbus_g_proxy_call(bt_internal_info->adapter_proxy, "ListDevices", &error,
+			  	G_TYPE_INVALID,
+				dbus_g_type_get_collection("GPtrArray", DBUS_TYPE_G_OBJECT_PATH),
+			 	gp_array, G_TYPE_INVALID);
+	if (error != NULL) {
+		DBG("ListDevices error: [%s]\n", error->message);
+		g_error_free(error);
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
-	if (hash != NULL) {
-		value = g_hash_table_lookup(hash, "Paired");
-		paired = g_value_get_boolean(value);
+	if (*gp_array == NULL) {
+		DBG("DBus error: \n");
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
 
-		if (paired == FALSE)
-			return BLUETOOTH_ERROR_NOT_PAIRED;
+	return BLUETOOTH_ERROR_NONE;
+}
 
-		value = g_hash_table_lookup(hash, "Address");
-		address = value ? g_value_get_string(value) : NULL;
+/* Resolves every path into dev_array in ListDevices order and returns the
+   number of bonded devices. Uncached devices are fetched with all their
+   GetProperties calls in flight at once; unpaired or failing devices are
+   skipped. */
+static int __bluetooth_internal_collect_bonded_devices(GPtrArray *gp_array,
+						bluetooth_device_info_t *dev_array)
+{
+	int i;
+	int count = 0;
+	int *result;
+	DBusGProxyCall **calls;
+	DBusGProxy **proxies;
+	bt_device_entry_t *entry;
+	GHashTable *hash;
+	GError *error = NULL;
 
-		value = g_hash_table_lookup(hash, "Alias");
-		name = value ? g_value_get_string(value) : NULL;
-		if (name != NULL)
-			DBG("Alias Name [%s]", name);
-		else {
-			value = g_hash_table_lookup(hash, "Name");
-			name = value ? g_value_get_string(value) : NULL;
-		}
+	result = g_new0(int, gp_array->len);
+	calls = g_new0(DBusGProxyCall *, gp_array->len);
+	proxies = g_new0(DBusGProxy *, gp_array->len);
 
-		value = g_hash_table_lookup(hash, "Class");
-		cod = value ? g_value_get_uint(value) : 0;
-		DBG("Address [%s], Name [%s], COD [0x%X]\n", address, name, cod);
+	for (i = 0; i < gp_array->len; i++) {
+		gchar *gp_path = g_ptr_array_index(gp_array, i);
 
-		value = g_hash_table_lookup(hash, "Connected");
-		connected = value ? g_value_get_boolean(value) : FALSE;
+		result[i] = BLUETOOTH_ERROR_INTERNAL;
 
-		value = g_hash_table_lookup(hash, "Trusted");
-		trust = value ? g_value_get_boolean(value) : FALSE;
+		if (gp_path == NULL)
+			continue;
 
-		value = g_hash_table_lookup(hash, "RSSI");
-		rssi = value ? g_value_get_int(value) : 0;
+		if (_bluetooth_internal_add_device(gp_path) == NULL)
+			continue;
 
-		value = g_hash_table_lookup(hash, "UUIDs");
-		__bluetooth_internal_get_service_list(value, dev);
+		entry = _bluetooth_internal_get_device_entry(gp_path);
+		if (entry == NULL)
+			continue;
 
-		_bluetooth_internal_convert_addr_string_to_addr_type(&dev->device_address,
-								    address);
-		g_strlcpy(dev->device_name.name, name,
-				BLUETOOTH_DEVICE_NAME_LENGTH_MAX+1);
+		if (entry->properties) {
+			result[i] = __bluetooth_internal_fill_device_info(
+						entry->properties, &dev_array[i]);
+			continue;
+		}
 
-		dev->rssi = rssi;
-		dev->trust = trust;
-		dev->paired = paired;
-		dev->connected = connected;
-		_bluetooth_internal_divide_device_class(&dev->device_class, cod);
+		proxies[i] = entry->proxy;
+		calls[i] = dbus_g_proxy_begin_call(entry->proxy, "GetProperties",
+						NULL, NULL, NULL, G_TYPE_INVALID);
+	}
 
-		ret_val = BLUETOOTH_ERROR_NONE;
-	} else {
-		DBG("Hash is NULL\n");
-		ret_val = BLUETOOTH_ERROR_INTERNAL;
+	for (i = 0; i < gp_array->len; i++) {
+		if (calls[i] == NULL)
+			continue;
+
+		hash = NULL;
+		if (!dbus_g_proxy_end_call(proxies[i], calls[i], &error,
+				dbus_g_type_get_map("GHashTable", G_TYPE_STRING, G_TYPE_VALUE),
+				&hash, G_TYPE_INVALID)) {
+			DBG("GetProperties [%s] failed: %s",
+				(char *)g_ptr_array_index(gp_array, i),
+				error ? error->message : "");
+			if (error) {
+				g_error_free(error);
+				error = NULL;
+			}
+			continue;
+		}
+
+		/* Fill before the table can be evicted by the next insertion */
+		result[i] = __bluetooth_internal_fill_device_info(hash, &dev_array[i]);
+
+		entry = _bluetooth_internal_get_device_entry(
+					g_ptr_array_index(gp_array, i));
+		_bluetooth_internal_set_device_properties(entry, hash);
 	}
 
-	DBG("-\n");
-	return ret_val;
+	for (i = 0; i < gp_array->len; i++) {
+		if (result[i] != BLUETOOTH_ERROR_NONE)
+			continue;
+
+		if (count != i)
+			memcpy(&dev_array[count], &dev_array[i], sizeof(*dev_array));
+		count++;
+	}
+
+	g_free(proxies);
+	g_free(calls);
+	g_free(result);
 
+	return count;
 }
 
 static int bluetooth_internal_get_bonded_device_list(GPtrArray **dev_list)
 {
 	DBG("+\n");
-	int ret_val = BLUETOOTH_ERROR_NONE;
+	int ret_val;
 	int i;
-	bt_info_t *bt_internal_info = NULL;
+	int count;
 	GPtrArray *gp_array = NULL;
 	GPtrArray *result = NULL;
-	GError *error = NULL;
+	bluetooth_device_info_t *dev_array;
 	bluetooth_device_info_t *devinfo;
 
 	if (dev_list == NULL)
 		return BLUETOOTH_ERROR_INVALID_PARAM;
 	result = *dev_list;
 
-	bt_internal_info = _bluetooth_internal_get_information();
-
-	if (bt_internal_info->adapter_proxy == NULL)
-		return BLUETOOTH_ERROR_INTERNAL;
-
-	dbus_g_proxy_call(bt_internal_info->adapter_proxy, "ListDevices", &error,
-			  	G_TYPE_INVALID,
-				dbus_g_type_get_collection("GPtrArray", DBUS_TYPE_G_OBJECT_PATH),
-			 	&gp_array, G_TYPE_INVALID);
-	if (error != NULL)
-		goto err_listdev;
-
-	if (gp_array == NULL) {
-		DBG("DBus error: \n");
-		goto err_done;
-	}
-
+	ret_val = __bluetooth_internal_list_device_paths(&gp_array);
+	if (ret_val != BLUETOOTH_ERROR_NONE)
+		return ret_val;
 
 	if (gp_array->len == 0) {
 		result->len = 0;
-		goto success;
+		goto done;
 	}
 
 	DBG("Num of ListDevices = [%d]", gp_array->len);
-	for (i = 0; i < gp_array->len; i++) {
-		gchar *gp_path = g_ptr_array_index(gp_array, i);
 
-		if (gp_path == NULL)
-			continue;
+	dev_array = g_new0(bluetooth_device_info_t, gp_array->len);
+	count = __bluetooth_internal_collect_bonded_devices(gp_array, dev_array);
 
-		DBG("Newly list device [%s]\n", gp_path);
+	/* The list elements are released by the caller, one allocation each */
+	for (i = 0; i < count; i++) {
 		devinfo = (bluetooth_device_info_t *)malloc(sizeof(*devinfo));
-		memset(devinfo, 0, sizeof(*devinfo));
-		if (__bluetooth_internal_get_bonded_device_list_details(gp_path,
-					devinfo) == BLUETOOTH_ERROR_NONE) {
-			g_ptr_array_add(result, (gpointer)devinfo);
-		} else {
-			DBG("Can't get the paired device path \n");
-			free(devinfo);
+		if (devinfo == NULL)
 			break;
-		}
+		memcpy(devinfo, &dev_array[i], sizeof(*devinfo));
+		g_ptr_array_add(result, (gpointer)devinfo);
 	}
 
-success:
-	g_ptr_array_free(gp_array, TRUE);
-	DBG("-\n");
-	return ret_val;
-
-err_listdev:
-	DBG("ListDevices error: [%s]\n", error->message);
-	g_error_free(error);
+	g_free(dev_array);
 
-err_done:
+done:
+	g_ptr_array_free(gp_array, TRUE);
 	DBG("-\n");
-	return BLUETOOTH_ERROR_INTERNAL;
+	return BLUETOOTH_ERROR_NONE;
 }
 
 BT_EXPORT_API int bluetooth_get_bonded_device_list(GPtrArray **dev_list)
@@ -1978,12 +2230,215 @@ BT_EXPORT_API int bluetooth_get_bonded_device_list(GPtrArray **dev_list)
 	return ret_val;
 }
 
+BT_EXPORT_API int bluetooth_get_bonded_device_array(bluetooth_device_info_t **dev_array,
+							int *count)
+{
+	int ret_val;
+	GPtrArray *gp_array = NULL;
+	bluetooth_device_info_t *devices;
+
+	if (dev_array == NULL || count == NULL)
+		return BLUETOOTH_ERROR_INVALID_PARAM;
+
+	*dev_array = NULL;
+	*count = 0;
+
+	_bluetooth_internal_session_init();
+
+	if (_bluetooth_internal_is_adapter_enabled() == FALSE) {
+		DBG("Currently not enabled");
+		return BLUETOOTH_ERROR_DEVICE_NOT_ENABLED;
+	}
+
+	ret_val = __bluetooth_internal_list_device_paths(&gp_array);
+	if (ret_val != BLUETOOTH_ERROR_NONE)
+		return ret_val;
+
+	if (gp_array->len > 0) {
+		devices = g_new0(bluetooth_device_info_t, gp_array->len);
+		*count = __bluetooth_internal_collect_bonded_devices(gp_array, devices);
+
+		if (*count > 0)
+			*dev_array = devices;
+		else
+			g_free(devices);
+	}
+
+	g_ptr_array_free(gp_array, TRUE);
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+typedef struct {
+	int pending;
+	int found;
+} bt_bonded_stream_t;
+
+typedef struct {
+	bt_bonded_stream_t *stream;
+	char *path;
+} bt_bonded_stream_req_t;
+
+static void __bluetooth_internal_bonded_stream_unref(bt_bonded_stream_t *stream)
+{
+	if (--stream->pending > 0)
+		return;
+
+	DBG("Bonded device stream finished [%d]", stream->found);
+
+	_bluetooth_internal_event_cb(BLUETOOTH_EVENT_BONDED_DEVICE_LIST_FINISHED,
+					BLUETOOTH_ERROR_NONE, &stream->found);
+	g_free(stream);
+}
+
+static void __bluetooth_internal_bonded_stream_emit(bt_bonded_stream_t *stream,
+							GHashTable *hash)
+{
+	bluetooth_device_info_t devinfo;
+
+	memset(&devinfo, 0x00, sizeof(devinfo));
+
+	if (__bluetooth_internal_fill_device_info(hash, &devinfo) !=
+						BLUETOOTH_ERROR_NONE)
+		return;
+
+	stream->found++;
+	_bluetooth_internal_event_cb(BLUETOOTH_EVENT_BONDED_DEVICE_FOUND,
+					BLUETOOTH_ERROR_NONE, &devinfo);
+}
+
+static void __bluetooth_internal_bonded_stream_req_free(gpointer data)
+{
+	bt_bonded_stream_req_t *req = data;
+
+	/* Also runs when the device proxy goes away with the call pending */
+	__bluetooth_internal_bonded_stream_unref(req->stream);
+	g_free(req->path);
+	g_free(req);
+}
+
+static void __bluetooth_internal_bonded_stream_props_cb(DBusGProxy *proxy,
+							DBusGProxyCall *call,
+							gpointer user_data)
+{
+	bt_bonded_stream_req_t *req = user_data;
+	GHashTable *hash = NULL;
+	GError *error = NULL;
+
+	if (!dbus_g_proxy_end_call(proxy, call, &error,
+			dbus_g_type_get_map("GHashTable", G_TYPE_STRING, G_TYPE_VALUE),
+			&hash, G_TYPE_INVALID)) {
+		DBG("GetProperties [%s] failed: %s", req->path,
+					error ? error->message : "");
+		if (error)
+			g_error_free(error);
+		return;
+	}
+
+	__bluetooth_internal_bonded_stream_emit(req->stream, hash);
+
+	_bluetooth_internal_set_device_properties(
+			_bluetooth_internal_get_device_entry(req->path), hash);
+}
+
+static void __bluetooth_internal_bonded_stream_list_cb(DBusGProxy *proxy,
+							DBusGProxyCall *call,
+							gpointer user_data)
+{
+	bt_bonded_stream_t *stream = user_data;
+	bt_bonded_stream_req_t *req;
+	bt_device_entry_t *entry;
+	GPtrArray *gp_array = NULL;
+	GError *error = NULL;
+	int i;
+
+	if (!dbus_g_proxy_end_call(proxy, call, &error,
+			dbus_g_type_get_collection("GPtrArray", DBUS_TYPE_G_OBJECT_PATH),
+			&gp_array, G_TYPE_INVALID)) {
+		DBG("ListDevices error: [%s]\n", error ? error->message : "");
+		if (error)
+			g_error_free(error);
+		_bluetooth_internal_event_cb(BLUETOOTH_EVENT_BONDED_DEVICE_LIST_FINISHED,
+					BLUETOOTH_ERROR_INTERNAL, &stream->found);
+		g_free(stream);
+		return;
+	}
+
+	/* Held until every request below has been issued */
+	stream->pending = 1;
+
+	for (i = 0; gp_array && i < gp_array->len; i++) {
+		gchar *gp_path = g_ptr_array_index(gp_array, i);
+
+		if (gp_path == NULL || _bluetooth_internal_add_device(gp_path) == NULL)
+			continue;
+
+		entry = _bluetooth_internal_get_device_entry(gp_path);
+		if (entry == NULL)
+			continue;
+
+		if (entry->properties) {
+			__bluetooth_internal_bonded_stream_emit(stream, entry->properties);
+			continue;
+		}
+
+		req = g_new0(bt_bonded_stream_req_t, 1);
+		req->stream = stream;
+		req->path = g_strdup(gp_path);
+
+		stream->pending++;
+		if (!dbus_g_proxy_begin_call(entry->proxy, "GetProperties",
+				(DBusGProxyCallNotify)__bluetooth_internal_bonded_stream_props_cb,
+				req, __bluetooth_internal_bonded_stream_req_free,
+				G_TYPE_INVALID)) {
+			stream->pending--;
+			g_free(req->path);
+			g_free(req);
+		}
+	}
+
+	if (gp_array)
+		g_ptr_array_free(gp_array, TRUE);
+
+	__bluetooth_internal_bonded_stream_unref(stream);
+}
+
+BT_EXPORT_API int bluetooth_get_bonded_device_list_async(void)
+{
+	bt_info_t *bt_internal_info = NULL;
+	bt_bonded_stream_t *stream;
+
+	_bluetooth_internal_session_init();
+
+	if (_bluetooth_internal_is_adapter_enabled() == FALSE) {
+		DBG("Currently not enabled");
+		return BLUETOOTH_ERROR_DEVICE_NOT_ENABLED;
+	}
+
+	bt_internal_info = _bluetooth_internal_get_information();
+
+	if (bt_internal_info->adapter_proxy == NULL)
+		return BLUETOOTH_ERROR_INTERNAL;
+
+	stream = g_new0(bt_bonded_stream_t, 1);
+
+	if (!dbus_g_proxy_begin_call(bt_internal_info->adapter_proxy, "ListDevices",
+			(DBusGProxyCallNotify)__bluetooth_internal_bonded_stream_list_cb,
+			stream, NULL, G_TYPE_INVALID)) {
+		g_free(stream);
+		return BLUETOOTH_ERROR_INTERNAL;
+	}
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
 BT_EXPORT_API int bluetooth_get_bonded_device(const bluetooth_device_address_t *device_address,
 					      bluetooth_device_info_t *dev_info)
 {
 	bt_info_t *bt_internal_info = NULL;
 	GPtrArray *gp_array = NULL;
 	GError *error = NULL;
+	DBusGProxy *device_proxy = NULL;
 
 	if (device_address == NULL || dev_info == NULL)
 		return BLUETOOTH_ERROR_INVALID_PARAM;
@@ -1995,6 +2450,16 @@ BT_EXPORT_API int bluetooth_get_bonded_device(const bluetooth_device_address_t *
 		return BLUETOOTH_ERROR_DEVICE_NOT_ENABLED;
 	}
 
+	/* Known devices are answered from the registry without ListDevices */
+	device_proxy = _bluetooth_internal_find_device_by_address(device_address);
+	if (device_proxy) {
+		memset(dev_info, 0x00, sizeof(bluetooth_device_info_t));
+		if (__bluetooth_internal_get_bonded_device_list_details(
+				(gchar *)dbus_g_proxy_get_path(device_proxy),
+				dev_info) == BLUETOOTH_ERROR_NONE)
+			return BLUETOOTH_ERROR_NONE;
+	}
+
 	bt_internal_info = _bluetooth_internal_get_information();
 
 	if (bt_internal_info->adapter_proxy == NULL)
@@ -2030,7 +2495,6 @@ BT_EXPORT_API int bluetooth_get_bonded_device(const bluetooth_device_address_t *
 							}
 						} else {
 							DBG("Can't get the paired device path \n");
-							break;
 						}
 					}
 				}
@@ -2067,7 +2531,6 @@ BT_EXPORT_API int bluetooth_set_alias(const bluetooth_device_address_t *device_a
 	char addr[18] = { 0 };
 	int result = BLUETOOTH_ERROR_NONE;
 
-	const char *path = NULL;
 	DBusGProxy *device_proxy = NULL;
 	GValue name = { 0 };
 
@@ -2088,11 +2551,7 @@ BT_EXPORT_API int bluetooth_set_alias(const bluetooth_device_address_t *device_a
 
 	_bluetooth_internal_addr_type_to_addr_string(addr, device_address);
 
-	dbus_g_proxy_call(bt_internal_info->adapter_proxy, "FindDevice", NULL,
-			  G_TYPE_STRING, addr, G_TYPE_INVALID,
-			  DBUS_TYPE_G_OBJECT_PATH, &path, G_TYPE_INVALID);
-
-	device_proxy = _bluetooth_internal_find_device_by_path(path);
+	device_proxy = _bluetooth_internal_find_device_by_address(device_address);
 
 	if (device_proxy == NULL) {
 		DBG("No device [%s]\n", addr);
@@ -2119,7 +2578,6 @@ BT_EXPORT_API int bluetooth_authorize_device(const bluetooth_device_address_t *d
 	char addr[18] = { 0 };
 	int result = BLUETOOTH_ERROR_NONE;
 
-	const char *path = NULL;
 	DBusGProxy *device_proxy = NULL;
 	GValue trusted = { 0 };
 
@@ -2140,11 +2598,7 @@ BT_EXPORT_API int bluetooth_authorize_device(const bluetooth_device_address_t *d
 
 	_bluetooth_internal_addr_type_to_addr_string(addr, device_address);
 
-	dbus_g_proxy_call(bt_internal_info->adapter_proxy, "FindDevice", NULL,
-			  G_TYPE_STRING, addr, G_TYPE_INVALID,
-			  DBUS_TYPE_G_OBJECT_PATH, &path, G_TYPE_INVALID);
-
-	device_proxy = _bluetooth_internal_find_device_by_path(path);
+	device_proxy = _bluetooth_internal_find_device_by_address(device_address);
 
 	if (device_proxy == NULL) {
 		DBG("No device [%s]\n", addr);
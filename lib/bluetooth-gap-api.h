@@ -36,6 +36,7 @@ extern "C" {
 
 #define BLUETOOTH_CHANGE_STATUS_TIMEOUT	30
 #define BLUETOOTH_BONDING_TIMEOUT		60
+#define BLUETOOTH_DISCOVERY_RSSI_DELTA		5	/* dBm change worth reporting */
 
 typedef struct device_list {
 	char str_address[20];
@@ -48,6 +49,21 @@ typedef struct paired_info {
 	int total_count;
 } paired_info_t;
 
+typedef struct {
+	bluetooth_device_info_t info;
+	int reported_rssi;		/* RSSI of the last delivered report */
+	gboolean reported;		/* Delivered at least once */
+	gboolean dirty;			/* Waiting for the next batch */
+} bt_discovered_device_t;
+
+typedef struct {
+	GHashTable *devices;		/* address string -> bt_discovered_device_t */
+	GPtrArray *order;		/* bt_discovered_device_t in discovery order */
+	GPtrArray *pending;		/* Dirty entries of the next batch */
+	unsigned int interval;		/* Batch cadence in ms, 0 reports at once */
+	guint flush_timer;
+} bt_discovery_aggregator_t;
+
 
 void _bluetooth_internal_enabled_cb(void);
 void _bluetooth_internal_disabled_cb(void);
@@ -61,8 +77,8 @@ void _bluetooth_internal_bonding_created_cb(const char *bond_address,
 void _bluetooth_internal_bonding_removed_cb(const char *bond_address,
 						gpointer user_data);
 void _bluetooth_internal_remote_device_found_cb(const char *address,
-				int rssi, unsigned int remote_class,
-				gboolean paired);
+				const char *name, int rssi,
+				unsigned int remote_class, gboolean paired);
 void _bluetooth_internal_remote_device_name_updated_cb(const char *address,
 							const char *name,
 							int rssi, unsigned int remote_class,
@@ -65,7 +65,7 @@ static hdp_obj_info_t *__bt_hdp_internal_gslist_obj_find_using_fd(int fd);
 static hdp_obj_info_t *__bt_hdp_internal_gslist_obj_find_using_path(const char *obj_channel_path);
 
 /*Global Variables*/
-static DBusConnection *g_hdp_dus_conn;
+static gboolean g_hdp_filter_added;
 
 static GSList *g_app_list = NULL;
 
@@ -255,7 +255,6 @@ static int __bt_hdp_internal_add_filter(void)
 {
 	DBG("+\n");
 	bt_info_t *bt_internal_info = NULL;
-	DBusError dbus_error;
 
 	bt_internal_info = _bluetooth_internal_get_information();
 
@@ -265,30 +264,22 @@ static int __bt_hdp_internal_add_filter(void)
 	}
 
 	/*Single process only one signal registration is required */
-	if (g_hdp_dus_conn) {
-		DBG("g_hdp_dus_conn already exist");
+	if (g_hdp_filter_added) {
+		DBG("hdp filter already exist");
 		goto done;
 	}
 
 	/* Add the filter for HDP client functions */
-	dbus_error_init(&dbus_error);
-
-	g_hdp_dus_conn = dbus_g_connection_get_connection(bt_internal_info->conn);
-
-	dbus_connection_add_filter(g_hdp_dus_conn,
-				__bt_hdp_internal_event_filter, NULL, NULL);
-
-	dbus_bus_add_match(g_hdp_dus_conn,
-			"type='signal',interface=" BLUEZ_HDP_DEVICE_INTERFACE,
-			&dbus_error);
-
-	if (dbus_error_is_set(&dbus_error)) {
+	if (_bluetooth_internal_add_signal_handler(BLUEZ_HDP_DEVICE_INTERFACE,
+					NULL, NULL,
+					__bt_hdp_internal_event_filter,
+					NULL) < 0) {
 		DBG("Fail to add dbus filter signal\n");
-		dbus_error_free(&dbus_error);
-		g_hdp_dus_conn = NULL;
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
+	g_hdp_filter_added = TRUE;
+
 done:
 	DBG("-\n");
 	return BLUETOOTH_ERROR_NONE;
@@ -881,15 +872,16 @@ static void __bt_hdp_internal_remove_filter(void)
 	if (bt_internal_info->conn == NULL)
 		return;
 
-	if (g_hdp_dus_conn == NULL) {
-		DBG("hdp_conn is NULL");
+	if (!g_hdp_filter_added) {
+		DBG("hdp filter is not added");
 		return;
 	}
 
-	dbus_connection_remove_filter(g_hdp_dus_conn,
-					__bt_hdp_internal_event_filter, NULL);
+	_bluetooth_internal_remove_signal_handler(BLUEZ_HDP_DEVICE_INTERFACE,
+					NULL, __bt_hdp_internal_event_filter,
+					NULL);
 
-	g_hdp_dus_conn = NULL;	/*should not unref here, bcz no ++reff */
+	g_hdp_filter_added = FALSE;
 
 	DBG("-\n");
 }
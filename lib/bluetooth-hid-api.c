@@ -27,13 +27,9 @@
 
 #define BLUEZ_INPUT_NAME "org.bluez.Input"
 
-#define DBUS_HID_MATCH_RULE \
-	"type='signal',interface='" BLUEZ_INPUT_NAME"',member='PropertyChanged'"
-
 typedef struct {
 	hid_cb_func_ptr app_cb;
 	DBusGConnection *conn;
-	DBusConnection *sys_conn;
 	DBusGProxy *hid_proxy;
 	void *user_data;
 } bt_hid_info_t;
@@ -207,9 +203,7 @@ BT_EXPORT_API int bluetooth_hid_init(hid_cb_func_ptr callback_ptr,
 {
 	int result = BLUETOOTH_ERROR_NONE;
 	GError *err = NULL;
-	DBusError dbus_error;
 	DBusGConnection *conn = NULL;
-	DBusConnection *sys_conn = NULL;
 
 	DBG("+");
 
@@ -228,23 +222,15 @@ BT_EXPORT_API int bluetooth_hid_init(hid_cb_func_ptr callback_ptr,
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
-	sys_conn = dbus_g_connection_get_connection(conn);
-
-	dbus_connection_add_filter(sys_conn, __hid_event_filter, NULL, NULL);
-
-	dbus_error_init(&dbus_error);
-
-	dbus_bus_add_match(sys_conn, DBUS_HID_MATCH_RULE, &dbus_error);
-
-	if (dbus_error_is_set(&dbus_error)) {
-		DBG("Fail to add dbus filter signal: %s\n", dbus_error.message);
-		dbus_error_free(&dbus_error);
+	if (_bluetooth_internal_add_signal_handler(BLUEZ_INPUT_NAME,
+					"PropertyChanged", NULL,
+					__hid_event_filter, NULL) < 0) {
+		DBG("Fail to add dbus filter signal\n");
 		result = BLUETOOTH_ERROR_INTERNAL;
 		goto failed;
 	}
 
 	bt_hid_info.conn = conn;
-	bt_hid_info.sys_conn = sys_conn;
 	bt_hid_info.app_cb = callback_ptr;
 	bt_hid_info.user_data = user_data;
 
@@ -267,14 +253,9 @@ BT_EXPORT_API int bluetooth_hid_deinit(void)
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
-	if (bt_hid_info.sys_conn) {
-		dbus_connection_remove_filter(bt_hid_info.sys_conn,
-						__hid_event_filter,
-						NULL);
-
-		dbus_bus_remove_match(bt_hid_info.sys_conn,
-					DBUS_HID_MATCH_RULE, NULL);
-	}
+	_bluetooth_internal_remove_signal_handler(BLUEZ_INPUT_NAME,
+					"PropertyChanged",
+					__hid_event_filter, NULL);
 
 	if (bt_hid_info.hid_proxy)
 		g_object_unref(bt_hid_info.hid_proxy);
@@ -282,7 +263,6 @@ BT_EXPORT_API int bluetooth_hid_deinit(void)
 	dbus_g_connection_unref(bt_hid_info.conn);
 
 	bt_hid_info.conn = NULL;
-	bt_hid_info.sys_conn = NULL;
 	bt_hid_info.hid_proxy = NULL;
 	bt_hid_info.app_cb = NULL;
 	bt_hid_info.user_data = NULL;
@@ -227,8 +227,6 @@ BT_EXPORT_API int bluetooth_gatt_get_primary_services(const bluetooth_device_add
 	DBG("+\n");
 	bt_info_t *bt_internal_info = NULL;
 	char device_address[BT_ADDRESS_STRING_SIZE] = { 0 };
-	const char *device_path = NULL;
-	GError *error = NULL;
 	DBusGProxy *device_proxy = NULL;
 	GHashTable *hash = NULL;
 	GValue *value = NULL;
@@ -250,48 +248,32 @@ BT_EXPORT_API int bluetooth_gatt_get_primary_services(const bluetooth_device_add
 	if (!bt_internal_info->adapter_proxy)
 		return BLUETOOTH_ERROR_INTERNAL;
 
-	dbus_g_proxy_call(bt_internal_info->adapter_proxy, "FindDevice", &error,
-		G_TYPE_STRING, device_address, G_TYPE_INVALID,
-		DBUS_TYPE_G_OBJECT_PATH, &device_path, G_TYPE_INVALID);
-	if (error) {
-		ERR("FindDevice Call Error %s[%s]", error->message, device_address);
-		g_error_free(error);
+	/* The proxy is owned by the device registry, it must not be unref'd */
+	device_proxy = _bluetooth_internal_find_device_by_address(address);
+	if (!device_proxy) {
+		ERR("No device [%s]", device_address);
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
-	if (!device_path)
-		return BLUETOOTH_ERROR_INTERNAL;
-
-	device_proxy = _bluetooth_internal_find_device_by_path(device_path);
-	if (!device_proxy)
-		return BLUETOOTH_ERROR_INTERNAL;
-
-	dbus_g_proxy_call(device_proxy, "GetProperties", &error, G_TYPE_INVALID,
-				dbus_g_type_get_map("GHashTable", G_TYPE_STRING, G_TYPE_VALUE),
-				&hash, G_TYPE_INVALID);
-	if (error) {
-		ERR("GetProperties Call Error %s[%s]", error->message, device_address);
-		g_error_free(error);
-		g_object_unref(device_proxy);
+	/* Cached by the registry and refreshed on PropertyChanged("Services") */
+	hash = _bluetooth_internal_get_device_properties(
+				dbus_g_proxy_get_path(device_proxy));
+	if (!hash) {
+		ERR("No properties for [%s]", device_address);
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
-	g_object_unref(device_proxy);
-
-	if (!hash)
-		return BLUETOOTH_ERROR_INTERNAL;
-
 	value = g_hash_table_lookup(hash, "Services");
-	if (!value)
-		return BLUETOOTH_ERROR_INTERNAL;
-
-	gp_array = g_value_get_boxed(value);
-	if (!gp_array)
+	gp_array = value ? g_value_get_boxed(value) : NULL;
+	if (!gp_array) {
+		g_hash_table_unref(hash);
 		return BLUETOOTH_ERROR_INTERNAL;
+	}
 
 	prim_svc->count = gp_array->len;
 	prim_svc->handle = __get_string_array_from_gptr_array(gp_array);
-	g_ptr_array_free(gp_array, TRUE);
+
+	g_hash_table_unref(hash);
 
 	DBG("-\n");
 	return BLUETOOTH_ERROR_NONE;
@@ -39,6 +39,8 @@ static void __bluetooth_network_server_disconnected(DBusGProxy *proxy, const cha
 static DBusHandlerResult __bluetooth_network_event_filter(DBusConnection *sys_conn,
 							DBusMessage *msg, void *data);
 
+static gboolean is_network_filter_added = FALSE;
+
 /**********************************************************************
 *                                      Network server APIs (NAP)      *
 ***********************************************************************/
@@ -483,35 +485,28 @@ void _bluetooth_network_client_add_filter(void)
 	DBG("+\n");
 
 	bt_info_t *bt_internal_info = NULL;
-	DBusError dbus_error;
 
 	bt_internal_info = _bluetooth_internal_get_information();
 
 	if (bt_internal_info->conn == NULL)
 		return;
 
-	if (bt_internal_info->sys_conn) {
-		DBG("sys_conn already exist");
+	if (is_network_filter_added) {
+		DBG("network filter already exist");
 		return;
 	}
 
 	/* Add the filter for network client functions */
-	dbus_error_init(&dbus_error);
-
-	bt_internal_info->sys_conn = dbus_g_connection_get_connection(bt_internal_info->conn);
-
-	dbus_connection_add_filter(bt_internal_info->sys_conn, __bluetooth_network_event_filter,
-					NULL, NULL);
-
-	dbus_bus_add_match(bt_internal_info->sys_conn,
-			   "type='signal',interface='" BLUEZ_NET_CLIENT_PATH
-			   "',member='PropertyChanged'", &dbus_error);
-
-	if (dbus_error_is_set(&dbus_error)) {
+	if (_bluetooth_internal_add_signal_handler(BLUEZ_NET_CLIENT_PATH,
+					"PropertyChanged", NULL,
+					__bluetooth_network_event_filter,
+					NULL) < 0) {
 		DBG("Fail to add dbus filter signal\n");
-		dbus_error_free(&dbus_error);
+		return;
 	}
 
+	is_network_filter_added = TRUE;
+
 	DBG("-\n");
 }
 
@@ -519,23 +514,16 @@ void _bluetooth_network_client_remove_filter(void)
 {
 	DBG("+\n");
 
-	bt_info_t *bt_internal_info = NULL;
-	DBusError dbus_error;
-
-	bt_internal_info = _bluetooth_internal_get_information();
-
-	if (bt_internal_info->sys_conn == NULL) {
-		DBG("sys_conn is NULL");
+	if (!is_network_filter_added) {
+		DBG("network filter is not added");
 		return;
 	}
 
-	/* Add the filter for network client functions */
-	dbus_error_init(&dbus_error);
-
-	dbus_connection_remove_filter(bt_internal_info->sys_conn, __bluetooth_network_event_filter,
-				      NULL);
+	_bluetooth_internal_remove_signal_handler(BLUEZ_NET_CLIENT_PATH,
+					"PropertyChanged",
+					__bluetooth_network_event_filter, NULL);
 
-	bt_internal_info->sys_conn = NULL;
+	is_network_filter_added = FALSE;
 
 	DBG("-\n");
 }
@@ -176,48 +176,25 @@ static int __register_agent_authorize_signal(
 {
 	DBG("+");
 
-	DBusGConnection *conn = NULL;
-	DBusConnection *dbus_connection = NULL;
-	DBusError dbus_error;
-
-	conn = dbus_g_bus_get(DBUS_BUS_SYSTEM, NULL);
-
-	if (conn == NULL) {
-		DBG("conn is NULL\n");
-		return BLUETOOTH_ERROR_NO_RESOURCES;
-	}
-
-	dbus_connection = dbus_g_connection_get_connection(conn);
-
 	/* Add the filter for authorize functions */
-	dbus_error_init(&dbus_error);
-	dbus_connection_add_filter(dbus_connection,
-				__obex_authorize_event_filter,
-				NULL, NULL);
-
-	dbus_bus_add_match(dbus_connection,
-			   "type=signal,interface=" BT_AGENT_INTERFACE
-			   ",member=ObexAuthorize", &dbus_error);
-	if (dbus_error_is_set(&dbus_error)) {
-		ERR("Fail to add dbus filter signal\n");
-		dbus_error_free(&dbus_error);
-		dbus_connection_remove_filter(dbus_connection,
+	if (_bluetooth_internal_add_signal_handler(BT_AGENT_INTERFACE,
+					BT_AGENT_SIGNAL_OBEX_AUTHORIZE, NULL,
 					__obex_authorize_event_filter,
-					NULL);
-		dbus_g_connection_unref(conn);
+					NULL) < 0) {
+		ERR("Fail to add dbus filter signal\n");
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
 	if (vconf_set_int(BT_MEMORY_OBEX_NO_AGENT, 1) != 0) {
 		DBG("Set vconf failed");
-		dbus_connection_remove_filter(dbus_connection,
+		_bluetooth_internal_remove_signal_handler(BT_AGENT_INTERFACE,
+					BT_AGENT_SIGNAL_OBEX_AUTHORIZE,
 					__obex_authorize_event_filter,
 					NULL);
-		dbus_g_connection_unref(conn);
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
-	obex_server_info->system_bus = conn;
+	obex_server_info->is_authorize_signal = TRUE;
 
 	DBG("-");
 	return BLUETOOTH_ERROR_NONE;
@@ -229,27 +206,22 @@ static void __unregister_agent_authorize_signal(
 {
 	DBG("+");
 
-	DBusConnection *dbus_connection = NULL;
-
 	if (obex_server_info == NULL) {
 		DBG("info is NULL");
 		return;
 	}
 
-	if (obex_server_info->system_bus == NULL) {
-		DBG("connection is NULL");
+	if (!obex_server_info->is_authorize_signal) {
+		DBG("signal is not registered");
 		return;
 	}
 
-	dbus_connection = dbus_g_connection_get_connection(
-					obex_server_info->system_bus);
-
-	dbus_connection_remove_filter(dbus_connection,
+	_bluetooth_internal_remove_signal_handler(BT_AGENT_INTERFACE,
+				BT_AGENT_SIGNAL_OBEX_AUTHORIZE,
 				__obex_authorize_event_filter,
 				NULL);
 
-	dbus_g_connection_unref(obex_server_info->system_bus);
-	obex_server_info->system_bus = NULL;
+	obex_server_info->is_authorize_signal = FALSE;
 
 	if (vconf_set_int(BT_MEMORY_OBEX_NO_AGENT, 0) != 0)
 		DBG("Set vconf failed");
@@ -900,12 +872,11 @@ BT_EXPORT_API int bluetooth_obex_server_cancel_all_transfers(void)
 
 static char *__bt_get_remote_device_name(const char *bdaddress)
 {
-	GError *error = NULL;
-	char *device_path = NULL;
 	char *name = NULL;
 	GHashTable *hash = NULL;
 	GValue *value;
 	DBusGProxy *device_proxy = NULL;
+	bluetooth_device_address_t device_addr = { {0} };
 	bt_info_t *bt_internal_info = NULL;
 
 	DBG("+\n");
@@ -918,33 +889,20 @@ static char *__bt_get_remote_device_name(const char *bdaddress)
 	if (bt_internal_info->adapter_proxy == NULL)
 		return NULL;
 
-	dbus_g_proxy_call(bt_internal_info->adapter_proxy, "FindDevice", &error,
-			  G_TYPE_STRING, bdaddress, G_TYPE_INVALID,
-			  DBUS_TYPE_G_OBJECT_PATH, &device_path, G_TYPE_INVALID);
-
-	if (error != NULL) {
-		DBG("Error occured in FindDevice Proxy call [%s]\n", error->message);
-		g_error_free(error);
-		return NULL;
-	}
+	_bluetooth_internal_convert_addr_string_to_addr_type(&device_addr, bdaddress);
 
-	device_proxy = _bluetooth_internal_find_device_by_path(device_path);
+	device_proxy = _bluetooth_internal_find_device_by_address(&device_addr);
 
 	if (!device_proxy)
 		return NULL;
 
-	if (!dbus_g_proxy_call(device_proxy, "GetProperties", &error,
-			G_TYPE_INVALID,
-			dbus_g_type_get_map("GHashTable", G_TYPE_STRING, G_TYPE_VALUE),
-			&hash, G_TYPE_INVALID)) {
-		DBG( "error in GetBasicProperties [%s]\n", error->message);
-		g_error_free(error);
-		return NULL;
-	}
+	hash = _bluetooth_internal_get_device_properties(
+				dbus_g_proxy_get_path(device_proxy));
 
 	if (hash != NULL) {
 		value = g_hash_table_lookup(hash, "Name");
 		name = value ? g_value_dup_string(value) : NULL;
+		g_hash_table_unref(hash);
 	}
 
        DBG("-");
@@ -54,7 +54,7 @@ typedef enum {
 
 typedef struct {
 	DBusGConnection *bus;
-	DBusGConnection *system_bus;
+	gboolean is_authorize_signal;
 	void *obex_server_agent;
 	DBusGProxy *obex_proxy;
 	DBusGMethodInvocation *reply_context;
@@ -34,6 +34,7 @@
 #include <fcntl.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <poll.h>
 #include <errno.h>
 #include <vconf.h>
 
@@ -46,6 +47,8 @@
 #define BLUEZ_SERIAL_PROXY_INTERFACE	"org.bluez.SerialProxy"
 
 #define RFCOMM_CLIENT_BUFFER_SIZE 1024
+#define RFCOMM_WRITE_TIMEOUT 2000 /* 2 seconds */
+#define RFCOMM_RX_MAX_BUFFERS 1024 /* IOV_MAX */
 #define RFCOMM_UDS_PATH "/bluez/rfcomm"
 #define RFCOMM_DEV_PATH "/dev/rfcomm"
 #define RFCOMM_SER_DEV_PATH "x00/bluez/rfcomm"
@@ -57,6 +60,13 @@ int connected_fd;
 int requested_server_fd;
 static DBusConnection *connection = NULL;
 
+/* Connection registry: fd indexed table plus uuid and device address hashes */
+static GPtrArray *rfcomm_fd_table = NULL;
+static GHashTable *rfcomm_uuid_hash = NULL;
+static GHashTable *rfcomm_addr_hash = NULL;
+static int rfcomm_client_count = 0;
+static guint rfcomm_rx_mode_serial = 0;
+
 static gboolean __rfcomm_server_connected_cb(GIOChannel *chan, GIOCondition cond, gpointer data);
 static gboolean __rfcomm_server_data_received_cb(GIOChannel *chan, GIOCondition cond, gpointer data);
 
@@ -66,17 +76,11 @@ static int __get_default_adapter_path(char **adapter_path);
 
 static int __get_rfcomm_proxy_list(char ***proxy_list, int *len);
 
-static int __bluetooth_rfcomm_internal_disconnect(int index);
+static int __bluetooth_rfcomm_internal_disconnect(rfcomm_client_t *client);
 
 static int __rfcomm_internal_terminate_server(rfcomm_server_t *server_info);
 
-static int __rfcomm_internal_terminate_client(int index);
-
-static int __bluetooth_rfcomm_internal_server_get_free_index(void);
-
-static int __bluetooth_rfcomm_internal_server_get_index_from_socket(int fd);
-
-static int __bluetooth_rfcomm_internal_client_get_index_from_socket(int fd);
+static int __rfcomm_internal_terminate_client(rfcomm_client_t *client);
 
 static void __rfcomm_client_connected_cb(DBusGProxy *proxy, DBusGProxyCall *call,
 				       gpointer user_data);
@@ -85,76 +89,224 @@ static int __bluetooth_internal_set_non_blocking(int sk);
 
 static int __bluetooth_internal_set_non_blocking_tty(int sk);
 
+static void __rfcomm_internal_release_io(int fd);
+
+static int __rfcomm_rx_coalesced_read(rfcomm_rx_mode_t *rx);
+
+static rfcomm_rx_mode_t *__rfcomm_rx_mode_get(int fd);
+
 /* To support the BOT  */
-static void __unregister_agent_authorize_signal(DBusGConnection *conn, void *user_data);
+static void __unregister_agent_authorize_signal(void *user_data);
 
-/*Get the free index channel for server */
-static int __bluetooth_rfcomm_internal_server_get_free_index(void)
+static rfcomm_fd_entry_t *__rfcomm_fd_entry_get(int fd, gboolean create)
 {
+	rfcomm_fd_entry_t *entry;
 
-	DBG("+ + + + + + + + \n");
-	int ind = -1;
-	int i = 0;
-	for (; i < RFCOMM_MAX_CONN; i++) {
-		if (rfcomm_server[i].id == 0) {
-			ind = i;
-			break;
-		}
+	if (fd < 0)
+		return NULL;
+
+	if (rfcomm_fd_table == NULL) {
+		if (!create)
+			return NULL;
+
+		rfcomm_fd_table = g_ptr_array_sized_new(RFCOMM_FD_TABLE_SIZE);
 	}
-	DBG("Free index: %d\n", ind);
-	DBG("- - - - - - - - -\n");
-	return ind;
+
+	if (fd >= rfcomm_fd_table->len) {
+		if (!create)
+			return NULL;
+
+		g_ptr_array_set_size(rfcomm_fd_table,
+				MAX(fd + 1, MAX(rfcomm_fd_table->len * 2,
+						RFCOMM_FD_TABLE_SIZE)));
+	}
+
+	entry = g_ptr_array_index(rfcomm_fd_table, fd);
+	if (entry == NULL && create) {
+		entry = g_malloc0(sizeof(rfcomm_fd_entry_t));
+		g_ptr_array_index(rfcomm_fd_table, fd) = entry;
+	}
+
+	return entry;
 }
 
-/*Get the index channel from server socket */
-static int __bluetooth_rfcomm_internal_server_get_index_from_client_socket(int client_fd)
+/* Free the table slot once nothing refers to the fd */
+static void __rfcomm_fd_entry_release(int fd)
 {
-	int ind = -1;
-	int i = 0;
-	for (; i < RFCOMM_MAX_CONN; i++) {
-		if (rfcomm_server[i].client_sock_fd == client_fd) {
-			ind = i;
-			break;
-		}
-	}
-	DBG("Index from fd %d is index(%d)\n", client_fd, ind);
-	return ind;
+	rfcomm_fd_entry_t *entry = __rfcomm_fd_entry_get(fd, FALSE);
+
+	if (entry == NULL)
+		return;
+
+	if (entry->server || entry->client || entry->tx || entry->rx)
+		return;
+
+	g_ptr_array_index(rfcomm_fd_table, fd) = NULL;
+	g_free(entry);
+}
+
+static void __rfcomm_addr_index_add(const bluetooth_device_address_t *addr, int fd)
+{
+	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
+	GSList *fds;
+
+	if (rfcomm_addr_hash == NULL)
+		rfcomm_addr_hash = g_hash_table_new_full(g_str_hash, g_str_equal,
+						g_free, NULL);
+
+	_bluetooth_internal_addr_type_to_addr_string(address, addr);
+
+	fds = g_hash_table_lookup(rfcomm_addr_hash, address);
+	fds = g_slist_prepend(fds, GINT_TO_POINTER(fd));
+	g_hash_table_replace(rfcomm_addr_hash, g_strdup(address), fds);
 }
 
+static void __rfcomm_addr_index_remove(const bluetooth_device_address_t *addr, int fd)
+{
+	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
+	GSList *fds;
+
+	if (rfcomm_addr_hash == NULL)
+		return;
+
+	_bluetooth_internal_addr_type_to_addr_string(address, addr);
 
-/*Get the index channel from server socket */
-static int __bluetooth_rfcomm_internal_server_get_index_from_socket(int fd)
+	fds = g_hash_table_lookup(rfcomm_addr_hash, address);
+	fds = g_slist_remove(fds, GINT_TO_POINTER(fd));
+
+	if (fds == NULL)
+		g_hash_table_remove(rfcomm_addr_hash, address);
+	else
+		g_hash_table_replace(rfcomm_addr_hash, g_strdup(address), fds);
+}
+
+/*Register the connected socket of a server or a client */
+static void __rfcomm_register_socket(int fd, rfcomm_server_t *server,
+					rfcomm_client_t *client)
 {
-	DBG("+ + + + + + + + \n");
-	int ind = -1;
-	int i = 0;
-	for (; i < RFCOMM_MAX_CONN; i++) {
-		if (rfcomm_server[i].server_sock_fd == fd) {
-			ind = i;
-			break;
-		}
+	rfcomm_fd_entry_t *entry = __rfcomm_fd_entry_get(fd, TRUE);
+
+	entry->server = server;
+	entry->client = client;
+
+	/* The address of an accepted connection is known after GetInfo */
+	if (client != NULL) {
+		rfcomm_client_count++;
+		__rfcomm_addr_index_add(&client->device_addr, fd);
 	}
-	DBG("Index from fd %d is index(%d)\n", fd, ind);
-	DBG("- - - - - - - - -\n");
-	return ind;
+
+	DBG("Registered fd %d (%s)\n", fd, client ? "client" : "server");
 }
 
-/*Get the  index channel from client socket */
-static int __bluetooth_rfcomm_internal_client_get_index_from_socket(int fd)
+static void __rfcomm_unregister_socket(int fd)
 {
-	DBG("+ + + + + + + + \n");
-	int ind = -1;
-	int i = 0;
-	for (; i < RFCOMM_MAX_CONN; i++) {
-		if (rfcomm_client[i].sock_fd == fd) {
-			ind = rfcomm_client[i].id;
-			break;
-		}
+	rfcomm_fd_entry_t *entry = __rfcomm_fd_entry_get(fd, FALSE);
+
+	if (entry == NULL)
+		return;
+
+	if (entry->client != NULL) {
+		rfcomm_client_count--;
+		__rfcomm_addr_index_remove(&entry->client->device_addr, fd);
+	} else if (entry->server != NULL && entry->server->client_sock_fd == fd) {
+		__rfcomm_addr_index_remove(&entry->server->device_addr, fd);
 	}
 
-	DBG("Index from fd %d is index(%d)\n", fd, ind);
-	DBG("- - - - - - - - -\n");
-	return ind;
+	entry->server = NULL;
+	entry->client = NULL;
+
+	__rfcomm_fd_entry_release(fd);
+}
+
+static void __rfcomm_register_server(rfcomm_server_t *server)
+{
+	rfcomm_fd_entry_t *entry = __rfcomm_fd_entry_get(server->server_sock_fd, TRUE);
+
+	entry->server = server;
+
+	if (rfcomm_uuid_hash == NULL)
+		rfcomm_uuid_hash = g_hash_table_new(g_str_hash, g_str_equal);
+
+	g_hash_table_replace(rfcomm_uuid_hash, server->uuid, server);
+}
+
+static void __rfcomm_unregister_server(rfcomm_server_t *server)
+{
+	rfcomm_fd_entry_t *entry = __rfcomm_fd_entry_get(server->server_sock_fd, FALSE);
+
+	if (entry != NULL && entry->server == server) {
+		entry->server = NULL;
+		__rfcomm_fd_entry_release(server->server_sock_fd);
+	}
+
+	if (rfcomm_uuid_hash != NULL && server->uuid != NULL &&
+	    g_hash_table_lookup(rfcomm_uuid_hash, server->uuid) == server)
+		g_hash_table_remove(rfcomm_uuid_hash, server->uuid);
+}
+
+static void __rfcomm_server_free(rfcomm_server_t *server)
+{
+	__rfcomm_unregister_server(server);
+
+	g_free(server->uds_name);
+	g_free(server->uuid);
+	g_free(server);
+}
+
+/*Get the server from its listening socket */
+static rfcomm_server_t *__rfcomm_get_server_by_socket(int fd)
+{
+	rfcomm_fd_entry_t *entry = __rfcomm_fd_entry_get(fd, FALSE);
+
+	if (entry == NULL || entry->server == NULL ||
+	    entry->server->server_sock_fd != fd)
+		return NULL;
+
+	return entry->server;
+}
+
+/*Get the server from the socket of its accepted connection */
+static rfcomm_server_t *__rfcomm_get_server_by_client_socket(int client_fd)
+{
+	rfcomm_fd_entry_t *entry = __rfcomm_fd_entry_get(client_fd, FALSE);
+
+	if (entry == NULL || entry->server == NULL ||
+	    entry->server->client_sock_fd != client_fd)
+		return NULL;
+
+	return entry->server;
+}
+
+/*Get the client from its device node socket */
+static rfcomm_client_t *__rfcomm_get_client_by_socket(int fd)
+{
+	rfcomm_fd_entry_t *entry = __rfcomm_fd_entry_get(fd, FALSE);
+
+	if (entry == NULL)
+		return NULL;
+
+	return entry->client;
+}
+
+static rfcomm_server_t *__rfcomm_get_server_by_uuid(const char *uuid)
+{
+	if (rfcomm_uuid_hash == NULL || uuid == NULL)
+		return NULL;
+
+	return g_hash_table_lookup(rfcomm_uuid_hash, uuid);
+}
+
+/*Get the connected sockets of a remote device, most recent first */
+static GSList *__rfcomm_get_sockets_by_address(const bluetooth_device_address_t *addr)
+{
+	char address[BT_ADDRESS_STRING_SIZE] = { 0 };
+
+	if (rfcomm_addr_hash == NULL)
+		return NULL;
+
+	_bluetooth_internal_addr_type_to_addr_string(address, addr);
+
+	return g_hash_table_lookup(rfcomm_addr_hash, address);
 }
 
 /*Internal server disconnection */
@@ -165,21 +317,20 @@ static int __rfcomm_internal_terminate_server(rfcomm_server_t *server_info)
 	DBusError error;
 	static char *default_adapter_obj_path = NULL;
 	bluetooth_rfcomm_disconnection_t disconnection_ind;
+	rfcomm_server_t *server;
 
-	int index;
-
-	index = __bluetooth_rfcomm_internal_server_get_index_from_socket(server_info->server_sock_fd);
-	if (index < 0) {
-		DBG("Invalid index %d", index);
+	server = __rfcomm_get_server_by_socket(server_info->server_sock_fd);
+	if (server == NULL) {
+		DBG("Invalid server socket %d", server_info->server_sock_fd);
 		return BLUETOOTH_ERROR_INVALID_PARAM;
 	}
 
-	if (rfcomm_server[index].client_sock_fd != -1) {
+	if (server->client_sock_fd != -1) {
 		DBG("Trying for Proxy disable\n");
-		DBG("Proxy disable for %s\n", rfcomm_server[index].uds_name);
+		DBG("Proxy disable for %s\n", server->uds_name);
 		/* Proxy Disable  Part */
 		msg = dbus_message_new_method_call(BLUEZ_SERVICE_NAME,
-						   rfcomm_server[index].uds_name,
+						   server->uds_name,
 						   BLUEZ_SERIAL_PROXY_INTERFACE, "Disable");
 		if (msg == NULL) {
 			DBG("dbus method call is not allocated.");
@@ -219,7 +370,7 @@ static int __rfcomm_internal_terminate_server(rfcomm_server_t *server_info)
 			return -1;
 		}
 
-		dbus_message_append_args(msg, DBUS_TYPE_STRING, &rfcomm_server[index].uds_name,
+		dbus_message_append_args(msg, DBUS_TYPE_STRING, &server->uds_name,
 					 DBUS_TYPE_INVALID);
 
 		reply = dbus_connection_send_with_reply_and_block(connection, msg, -1, &error);
@@ -236,9 +387,9 @@ static int __rfcomm_internal_terminate_server(rfcomm_server_t *server_info)
 
 		dbus_message_unref(reply);
 
-		disconnection_ind.socket_fd = rfcomm_server[index].client_sock_fd;
-		disconnection_ind.device_addr = rfcomm_server[index].device_addr;
-		disconnection_ind.uuid = g_strdup(rfcomm_server[index].uuid);
+		disconnection_ind.socket_fd = server->client_sock_fd;
+		disconnection_ind.device_addr = server->device_addr;
+		disconnection_ind.uuid = g_strdup(server->uuid);
 		disconnection_ind.device_role = RFCOMM_ROLE_SERVER;
 
 		_bluetooth_internal_event_cb(BLUETOOTH_EVENT_RFCOMM_DISCONNECTED,
@@ -246,41 +397,39 @@ static int __rfcomm_internal_terminate_server(rfcomm_server_t *server_info)
 
 		g_free(disconnection_ind.uuid);
 
-		if (rfcomm_server[index].client_sock_fd != -1) {
-			g_source_remove(rfcomm_server[index].client_event_src_id);
-			rfcomm_server[index].client_sock_fd = -1;
+		if (server->client_sock_fd != -1) {
+			g_source_remove(server->client_event_src_id);
+			__rfcomm_internal_release_io(server->client_sock_fd);
+			server->client_sock_fd = -1;
 		}
 
 	}
 
 	DBG(" g_source_remove \n");
-	if (rfcomm_server[index].is_listen)
-		g_source_remove(rfcomm_server[index].server_event_src_id);
-
-	if (rfcomm_server[index].sys_conn) {
-		__unregister_agent_authorize_signal(
-					rfcomm_server[index].sys_conn,
-					&rfcomm_server[index].server_sock_fd);
+	if (server->is_listen)
+		g_source_remove(server->server_event_src_id);
 
-		dbus_g_connection_unref(rfcomm_server[index].sys_conn);
-		rfcomm_server[index].sys_conn = NULL;
+	if (server->is_authorize_signal) {
+		__unregister_agent_authorize_signal(&server->server_sock_fd);
+		server->is_authorize_signal = FALSE;
 	}
 
-	close(rfcomm_server[index].server_sock_fd);
-	rfcomm_server[index].server_sock_fd = -1;
-	rfcomm_server[index].is_listen = FALSE;
+	__rfcomm_unregister_server(server);
+
+	close(server->server_sock_fd);
+	server->server_sock_fd = -1;
+	server->is_listen = FALSE;
 
 	/*Resetting the connection */
-	rfcomm_server[index].id = 0;
+	__rfcomm_server_free(server);
 
-	/*Check free rfcomm_server[index].uds_name */
 	DBG("-\n");
 	return BLUETOOTH_ERROR_NONE;
 
 }
 
 /*Internal client disconnection*/
-static int __rfcomm_internal_terminate_client(int index)
+static int __rfcomm_internal_terminate_client(rfcomm_client_t *client)
 {
 	DBG("+\n");
 	bluetooth_rfcomm_disconnection_t disconnection_ind;
@@ -288,25 +437,26 @@ static int __rfcomm_internal_terminate_client(int index)
 	memset(&disconnection_ind, 0x00,
 				sizeof(bluetooth_rfcomm_disconnection_t));
 
-	__bluetooth_rfcomm_internal_disconnect(index);
+	__bluetooth_rfcomm_internal_disconnect(client);
 
-	disconnection_ind.socket_fd = rfcomm_client[index].sock_fd;
-	disconnection_ind.device_addr = rfcomm_client[index].device_addr;
+	disconnection_ind.socket_fd = client->sock_fd;
+	disconnection_ind.device_addr = client->device_addr;
 	disconnection_ind.device_role = RFCOMM_ROLE_CLIENT;
 
 	_bluetooth_internal_event_cb(BLUETOOTH_EVENT_RFCOMM_DISCONNECTED,
 					BLUETOOTH_ERROR_NONE, &disconnection_ind);
 
-	g_source_remove(rfcomm_client[index].event_src_id);
-	rfcomm_client[index].event_src_id = -1;
+	g_source_remove(client->event_src_id);
+	client->event_src_id = -1;
 
-	close(rfcomm_client[index].sock_fd);
-	rfcomm_client[index].sock_fd = -1;
-	if (rfcomm_client[index].dev_node_name != NULL)
-		g_free(rfcomm_client[index].dev_node_name);
-	rfcomm_client[index].dev_node_name = NULL;
+	__rfcomm_internal_release_io(client->sock_fd);
+	close(client->sock_fd);
+	client->sock_fd = -1;
+	if (client->dev_node_name != NULL)
+		g_free(client->dev_node_name);
+	client->dev_node_name = NULL;
 
-	rfcomm_client[index].id = -1;
+	g_free(client);
 	DBG("-\n");
 	return BLUETOOTH_ERROR_NONE;
 }
@@ -324,10 +474,10 @@ static gboolean __rfcomm_server_connected_cb(GIOChannel *chan, GIOCondition cond
 
 	rfcomm_server_t *server_data = data;
 	int fd = g_io_channel_unix_get_fd(chan);
-	int index = __bluetooth_rfcomm_internal_server_get_index_from_socket(fd);
-	if (index < 0) {
-		ERR("Invalid index %d", index);
-		return BLUETOOTH_ERROR_INVALID_PARAM;
+	rfcomm_server_t *server = __rfcomm_get_server_by_socket(fd);
+	if (server == NULL) {
+		ERR("Invalid server socket %d", fd);
+		return FALSE;
 	}
 	int server_sock, client_sock;
 	int client_addr_len;
@@ -363,26 +513,27 @@ static gboolean __rfcomm_server_connected_cb(GIOChannel *chan, GIOCondition cond
 		DBG("Warning!!Setting the tty properties failed(%d)\n", client_sock);
 	}
 
-	rfcomm_server[index].client_sock_fd = client_sock;
+	server->client_sock_fd = client_sock;
+	__rfcomm_register_socket(client_sock, server, NULL);
 
-	rfcomm_server[index].client_io_channel = g_io_channel_unix_new(client_sock);
+	server->client_io_channel = g_io_channel_unix_new(client_sock);
 
-	g_io_channel_set_encoding(rfcomm_server[index].client_io_channel, NULL, NULL);
-	g_io_channel_set_flags(rfcomm_server[index].client_io_channel,
+	g_io_channel_set_encoding(server->client_io_channel, NULL, NULL);
+	g_io_channel_set_flags(server->client_io_channel,
 				G_IO_FLAG_NONBLOCK, NULL);
 
-	g_io_channel_set_close_on_unref(rfcomm_server[index].client_io_channel, TRUE);
+	g_io_channel_set_close_on_unref(server->client_io_channel, TRUE);
 
-	rfcomm_server[index].client_event_src_id =
-	    g_io_add_watch(rfcomm_server[index].client_io_channel,
+	server->client_event_src_id =
+	    g_io_add_watch(server->client_io_channel,
 			   G_IO_IN | G_IO_HUP | G_IO_ERR | G_IO_NVAL,
-			   __rfcomm_server_data_received_cb, &rfcomm_server[index]);
+			   __rfcomm_server_data_received_cb, server);
 
-	g_io_channel_unref(rfcomm_server[index].client_io_channel);
+	g_io_channel_unref(server->client_io_channel);
 
 	/* GetInfo Proxy Part */
 	msg = dbus_message_new_method_call(BLUEZ_SERVICE_NAME,
-					   rfcomm_server[index].uds_name,
+					   server->uds_name,
 					   BLUEZ_SERIAL_PROXY_INTERFACE, "GetInfo");
 
 	if (msg == NULL) {
@@ -487,7 +638,7 @@ static gboolean __rfcomm_server_connected_cb(GIOChannel *chan, GIOCondition cond
 
 				DBG("String received >>> = %s\n", property);
 				_bluetooth_internal_convert_addr_string_to_addr_type(
-						&rfcomm_server[index].device_addr, property);
+						&server->device_addr, property);
 
 			}
 
@@ -498,14 +649,16 @@ static gboolean __rfcomm_server_connected_cb(GIOChannel *chan, GIOCondition cond
 
 	dbus_message_unref(reply);
 
+	__rfcomm_addr_index_add(&server->device_addr, server->client_sock_fd);
+
 	bluetooth_rfcomm_connection_t con_ind;
 	con_ind.device_role = RFCOMM_ROLE_SERVER;
-	con_ind.device_addr = rfcomm_server[index].device_addr;
-	con_ind.socket_fd = rfcomm_server[index].client_sock_fd;
-	con_ind.uuid = g_strdup(rfcomm_server[index].uuid);
+	con_ind.device_addr = server->device_addr;
+	con_ind.socket_fd = server->client_sock_fd;
+	con_ind.uuid = g_strdup(server->uuid);
 
 	/* Unblock the connection accept function */
-	connected_fd = rfcomm_server[index].client_sock_fd;
+	connected_fd = server->client_sock_fd;
 	rfcomm_connected = TRUE;
 
 	_bluetooth_internal_event_cb(BLUETOOTH_EVENT_RFCOMM_CONNECTED,
@@ -525,10 +678,12 @@ static gboolean __rfcomm_server_data_received_cb(GIOChannel *chan, GIOCondition
 {
 	DBG("rfcomm_server.client_io_channel has %d \n", cond);
 
-	char buf[RFCOMM_CLIENT_BUFFER_SIZE] = { 0 };
+	char buf[RFCOMM_CLIENT_BUFFER_SIZE];
 	unsigned int len;
 	rfcomm_server_t *rfcomm_server_info = data;
 	bluetooth_rfcomm_received_data_t rx_data;
+	rfcomm_rx_mode_t *rx;
+	int ret;
 
 	if (cond & (G_IO_NVAL | G_IO_HUP | G_IO_ERR)) {
 		DBG("Unix server  disconnected (fd=%d)\n", rfcomm_server_info->client_sock_fd);
@@ -536,7 +691,16 @@ static gboolean __rfcomm_server_data_received_cb(GIOChannel *chan, GIOCondition
 		return FALSE;
 	}
 
-	memset(buf, 0, sizeof(buf));
+	rx = __rfcomm_rx_mode_get(rfcomm_server_info->client_sock_fd);
+	if (rx != NULL) {
+		ret = __rfcomm_rx_coalesced_read(rx);
+		if (ret < 0) {
+			bluetooth_rfcomm_server_disconnect(rfcomm_server_info->client_sock_fd);
+			return FALSE;
+		}
+
+		return TRUE;
+	}
 
 	if (g_io_channel_read_chars(chan, buf, sizeof(buf), &len, NULL) == G_IO_STATUS_ERROR) {
 
@@ -552,7 +716,7 @@ static gboolean __rfcomm_server_data_received_cb(GIOChannel *chan, GIOCondition
 		return FALSE;
 	}
 
-	DBG("%s\n", buf);
+	DBG("Received %d bytes (fd=%d)\n", len, rfcomm_server_info->client_sock_fd);
 
 	rx_data.socket_fd = rfcomm_server_info->client_sock_fd;
 	rx_data.buffer_size = len;
@@ -568,38 +732,45 @@ static gboolean __rfcomm_client_data_received_cb(GIOChannel *chan, GIOCondition
 {
 	DBG("rfcomm_server.client_io_channel has %d \n", cond);
 
-	char buf[RFCOMM_CLIENT_BUFFER_SIZE] = { 0 };
+	char buf[RFCOMM_CLIENT_BUFFER_SIZE];
 	unsigned int len;
 	rfcomm_client_t *rfcomm_client_info = data;
 	bluetooth_rfcomm_received_data_t rx_data;
-
-	int index = rfcomm_client_info->id;
-	if ((index < 0) || (index >= RFCOMM_MAX_CONN)) {
-		DBG("Invalid index %d ", index);
-		return FALSE;
-	}
+	rfcomm_rx_mode_t *rx;
+	int ret;
 
 	if (cond & (G_IO_NVAL | G_IO_HUP | G_IO_ERR)) {
 		DBG("Unix client disconnected (fd=%d)\n", rfcomm_client_info->sock_fd);
-		__rfcomm_internal_terminate_client(index);
+		__rfcomm_internal_terminate_client(rfcomm_client_info);
 		return FALSE;
 	}
 
+	rx = __rfcomm_rx_mode_get(rfcomm_client_info->sock_fd);
+	if (rx != NULL) {
+		ret = __rfcomm_rx_coalesced_read(rx);
+		if (ret < 0) {
+			__rfcomm_internal_terminate_client(rfcomm_client_info);
+			return FALSE;
+		}
+
+		return TRUE;
+	}
+
 	if (g_io_channel_read_chars(chan, buf, sizeof(buf), &len, NULL) == G_IO_STATUS_ERROR) {
 
 		DBG("IO Channel read error client");
-		__rfcomm_internal_terminate_client(index);
+		__rfcomm_internal_terminate_client(rfcomm_client_info);
 		return FALSE;
 	}
 
 	if (len <= 0) {
 		DBG("Read failed len=%d, Clientfd=%d\n",
 			len, rfcomm_client_info->sock_fd);
-		__rfcomm_internal_terminate_client(index);
+		__rfcomm_internal_terminate_client(rfcomm_client_info);
 		return FALSE;
 	}
 
-	DBG("%s  -  clientfd = %d\n", buf, rfcomm_client_info->sock_fd);
+	DBG("Received %d bytes - clientfd = %d\n", len, rfcomm_client_info->sock_fd);
 	rx_data.socket_fd = rfcomm_client_info->sock_fd;
 	rx_data.buffer_size = len;
 	rx_data.buffer = buf;
@@ -610,11 +781,241 @@ static gboolean __rfcomm_client_data_received_cb(GIOChannel *chan, GIOCondition
 	return TRUE;
 }
 
+static void __rfcomm_rx_mode_free(gpointer data)
+{
+	rfcomm_rx_mode_t *rx = data;
+
+	if (rx == NULL)
+		return;
+
+	g_free(rx->iov);
+	g_free(rx->scratch);
+	g_free(rx->filled);
+	g_free(rx->buffer);
+	g_free(rx);
+}
+
+static rfcomm_rx_mode_t *__rfcomm_rx_mode_get(int fd)
+{
+	rfcomm_fd_entry_t *entry = __rfcomm_fd_entry_get(fd, FALSE);
+
+	if (entry == NULL)
+		return NULL;
+
+	return entry->rx;
+}
+
+static void __rfcomm_rx_mode_set(int fd, rfcomm_rx_mode_t *rx)
+{
+	rfcomm_fd_entry_t *entry = __rfcomm_fd_entry_get(fd, rx != NULL);
+
+	if (entry == NULL)
+		return;
+
+	__rfcomm_rx_mode_free(entry->rx);
+	entry->rx = rx;
+
+	if (rx == NULL)
+		__rfcomm_fd_entry_release(fd);
+}
+
+/* Returns FALSE if the application changed the mode or closed the socket */
+static gboolean __rfcomm_rx_deliver(rfcomm_rx_mode_t *rx, int len, int iov_index)
+{
+	int fd = rx->fd;
+	guint serial = rx->serial;
+	bluetooth_rfcomm_received_data_t rx_data;
+	bluetooth_rfcomm_received_buffers_t rx_buffers;
+	int count = 0;
+	int remain = len;
+
+	if (rx->iov == NULL) {
+		rx_data.socket_fd = fd;
+		rx_data.buffer_size = len;
+		rx_data.buffer = rx->buffer;
+
+		_bluetooth_internal_event_cb(BLUETOOTH_EVENT_RFCOMM_DATA_RECEIVED,
+						BLUETOOTH_ERROR_NONE, &rx_data);
+	} else {
+		for (; count <= iov_index && count < rx->iov_count && remain > 0; count++) {
+			rx->filled[count].buffer = rx->iov[count].iov_base;
+			rx->filled[count].buffer_size = MIN(remain, (int)rx->iov[count].iov_len);
+			remain -= rx->filled[count].buffer_size;
+		}
+
+		rx_buffers.socket_fd = fd;
+		rx_buffers.total_size = len;
+		rx_buffers.buffer_count = count;
+		rx_buffers.buffers = rx->filled;
+
+		_bluetooth_internal_event_cb(BLUETOOTH_EVENT_RFCOMM_DATA_RECEIVED_BUFFERS,
+						BLUETOOTH_ERROR_NONE, &rx_buffers);
+	}
+
+	rx = __rfcomm_rx_mode_get(fd);
+
+	return (rx != NULL && rx->serial == serial) ? TRUE : FALSE;
+}
+
+/* Drain the socket until it would block and deliver one event per wakeup.
+ * Returns 0 when drained, 1 if the application changed the mode or closed
+ * the socket from the event callback and -1 on disconnection */
+static int __rfcomm_rx_coalesced_read(rfcomm_rx_mode_t *rx)
+{
+	int len = 0;
+	int index = 0;
+	int offset = 0;
+	int count;
+	int i;
+	ssize_t n;
+
+	while (1) {
+		if (rx->iov == NULL) {
+			n = read(rx->fd, rx->buffer + len, rx->buffer_size - len);
+		} else {
+			count = rx->iov_count - index;
+			for (i = 0; i < count; i++)
+				rx->scratch[i] = rx->iov[index + i];
+
+			rx->scratch[0].iov_base = (char *)rx->scratch[0].iov_base + offset;
+			rx->scratch[0].iov_len -= offset;
+
+			n = readv(rx->fd, rx->scratch, count);
+		}
+
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+
+			DBG("Read failed (fd=%d): %d\n", rx->fd, errno);
+			return -1;
+		}
+
+		if (n == 0) {
+			DBG("Remote closed (fd=%d)\n", rx->fd);
+			if (len > 0 && !__rfcomm_rx_deliver(rx, len, index))
+				return 1;
+			return -1;
+		}
+
+		len += n;
+
+		if (rx->iov == NULL) {
+			if (len < rx->buffer_size)
+				continue;
+		} else {
+			offset += n;
+			while (index < rx->iov_count && offset >= (int)rx->iov[index].iov_len) {
+				offset -= rx->iov[index].iov_len;
+				index++;
+			}
+
+			if (index < rx->iov_count)
+				continue;
+		}
+
+		/* Buffer full, hand it over and keep draining */
+		if (!__rfcomm_rx_deliver(rx, len, index))
+			return 1;
+
+		len = 0;
+		index = 0;
+		offset = 0;
+	}
+
+	if (len > 0 && !__rfcomm_rx_deliver(rx, len, index))
+		return 1;
+
+	return 0;
+}
+
+static gboolean __rfcomm_is_connected_socket(int fd)
+{
+	if (__rfcomm_get_server_by_client_socket(fd) != NULL)
+		return TRUE;
+
+	if (__rfcomm_get_client_by_socket(fd) != NULL)
+		return TRUE;
+
+	return FALSE;
+}
+
+BT_EXPORT_API int bluetooth_rfcomm_set_receive_buffer_size(int fd, int size)
+{
+	rfcomm_rx_mode_t *rx;
+
+	if ((fd <= 0) || (size < 0))
+		return BLUETOOTH_ERROR_INVALID_PARAM;
+
+	if (!__rfcomm_is_connected_socket(fd))
+		return BLUETOOTH_ERROR_NOT_CONNECTED;
+
+	if (size == 0) {
+		__rfcomm_rx_mode_set(fd, NULL);
+		return BLUETOOTH_ERROR_NONE;
+	}
+
+	rx = g_malloc0(sizeof(rfcomm_rx_mode_t));
+	rx->fd = fd;
+	rx->serial = ++rfcomm_rx_mode_serial;
+	rx->buffer = g_malloc(size);
+	rx->buffer_size = size;
+
+	__rfcomm_rx_mode_set(fd, rx);
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+BT_EXPORT_API int bluetooth_rfcomm_set_receive_buffers(int fd,
+					const bluetooth_rfcomm_buffer_t *buffers, int count)
+{
+	rfcomm_rx_mode_t *rx;
+	int i;
+
+	if (fd <= 0)
+		return BLUETOOTH_ERROR_INVALID_PARAM;
+
+	if (buffers != NULL && (count <= 0 || count > RFCOMM_RX_MAX_BUFFERS))
+		return BLUETOOTH_ERROR_INVALID_PARAM;
+
+	for (i = 0; buffers != NULL && i < count; i++) {
+		if (buffers[i].buffer == NULL || buffers[i].buffer_size <= 0)
+			return BLUETOOTH_ERROR_INVALID_PARAM;
+	}
+
+	if (!__rfcomm_is_connected_socket(fd))
+		return BLUETOOTH_ERROR_NOT_CONNECTED;
+
+	if (buffers == NULL) {
+		__rfcomm_rx_mode_set(fd, NULL);
+		return BLUETOOTH_ERROR_NONE;
+	}
+
+	rx = g_malloc0(sizeof(rfcomm_rx_mode_t));
+	rx->fd = fd;
+	rx->serial = ++rfcomm_rx_mode_serial;
+	rx->iov_count = count;
+	rx->iov = g_new0(struct iovec, count);
+	rx->scratch = g_new0(struct iovec, count);
+	rx->filled = g_new0(bluetooth_rfcomm_buffer_t, count);
+
+	for (i = 0; i < count; i++) {
+		rx->iov[i].iov_base = buffers[i].buffer;
+		rx->iov[i].iov_len = buffers[i].buffer_size;
+	}
+
+	__rfcomm_rx_mode_set(fd, rx);
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
 static int __get_default_adapter_path(char **adapter_path)
 {
 	DBusError error;
-	DBusMessage *msg, *reply;
-	const char *reply_path;
+	char path[BT_ADAPTER_OBJECT_PATH_MAX] = { 0 };
 
 	dbus_error_init(&error);
 	if (connection == NULL) {
@@ -630,41 +1031,13 @@ static int __get_default_adapter_path(char **adapter_path)
 		return -1;
 	}
 
-	msg = dbus_message_new_method_call(BLUEZ_SERVICE_NAME,
-					   BLUEZ_MANAGER_OBJ_PATH, BLUEZ_MANAGER_INTERFACE,
-					   "DefaultAdapter");
-
-	if (msg == NULL) {
-		DBG("dbus method call is not allocated.");
-		return -1;
-	}
-
-	reply = dbus_connection_send_with_reply_and_block(connection, msg, -1, &error);
-
-	dbus_message_unref(msg);
-
-	if (!reply) {
-		DBG("Can't Call DefaultAdapater");
-		if (dbus_error_is_set(&error)) {
-			DBG("%s\n", error.message);
-			dbus_error_free(&error);
-		}
-		return -1;
-	}
-
-	if (!dbus_message_get_args(reply, &error,
-				   DBUS_TYPE_OBJECT_PATH, &reply_path, DBUS_TYPE_INVALID)) {
-		DBG("Can't get reply arguments\n");
-		if (dbus_error_is_set(&error)) {
-			DBG("%s\n", error.message);
-			dbus_error_free(&error);
-		}
-		dbus_message_unref(reply);
+	/* Served from the signal-driven adapter cache in bt_info */
+	if (_bluetooth_internal_get_cached_adapter_path(path) < 0) {
+		DBG("No default adapter");
 		return -1;
 	}
 
-	*adapter_path = g_strdup(reply_path);
-	dbus_message_unref(reply);
+	*adapter_path = g_strdup(path);
 
 	return 0;
 }
@@ -851,7 +1224,7 @@ BT_EXPORT_API int bluetooth_rfcomm_create_socket(const char *uuid)
 	int len;
 	char address_string[RFCOMM_ADDRESS_STRING_LEN], tmp[8];
 	char *address_string_ptr, *sock_addr_un_ptr;
-	int index;
+	rfcomm_server_t *server;
 	int ret = 0;
 	char *uds_proxy = NULL;
 	static char *default_adapter_obj_path = NULL;
@@ -867,11 +1240,6 @@ BT_EXPORT_API int bluetooth_rfcomm_create_socket(const char *uuid)
 	}
 
 	DBG("Proxy count = %d\n", len);
-	index = __bluetooth_rfcomm_internal_server_get_free_index();
-	if (index < 0) {
-		DBG("MAX connection %d only supported", RFCOMM_MAX_CONN);
-		return BLUETOOTH_ERROR_MAX_CONNECTION;
-	}
 
 	if (__get_default_adapter_path(&default_adapter_obj_path) < 0) {
 		DBG("Fail to get default hci adapter path\n");
@@ -929,10 +1297,15 @@ BT_EXPORT_API int bluetooth_rfcomm_create_socket(const char *uuid)
 	}
 
 	uds_proxy = g_strdup(reply_path);
-	rfcomm_server[index].uds_name = uds_proxy;
-	rfcomm_server[index].id = index + 1;	/*Incrementing the index by 1 */
 
-	DBG(">>>>>>>>>>rfcomm_server[%d].id = %d\n", index, rfcomm_server[index].id);
+	server = g_malloc0(sizeof(rfcomm_server_t));
+	server->uds_name = uds_proxy;
+	server->id = len + 1;
+	server->server_sock_fd = -1;
+	server->client_sock_fd = -1;
+	server->uuid = g_strdup(uuid);
+
+	DBG(">>>>>>>>>>rfcomm_server.id = %d\n", server->id);
 
 	DBG("**** Unix Domain Socket Path %s *****\n", uds_proxy);
 
@@ -944,6 +1317,7 @@ BT_EXPORT_API int bluetooth_rfcomm_create_socket(const char *uuid)
 
 	if (msg == NULL) {
 		DBG("dbus method call is not allocated.");
+		__rfcomm_server_free(server);
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
@@ -957,11 +1331,12 @@ BT_EXPORT_API int bluetooth_rfcomm_create_socket(const char *uuid)
 			DBG("%s\n", error.message);
 			dbus_error_free(&error);
 		}
+		__rfcomm_server_free(server);
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 	dbus_message_unref(reply);
 
-	DBG("uds_proxy = %s, %s", uds_proxy, rfcomm_server[index].uds_name);
+	DBG("uds_proxy = %s, %s", uds_proxy, server->uds_name);
 
 /* Make Unix Socket */
 	int sk;
@@ -971,10 +1346,11 @@ BT_EXPORT_API int bluetooth_rfcomm_create_socket(const char *uuid)
 
 	if (sk < 0) {
 		perror("\nCan't Create Socket");
+		__rfcomm_server_free(server);
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
-	rfcomm_server[index].server_sock_fd = sk;
+	server->server_sock_fd = sk;
 	memset(&server_addr, 0, sizeof(server_addr));
 	server_addr.sun_family = PF_UNIX;
 
@@ -990,6 +1366,7 @@ BT_EXPORT_API int bluetooth_rfcomm_create_socket(const char *uuid)
 	if (bind(sk, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
 		perror("\nCan't Bind Sock\n");
 		close(sk);
+		__rfcomm_server_free(server);
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
@@ -1000,11 +1377,11 @@ BT_EXPORT_API int bluetooth_rfcomm_create_socket(const char *uuid)
 	if (ret != 0) {
 		DBG("Cannot set the tty%d\n", sk);
 		close(sk);
+		__rfcomm_server_free(server);
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
-	DBG("Set the uuid");
-	rfcomm_server[index].uuid = g_strdup(uuid);
+	__rfcomm_register_server(server);
 	return sk;
 }
 
@@ -1021,6 +1398,9 @@ BT_EXPORT_API gboolean bluetooth_rfcomm_is_server_uuid_available(const char *uui
 	if (strlen(uuid) != BT_128_UUID_LEN)
 		return FALSE;
 
+	if (__rfcomm_get_server_by_uuid(uuid) != NULL)
+		return TRUE;
+
 	/*Get all proxies */
 	if (__get_rfcomm_proxy_list(&proxy_list, &len) < 0) {
 		DBG("Fail to RFCOMM List Proxy\n");
@@ -1048,7 +1428,7 @@ BT_EXPORT_API int bluetooth_rfcomm_listen_and_accept(int socket_fd, int max_pend
 {
 	DBG("+\n");
 	int is_success;
-	int index;
+	rfcomm_server_t *server;
 	static char *default_adapter_obj_path = NULL;
 
 	if (socket_fd <= 0) {
@@ -1061,17 +1441,17 @@ BT_EXPORT_API int bluetooth_rfcomm_listen_and_accept(int socket_fd, int max_pend
 		return BLUETOOTH_ERROR_DEVICE_NOT_ENABLED;
 	}
 
-	index = __bluetooth_rfcomm_internal_server_get_index_from_socket(socket_fd);
-	if (index < 0) {
-		DBG("Invalid index %d", index);
+	server = __rfcomm_get_server_by_socket(socket_fd);
+	if (server == NULL) {
+		DBG("Invalid server socket %d", socket_fd);
 		return BLUETOOTH_ERROR_INVALID_PARAM;
 	}
 	is_success = listen(socket_fd, max_pending_connection);
 
 	if (is_success == 0)
-		rfcomm_server[index].is_listen = TRUE;
+		server->is_listen = TRUE;
 	else {
-		rfcomm_server[index].is_listen = FALSE;
+		server->is_listen = FALSE;
 		DBG("\nListen failed..");
 		return BLUETOOTH_ERROR_CONNECTION_ERROR;
 	}
@@ -1079,18 +1459,18 @@ BT_EXPORT_API int bluetooth_rfcomm_listen_and_accept(int socket_fd, int max_pend
 	if (vconf_set_str(BT_MEMORY_RFCOMM_UUID, "") != 0)
 		DBG("\vconf set failed..");
 
-	rfcomm_server[index].server_io_channel = g_io_channel_unix_new(socket_fd);
-	g_io_channel_set_close_on_unref(rfcomm_server[index].server_io_channel, TRUE);
+	server->server_io_channel = g_io_channel_unix_new(socket_fd);
+	g_io_channel_set_close_on_unref(server->server_io_channel, TRUE);
 
-	g_io_channel_set_encoding(rfcomm_server[index].server_io_channel, NULL, NULL);
-	g_io_channel_set_flags(rfcomm_server[index].server_io_channel,
+	g_io_channel_set_encoding(server->server_io_channel, NULL, NULL);
+	g_io_channel_set_flags(server->server_io_channel,
 				G_IO_FLAG_NONBLOCK, NULL);
 
-	rfcomm_server[index].server_event_src_id =
-	    g_io_add_watch(rfcomm_server[index].server_io_channel,
+	server->server_event_src_id =
+	    g_io_add_watch(server->server_io_channel,
 			   G_IO_IN | G_IO_HUP | G_IO_ERR | G_IO_NVAL, __rfcomm_server_connected_cb,
-			   &rfcomm_server[index]);
-	g_io_channel_unref(rfcomm_server[index].server_io_channel);
+			   server);
+	g_io_channel_unref(server->server_io_channel);
 
 	DBG(" -\n is success = %d\n", is_success);
 	return is_success;
@@ -1140,55 +1520,29 @@ static DBusHandlerResult __rfcomm_authorize_event_filter(DBusConnection *sys_con
 }
 
 /* To support the BOT  */
-DBusGConnection *__register_agent_authorize_signal(void *user_data)
+static int __register_agent_authorize_signal(void *user_data)
 {
 	DBG("+\n");
-	DBusGConnection *conn = NULL;
-	DBusConnection *dbus_connection = NULL;
-	GError *err = NULL;
-	DBusError dbus_error;
-
-	conn = dbus_g_bus_get(DBUS_BUS_SYSTEM, &err);
-	if (!conn) {
-		DBG(" DBUS get failed\n");
-		g_error_free(err);
-		return NULL;
-	}
 
-	dbus_connection = dbus_g_connection_get_connection(conn);
-
-	/* Add the filter for network client functions */
-	dbus_error_init(&dbus_error);
-	dbus_connection_add_filter(dbus_connection,
-				__rfcomm_authorize_event_filter,
-				user_data, NULL);
-	dbus_bus_add_match(dbus_connection,
-			   "type=signal,interface=" BT_AGENT_INTERFACE
-			   ",member=Authorize", &dbus_error);
-	if (dbus_error_is_set(&dbus_error)) {
+	if (_bluetooth_internal_add_signal_handler(BT_AGENT_INTERFACE,
+					BT_AGENT_SIGNAL_AUTHORIZE, NULL,
+					__rfcomm_authorize_event_filter,
+					user_data) < 0) {
 		ERR("Fail to add dbus filter signal\n");
-		dbus_error_free(&dbus_error);
+		return -1;
 	}
 
 	DBG("-\n");
-	return conn;
+	return 0;
 }
 
 /* To support the BOT  */
-static void __unregister_agent_authorize_signal(DBusGConnection *conn, void *user_data)
+static void __unregister_agent_authorize_signal(void *user_data)
 {
 	DBG("+");
 
-	DBusConnection *dbus_connection = NULL;
-
-	if (conn == NULL) {
-		DBG("conn is NULL");
-		return;
-	}
-
-	dbus_connection = dbus_g_connection_get_connection(conn);
-
-	dbus_connection_remove_filter(dbus_connection,
+	_bluetooth_internal_remove_signal_handler(BT_AGENT_INTERFACE,
+				BT_AGENT_SIGNAL_AUTHORIZE,
 				__rfcomm_authorize_event_filter,
 				user_data);
 
@@ -1203,7 +1557,7 @@ BT_EXPORT_API int bluetooth_rfcomm_listen(int socket_fd, int max_pending_connect
 {
 	DBG("+\n");
 	int is_success;
-	int index;
+	rfcomm_server_t *server;
 	static char *default_adapter_obj_path = NULL;
 
 	if (socket_fd <= 0) {
@@ -1216,50 +1570,50 @@ BT_EXPORT_API int bluetooth_rfcomm_listen(int socket_fd, int max_pending_connect
 		return BLUETOOTH_ERROR_DEVICE_NOT_ENABLED;
 	}
 
-	index = __bluetooth_rfcomm_internal_server_get_index_from_socket(socket_fd);
-	if (index < 0) {
-		DBG("Invalid index %d", index);
+	server = __rfcomm_get_server_by_socket(socket_fd);
+	if (server == NULL) {
+		DBG("Invalid server socket %d", socket_fd);
 		return BLUETOOTH_ERROR_INVALID_PARAM;
 	}
 
-	rfcomm_server[index].sys_conn = __register_agent_authorize_signal(
-						&rfcomm_server[index].server_sock_fd);
-
-	if (rfcomm_server[index].sys_conn == NULL) {
-		DBG("Fail to get the dbus connection");
-		return BLUETOOTH_ERROR_INTERNAL;
+	if (!server->is_authorize_signal) {
+		if (__register_agent_authorize_signal(&server->server_sock_fd) < 0) {
+			DBG("Fail to add the authorize signal");
+			return BLUETOOTH_ERROR_INTERNAL;
+		}
+		server->is_authorize_signal = TRUE;
 	}
 
 	/* Store the uuid info to vconf */
-	if (rfcomm_server[index].uuid) {
-		DBG("Set vconf: %s", rfcomm_server[index].uuid);
+	if (server->uuid) {
+		DBG("Set vconf: %s", server->uuid);
 
 		if (vconf_set_str(BT_MEMORY_RFCOMM_UUID,
-				rfcomm_server[index].uuid) != 0)
+				server->uuid) != 0)
 			DBG("\vconf set failed..");
 	}
 
 	is_success = listen(socket_fd, max_pending_connection);
 
 	if (is_success == 0)
-		rfcomm_server[index].is_listen = TRUE;
+		server->is_listen = TRUE;
 	else {
-		rfcomm_server[index].is_listen = FALSE;
+		server->is_listen = FALSE;
 		DBG("\nListen failed..");
 		return BLUETOOTH_ERROR_CONNECTION_ERROR;
 	}
 
-	rfcomm_server[index].server_io_channel = g_io_channel_unix_new(socket_fd);
-	g_io_channel_set_close_on_unref(rfcomm_server[index].server_io_channel, TRUE);
+	server->server_io_channel = g_io_channel_unix_new(socket_fd);
+	g_io_channel_set_close_on_unref(server->server_io_channel, TRUE);
 
-	g_io_channel_set_flags(rfcomm_server[index].server_io_channel,
+	g_io_channel_set_flags(server->server_io_channel,
 				G_IO_FLAG_NONBLOCK, NULL);
 
-	rfcomm_server[index].server_event_src_id =
-	    g_io_add_watch(rfcomm_server[index].server_io_channel,
+	server->server_event_src_id =
+	    g_io_add_watch(server->server_io_channel,
 			   G_IO_IN | G_IO_HUP | G_IO_ERR | G_IO_NVAL, __rfcomm_server_connected_cb,
-			   &rfcomm_server[index]);
-	g_io_channel_unref(rfcomm_server[index].server_io_channel);
+			   server);
+	g_io_channel_unref(server->server_io_channel);
 
 	DBG(" -\n is success = %d\n", is_success);
 	return is_success;
@@ -1395,16 +1749,16 @@ BT_EXPORT_API int bluetooth_rfcomm_remove_socket(int socket_fd)
 	DBG("+\n");
 	DBusMessage *msg, *reply;
 	DBusError error;
-	int index;
+	rfcomm_server_t *server;
 	static char *default_adapter_obj_path = NULL;
 
-	index = __bluetooth_rfcomm_internal_server_get_index_from_socket(socket_fd);
-	if (index < 0) {
-		DBG("Invalid index %d", index);
+	server = __rfcomm_get_server_by_socket(socket_fd);
+	if (server == NULL) {
+		DBG("Invalid server socket %d", socket_fd);
 		return BLUETOOTH_ERROR_INVALID_PARAM;
 	}
-	if ((socket_fd != rfcomm_server[index].server_sock_fd)
-	    || (NULL == rfcomm_server[index].uds_name)) {
+	if ((socket_fd != server->server_sock_fd)
+	    || (NULL == server->uds_name)) {
 		DBG("\nInvalid server socket \n");
 		return BLUETOOTH_ERROR_INVALID_PARAM;
 	}
@@ -1412,7 +1766,7 @@ BT_EXPORT_API int bluetooth_rfcomm_remove_socket(int socket_fd)
 /* Proxy Disable  Part */
 	DBG("Proxy disable \n");
 	msg = dbus_message_new_method_call(BLUEZ_SERVICE_NAME,
-					   rfcomm_server[index].uds_name,
+					   server->uds_name,
 					   BLUEZ_SERIAL_PROXY_INTERFACE, "Disable");
 
 	if (msg == NULL) {
@@ -1453,7 +1807,7 @@ BT_EXPORT_API int bluetooth_rfcomm_remove_socket(int socket_fd)
 		return BLUETOOTH_ERROR_INTERNAL;
 	}
 
-	dbus_message_append_args(msg, DBUS_TYPE_STRING, &rfcomm_server[index].uds_name,
+	dbus_message_append_args(msg, DBUS_TYPE_STRING, &server->uds_name,
 				 DBUS_TYPE_INVALID);
 
 	reply = dbus_connection_send_with_reply_and_block(connection, msg, -1, &error);
@@ -1470,47 +1824,39 @@ BT_EXPORT_API int bluetooth_rfcomm_remove_socket(int socket_fd)
 
 	dbus_message_unref(reply);
 
-	if (rfcomm_server[index].client_sock_fd) {
+	if (server->client_sock_fd != -1) {
 		bluetooth_rfcomm_disconnection_t disconnection_ind;
-		disconnection_ind.socket_fd = rfcomm_server[index].client_sock_fd;
-		disconnection_ind.device_addr = rfcomm_server[index].device_addr;
+		disconnection_ind.socket_fd = server->client_sock_fd;
+		disconnection_ind.device_addr = server->device_addr;
 		disconnection_ind.device_role = RFCOMM_ROLE_SERVER;
-		disconnection_ind.uuid = g_strdup(rfcomm_server[index].uuid);
+		disconnection_ind.uuid = g_strdup(server->uuid);
 
 		_bluetooth_internal_event_cb(BLUETOOTH_EVENT_RFCOMM_DISCONNECTED,
 						BLUETOOTH_ERROR_NONE, &disconnection_ind);
 
 		g_free(disconnection_ind.uuid);
 
-		g_source_remove(rfcomm_server[index].client_event_src_id);
-		close(rfcomm_server[index].client_sock_fd);
-		rfcomm_server[index].client_sock_fd = -1;
+		g_source_remove(server->client_event_src_id);
+		__rfcomm_internal_release_io(server->client_sock_fd);
+		close(server->client_sock_fd);
+		server->client_sock_fd = -1;
 	}
 
-	if (rfcomm_server[index].is_listen)
-		g_source_remove(rfcomm_server[index].server_event_src_id);
-
-	if (rfcomm_server[index].sys_conn) {
-		__unregister_agent_authorize_signal(
-					rfcomm_server[index].sys_conn,
-					&rfcomm_server[index].server_sock_fd);
+	if (server->is_listen)
+		g_source_remove(server->server_event_src_id);
 
-		dbus_g_connection_unref(rfcomm_server[index].sys_conn);
-		rfcomm_server[index].sys_conn = NULL;
+	if (server->is_authorize_signal) {
+		__unregister_agent_authorize_signal(&server->server_sock_fd);
+		server->is_authorize_signal = FALSE;
 	}
 
-	close(rfcomm_server[index].server_sock_fd);
-	rfcomm_server[index].server_sock_fd = -1;
-
-	rfcomm_server[index].is_listen = FALSE;
-	g_free(rfcomm_server[index].uds_name);
-	rfcomm_server[index].uds_name = NULL;
+	__rfcomm_unregister_server(server);
 
-	g_free(rfcomm_server[index].uuid);
-	rfcomm_server[index].uuid = NULL;
+	close(server->server_sock_fd);
+	server->server_sock_fd = -1;
 
 	/*Resetting the connection */
-	rfcomm_server[index].id = 0;
+	__rfcomm_server_free(server);
 
 	DBG("-\n");
 	return BLUETOOTH_ERROR_NONE;
@@ -1523,7 +1869,7 @@ BT_EXPORT_API int bluetooth_rfcomm_server_disconnect(int socket_fd)
 	bluetooth_rfcomm_disconnection_t disconnection_ind;
 	static char *default_adapter_obj_path = NULL;
 	bt_info_t *bt_internal_info = NULL;
-	int index = 0;
+	rfcomm_server_t *server;
 	int ret = BLUETOOTH_ERROR_NONE;
 
 	if (socket_fd <= 0)
@@ -1536,24 +1882,25 @@ BT_EXPORT_API int bluetooth_rfcomm_server_disconnect(int socket_fd)
 
 	bt_internal_info = _bluetooth_internal_get_information();
 
-	index = __bluetooth_rfcomm_internal_server_get_index_from_client_socket(socket_fd);
-	if (index < 0) {
-		DBG("Invalid index %d  for socket %d\n", index, socket_fd);
+	server = __rfcomm_get_server_by_client_socket(socket_fd);
+	if (server == NULL) {
+		DBG("Invalid socket %d\n", socket_fd);
 		return BLUETOOTH_ERROR_INVALID_PARAM;
 	}
 
-	disconnection_ind.socket_fd = rfcomm_server[index].client_sock_fd;
-	disconnection_ind.device_addr = rfcomm_server[index].device_addr;
+	disconnection_ind.socket_fd = server->client_sock_fd;
+	disconnection_ind.device_addr = server->device_addr;
 	disconnection_ind.device_role = RFCOMM_ROLE_SERVER;
-	disconnection_ind.uuid = g_strdup(rfcomm_server[index].uuid);
+	disconnection_ind.uuid = g_strdup(server->uuid);
 	_bluetooth_internal_event_cb(BLUETOOTH_EVENT_RFCOMM_DISCONNECTED,
 					BLUETOOTH_ERROR_NONE, &disconnection_ind);
 
 	g_free(disconnection_ind.uuid);
 
-	g_source_remove(rfcomm_server[index].client_event_src_id);
-	close(rfcomm_server[index].client_sock_fd);
-	rfcomm_server[index].client_sock_fd = -1;
+	g_source_remove(server->client_event_src_id);
+	__rfcomm_internal_release_io(server->client_sock_fd);
+	close(server->client_sock_fd);
+	server->client_sock_fd = -1;
 
 	DBG("-\n");
 
@@ -1567,7 +1914,7 @@ static int __rfcomm_server_disconnect(int socket_fd)
 
 	static char *default_adapter_obj_path = NULL;
 	bt_info_t *bt_internal_info = NULL;
-	int index = 0;
+	rfcomm_server_t *server;
 
 	if (socket_fd <= 0)
 		return BLUETOOTH_ERROR_INVALID_PARAM;
@@ -1579,15 +1926,16 @@ static int __rfcomm_server_disconnect(int socket_fd)
 
 	bt_internal_info = _bluetooth_internal_get_information();
 
-	index = __bluetooth_rfcomm_internal_server_get_index_from_client_socket(socket_fd);
-	if (index < 0) {
-		DBG("Invalid index %d  for socket %d\n", index, socket_fd);
+	server = __rfcomm_get_server_by_client_socket(socket_fd);
+	if (server == NULL) {
+		DBG("Invalid socket %d\n", socket_fd);
 		return BLUETOOTH_ERROR_INVALID_PARAM;
 	}
 
-	g_source_remove(rfcomm_server[index].client_event_src_id);
-	close(rfcomm_server[index].client_sock_fd);
-	rfcomm_server[index].client_sock_fd = -1;
+	g_source_remove(server->client_event_src_id);
+	__rfcomm_internal_release_io(server->client_sock_fd);
+	close(server->client_sock_fd);
+	server->client_sock_fd = -1;
 
 	DBG("-\n");
 
@@ -1609,6 +1957,7 @@ static void __rfcomm_client_connected_cb(DBusGProxy *proxy, DBusGProxyCall *call
 	char *dev_id_str = NULL;
 	int result = BLUETOOTH_ERROR_NONE;
 	int index = -1;
+	rfcomm_client_t *client = NULL;
 
 	bluetooth_event_param_t bt_event = { 0, };
 	bluetooth_rfcomm_connection_t con_ind;
@@ -1653,7 +2002,7 @@ static void __rfcomm_client_connected_cb(DBusGProxy *proxy, DBusGProxyCall *call
 	index = (int)strtol(dev_id_str, NULL, 10);
 	DBG("Index ID = [%d]", index);
 
-	if ((index < 0) || (index >= RFCOMM_MAX_CONN)) {
+	if (index < 0) {
 		DBG("Invalid index %d", index);
 		result = BLUETOOTH_ERROR_INVALID_PARAM;
 		goto done;
@@ -1675,28 +2024,31 @@ static void __rfcomm_client_connected_cb(DBusGProxy *proxy, DBusGProxyCall *call
 		/* Even if setting the tty fails we will continue */
 	}
 
-	rfcomm_client[index].id = index;
-	rfcomm_client[index].sock_fd = dev_node_fd;
-	rfcomm_client[index].dev_node_name = dev_node;
-	memcpy(&rfcomm_client[index].device_addr, remote_address, BLUETOOTH_ADDRESS_LENGTH);
+	client = g_malloc0(sizeof(rfcomm_client_t));
+	client->id = index;
+	client->sock_fd = dev_node_fd;
+	client->dev_node_name = dev_node;
+	memcpy(&client->device_addr, remote_address, BLUETOOTH_ADDRESS_LENGTH);
+
+	__rfcomm_register_socket(dev_node_fd, NULL, client);
 
-	rfcomm_client[index].io_channel = g_io_channel_unix_new(dev_node_fd);
-	g_io_channel_set_close_on_unref(rfcomm_client[index].io_channel, TRUE);
+	client->io_channel = g_io_channel_unix_new(dev_node_fd);
+	g_io_channel_set_close_on_unref(client->io_channel, TRUE);
 
-	g_io_channel_set_flags(rfcomm_client[index].io_channel,
+	g_io_channel_set_flags(client->io_channel,
 				G_IO_FLAG_NONBLOCK, NULL);
 
-	rfcomm_client[index].event_src_id =
-	    g_io_add_watch(rfcomm_client[index].io_channel,
+	client->event_src_id =
+	    g_io_add_watch(client->io_channel,
 			   G_IO_IN | G_IO_HUP | G_IO_ERR | G_IO_NVAL,
-			   __rfcomm_client_data_received_cb, &rfcomm_client[index]);
+			   __rfcomm_client_data_received_cb, client);
 
  done:
 	memset(&con_ind, 0x00, sizeof(bluetooth_rfcomm_connection_t));
 	memcpy(&con_ind.device_addr, remote_address, BLUETOOTH_ADDRESS_LENGTH);
 
 	if (result == BLUETOOTH_ERROR_NONE) {
-		con_ind.socket_fd = rfcomm_client[index].sock_fd;
+		con_ind.socket_fd = client->sock_fd;
 	} else {
 		con_ind.socket_fd = -1;
 
@@ -1900,7 +2252,7 @@ BT_EXPORT_API int bluetooth_rfcomm_connect(const bluetooth_device_address_t *rem
 	return BLUETOOTH_ERROR_NONE;
 }
 
-static int __bluetooth_rfcomm_internal_disconnect(int index)
+static int __bluetooth_rfcomm_internal_disconnect(rfcomm_client_t *client)
 {
 	DBusMessage *msg, *reply;
 	DBusError error;
@@ -1914,8 +2266,8 @@ static int __bluetooth_rfcomm_internal_disconnect(int index)
 	char str_addr[20];
 	memset(str_addr, 0, 20);
 
-	remote_bt_address = rfcomm_client[index].device_addr;
-	dev_node = rfcomm_client[index].dev_node_name;
+	remote_bt_address = client->device_addr;
+	dev_node = client->dev_node_name;
 
 	if (__get_default_adapter_path(&default_adapter_obj_path) < 0) {
 		DBG("Fail to get default hci adapter path\n");
@@ -2016,7 +2368,7 @@ BT_EXPORT_API int bluetooth_rfcomm_disconnect(int socket_fd)
 
 	static char *default_adapter_obj_path = NULL;
 	bt_info_t *bt_internal_info = NULL;
-	int index = 0;
+	rfcomm_client_t *client;
 	int ret = BLUETOOTH_ERROR_NONE;
 
 	if (__get_default_adapter_path(&default_adapter_obj_path) < 0) {
@@ -2044,35 +2396,36 @@ BT_EXPORT_API int bluetooth_rfcomm_disconnect(int socket_fd)
 		return BLUETOOTH_ERROR_NONE;
 	}
 
-	index = __bluetooth_rfcomm_internal_client_get_index_from_socket(socket_fd);
-	if (index < 0) {
-		DBG("Invalid index %d  for socket %d\n", index, socket_fd);
+	client = __rfcomm_get_client_by_socket(socket_fd);
+	if (client == NULL) {
+		DBG("No client for socket %d\n", socket_fd);
 
 		/* Try to disconnect server socket */
 		return __rfcomm_server_disconnect(socket_fd);
 	}
 
-	if (!(socket_fd && (socket_fd == rfcomm_client[index].sock_fd)) ||
-	       (NULL == rfcomm_client[index].dev_node_name)) {
-		DBG("Invalid FD %d  - %d\n", socket_fd, rfcomm_client[index].sock_fd);
+	if (!(socket_fd && (socket_fd == client->sock_fd)) ||
+	       (NULL == client->dev_node_name)) {
+		DBG("Invalid FD %d  - %d\n", socket_fd, client->sock_fd);
 		return BLUETOOTH_ERROR_INVALID_PARAM;
 	}
 
-	ret = __bluetooth_rfcomm_internal_disconnect(index);
+	ret = __bluetooth_rfcomm_internal_disconnect(client);
 
 	if (ret != BLUETOOTH_ERROR_NONE)
 		return ret;
 
-	g_source_remove(rfcomm_client[index].event_src_id);
-	rfcomm_client[index].event_src_id = -1;
+	g_source_remove(client->event_src_id);
+	client->event_src_id = -1;
 
-	close(rfcomm_client[index].sock_fd);
-	rfcomm_client[index].sock_fd = -1;
-	if (rfcomm_client[index].dev_node_name != NULL)
-		g_free(rfcomm_client[index].dev_node_name);
-	rfcomm_client[index].dev_node_name = NULL;
+	__rfcomm_internal_release_io(client->sock_fd);
+	close(client->sock_fd);
+	client->sock_fd = -1;
+	if (client->dev_node_name != NULL)
+		g_free(client->dev_node_name);
+	client->dev_node_name = NULL;
 
-	rfcomm_client[index].id = -1;
+	g_free(client);
 
 	DBG("-\n");
 
@@ -2080,39 +2433,349 @@ BT_EXPORT_API int bluetooth_rfcomm_disconnect(int socket_fd)
 
 }
 
+static void __rfcomm_tx_queue_free(gpointer data)
+{
+	rfcomm_tx_queue_t *tx = data;
+
+	if (tx == NULL)
+		return;
+
+	if (tx->event_src_id > 0)
+		g_source_remove(tx->event_src_id);
+
+	if (tx->requests) {
+		g_queue_foreach(tx->requests, (GFunc)g_free, NULL);
+		g_queue_free(tx->requests);
+	}
+
+	g_free(tx->ring);
+	g_free(tx);
+}
+
+static rfcomm_tx_queue_t *__rfcomm_tx_queue_get(int fd, gboolean create)
+{
+	rfcomm_fd_entry_t *entry = __rfcomm_fd_entry_get(fd, create);
+	rfcomm_tx_queue_t *tx;
+
+	if (entry == NULL)
+		return NULL;
+
+	if (entry->tx != NULL || !create)
+		return entry->tx;
+
+	tx = g_malloc0(sizeof(rfcomm_tx_queue_t));
+	tx->fd = fd;
+	tx->high_water_mark = RFCOMM_TX_HIGH_WATER_MARK;
+	tx->requests = g_queue_new();
+
+	entry->tx = tx;
+
+	return tx;
+}
+
+static void __rfcomm_tx_queue_remove(int fd)
+{
+	rfcomm_fd_entry_t *entry = __rfcomm_fd_entry_get(fd, FALSE);
+
+	if (entry == NULL)
+		return;
+
+	__rfcomm_tx_queue_free(entry->tx);
+	entry->tx = NULL;
+
+	__rfcomm_fd_entry_release(fd);
+}
+
+/* Drop the registry entry and the per-socket transmit and receive state
+ * before the fd is closed */
+static void __rfcomm_internal_release_io(int fd)
+{
+	__rfcomm_unregister_socket(fd);
+	__rfcomm_tx_queue_remove(fd);
+	__rfcomm_rx_mode_set(fd, NULL);
+}
+
+/* Account written bytes to the pending requests, returns the completed length */
+static unsigned int __rfcomm_tx_queue_consume(rfcomm_tx_queue_t *tx, unsigned int written)
+{
+	rfcomm_tx_request_t *req;
+	unsigned int completed = 0;
+	unsigned int part;
+
+	tx->head = (tx->head + written) % tx->ring_size;
+	tx->len -= written;
+
+	while (written > 0 && (req = g_queue_peek_head(tx->requests)) != NULL) {
+		part = MIN(written, req->length);
+		req->length -= part;
+		written -= part;
+
+		if (req->length > 0)
+			break;
+
+		if (req->notify)
+			completed += req->size;
+
+		g_free(g_queue_pop_head(tx->requests));
+	}
+
+	return completed;
+}
+
+static gboolean __rfcomm_tx_queue_drain_cb(GIOChannel *chan, GIOCondition cond, gpointer data)
+{
+	rfcomm_tx_queue_t *tx = data;
+	bluetooth_rfcomm_sent_data_t tx_data;
+	unsigned int completed = 0;
+	unsigned int chunk;
+	int result = BLUETOOTH_ERROR_NONE;
+	gboolean pending;
+	ssize_t written;
+
+	if (cond & (G_IO_NVAL | G_IO_HUP | G_IO_ERR)) {
+		DBG("TX channel closed (fd=%d)\n", tx->fd);
+		result = BLUETOOTH_ERROR_NOT_IN_OPERATION;
+		goto done;
+	}
+
+	while (tx->len > 0) {
+		chunk = MIN(tx->len, tx->ring_size - tx->head);
+
+		written = write(tx->fd, tx->ring + tx->head, chunk);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+
+			ERR("write failed (fd=%d): %d\n", tx->fd, errno);
+			result = BLUETOOTH_ERROR_NOT_IN_OPERATION;
+			goto done;
+		}
+
+		completed += __rfcomm_tx_queue_consume(tx, written);
+
+		if (written < chunk)
+			break;
+	}
+
+done:
+	if (result != BLUETOOTH_ERROR_NONE) {
+		/* The peer or the application closed the socket: drop the
+		 * bookkeeping now, the fd number may be reused by a new socket */
+		tx_data.socket_fd = tx->fd;
+		tx_data.buffer_size = completed;
+		tx_data.pending_size = 0;
+
+		tx->event_src_id = 0;
+		__rfcomm_tx_queue_remove(tx_data.socket_fd);
+
+		_bluetooth_internal_event_cb(BLUETOOTH_EVENT_RFCOMM_DATA_SENT,
+						result, &tx_data);
+		return FALSE;
+	}
+
+	/* The application may write or disconnect from the event callback,
+	 * so the watch state is settled before the event is emitted */
+	pending = tx->len > 0 ? TRUE : FALSE;
+	if (!pending)
+		tx->event_src_id = 0;
+
+	if (completed > 0) {
+		tx_data.socket_fd = tx->fd;
+		tx_data.buffer_size = completed;
+		tx_data.pending_size = tx->len;
+
+		_bluetooth_internal_event_cb(BLUETOOTH_EVENT_RFCOMM_DATA_SENT,
+						result, &tx_data);
+	}
+
+	return pending;
+}
+
+static int __rfcomm_tx_queue_push(rfcomm_tx_queue_t *tx, const char *buf,
+					unsigned int length, gboolean notify)
+{
+	GIOChannel *io_channel;
+	rfcomm_tx_request_t *req;
+	unsigned int tail;
+	unsigned int part;
+
+	if (length > tx->high_water_mark - tx->len) {
+		DBG("TX queue full (fd=%d, queued=%d)\n", tx->fd, tx->len);
+		return BLUETOOTH_ERROR_DEVICE_BUSY;
+	}
+
+	if (tx->ring == NULL) {
+		tx->ring = g_malloc(tx->high_water_mark);
+		tx->ring_size = tx->high_water_mark;
+		tx->head = 0;
+	}
+
+	tail = (tx->head + tx->len) % tx->ring_size;
+	part = MIN(length, tx->ring_size - tail);
+
+	memcpy(tx->ring + tail, buf, part);
+	memcpy(tx->ring, buf + part, length - part);
+	tx->len += length;
+
+	req = g_malloc0(sizeof(rfcomm_tx_request_t));
+	req->length = length;
+	req->size = length;
+	req->notify = notify;
+	g_queue_push_tail(tx->requests, req);
+
+	if (tx->event_src_id == 0) {
+		io_channel = g_io_channel_unix_new(tx->fd);
+		tx->event_src_id = g_io_add_watch(io_channel,
+					G_IO_OUT | G_IO_HUP | G_IO_ERR | G_IO_NVAL,
+					__rfcomm_tx_queue_drain_cb, tx);
+		g_io_channel_unref(io_channel);
+	}
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+static int __bluetooth_internal_wait_writable(int fd)
+{
+	struct pollfd pfd = { 0, };
+	int ret;
+
+	pfd.fd = fd;
+	pfd.events = POLLOUT;
+
+	do {
+		ret = poll(&pfd, 1, RFCOMM_WRITE_TIMEOUT);
+	} while (ret < 0 && errno == EINTR);
+
+	if (ret <= 0 || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)))
+		return -1;
+
+	return 0;
+}
+
 BT_EXPORT_API int bluetooth_rfcomm_write(int fd, const char *buf, int length)
 {
 	DBG("\bluetooth_rfcomm_write() +\n");
 	int wbytes = 0, written = 0;
-	static char *default_adapter_obj_path = NULL;
+	rfcomm_tx_queue_t *tx;
 
 	if ((fd <= 0) || (NULL == buf) || (length <= 0)) {
 		DBG("Invalid arguments..\n");
 		return BLUETOOTH_ERROR_INVALID_PARAM;
 	}
 
-	if (__get_default_adapter_path(&default_adapter_obj_path) < 0) {
-		DBG("Fail to get default hci adapter path\n");
-		return BLUETOOTH_ERROR_DEVICE_NOT_ENABLED;
-	}
+	/* Keep the ordering with the data queued by bluetooth_rfcomm_write_async */
+	tx = __rfcomm_tx_queue_get(fd, FALSE);
+	if (tx != NULL && tx->len > 0)
+		return __rfcomm_tx_queue_push(tx, buf, length, FALSE);
 
 	/*some times user may send huge data */
 	while (wbytes < length) {
 		written = write(fd, buf + wbytes, length - wbytes);
+		if (written < 0 && errno == EINTR)
+			continue;
+
+		if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			/* The socket is full, send the rest from the main loop */
+			tx = __rfcomm_tx_queue_get(fd, TRUE);
+			if (length - wbytes <= tx->high_water_mark)
+				return __rfcomm_tx_queue_push(tx, buf + wbytes,
+							length - wbytes, FALSE);
+
+			if (__bluetooth_internal_wait_writable(fd) < 0) {
+				DBG("write timeout..\n");
+				return BLUETOOTH_ERROR_NOT_IN_OPERATION;
+			}
+			continue;
+		}
+
 		if (written <= 0) {
 			DBG("write failed..\n");
+			/* Nothing more can be sent on this fd */
+			__rfcomm_tx_queue_remove(fd);
 			return BLUETOOTH_ERROR_NOT_IN_OPERATION;
 		}
 
-		/* Synchronize the sending buffer */
-		sync();
-		fsync(fd);
-
 		wbytes += written;
 	}
 
-	return BLUETOOTH_ERROR_NONE;
 	DBG("-\n");
+	return BLUETOOTH_ERROR_NONE;
+}
+
+BT_EXPORT_API int bluetooth_rfcomm_write_async(int fd, const char *buf, int length)
+{
+	rfcomm_tx_queue_t *tx;
+
+	if ((fd <= 0) || (NULL == buf) || (length <= 0)) {
+		DBG("Invalid arguments..\n");
+		return BLUETOOTH_ERROR_INVALID_PARAM;
+	}
+
+	if (fcntl(fd, F_GETFD) < 0) {
+		DBG("Invalid fd %d\n", fd);
+		/* Closed by the application, forget what was kept for it */
+		__rfcomm_tx_queue_remove(fd);
+		return BLUETOOTH_ERROR_NOT_IN_OPERATION;
+	}
+
+	tx = __rfcomm_tx_queue_get(fd, TRUE);
+
+	if ((unsigned int)length > tx->high_water_mark) {
+		DBG("Request is larger than the high-water mark\n");
+		return BLUETOOTH_ERROR_INVALID_PARAM;
+	}
+
+	return __rfcomm_tx_queue_push(tx, buf, length, TRUE);
+}
+
+BT_EXPORT_API int bluetooth_rfcomm_set_write_high_water_mark(int fd, unsigned int size)
+{
+	rfcomm_tx_queue_t *tx;
+	char *ring;
+	unsigned int part;
+
+	if ((fd <= 0) || (size == 0))
+		return BLUETOOTH_ERROR_INVALID_PARAM;
+
+	tx = __rfcomm_tx_queue_get(fd, TRUE);
+
+	if (tx->len > size)
+		return BLUETOOTH_ERROR_DEVICE_BUSY;
+
+	ring = NULL;
+	if (tx->len > 0) {
+		/* Linearize the queued data into the new ring */
+		ring = g_malloc(size);
+		part = MIN(tx->len, tx->ring_size - tx->head);
+		memcpy(ring, tx->ring + tx->head, part);
+		memcpy(ring + part, tx->ring, tx->len - part);
+	}
+
+	g_free(tx->ring);
+	tx->ring = ring;
+	tx->ring_size = ring ? size : 0;
+	tx->head = 0;
+	tx->high_water_mark = size;
+
+	return BLUETOOTH_ERROR_NONE;
+}
+
+BT_EXPORT_API int bluetooth_rfcomm_get_socket_by_address(
+				const bluetooth_device_address_t *remote_bt_address)
+{
+	GSList *fds;
+
+	if (remote_bt_address == NULL)
+		return BLUETOOTH_ERROR_INVALID_PARAM;
+
+	fds = __rfcomm_get_sockets_by_address(remote_bt_address);
+	if (fds == NULL)
+		return BLUETOOTH_ERROR_NOT_CONNECTED;
+
+	return GPOINTER_TO_INT(fds->data);
 }
 
 static gboolean __is_rfcomm_connected(DBusGConnection *conn, DBusGProxy *adapter,
@@ -2191,6 +2854,12 @@ BT_EXPORT_API gboolean bluetooth_rfcomm_is_client_connected()
 	int i;
 	DBusGProxy *adapter = NULL;
 
+	/* Our own client connections answer without asking bluez */
+	if (rfcomm_client_count > 0) {
+		DBG("connected: %d client(s)", rfcomm_client_count);
+		return TRUE;
+	}
+
 	conn = dbus_g_bus_get(DBUS_BUS_SYSTEM, &error);
 
 	if (error != NULL) {
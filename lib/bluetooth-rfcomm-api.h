@@ -24,14 +24,17 @@
 #ifndef _BLUETOOTH_RFCOMM_API_H_
 #define _BLUETOOTH_RFCOMM_API_H_
 
+#include <sys/uio.h>
+
 #include "bluetooth-api-common.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif				/* __cplusplus */
 
-#define RFCOMM_MAX_CONN 5
+#define RFCOMM_FD_TABLE_SIZE 64	/*initial size, grows with the highest fd*/
 #define RFCOMM_ADDRESS_STRING_LEN 24
+#define RFCOMM_TX_HIGH_WATER_MARK (64 * 1024)
 typedef struct {
 	int id;
 	int server_sock_fd;
@@ -46,9 +49,8 @@ typedef struct {
 	bluetooth_device_address_t device_addr;
 	GIOChannel *client_io_channel;
 	guint client_event_src_id;
-	DBusGConnection *sys_conn;
+	gboolean is_authorize_signal;	/*agent Authorize signal handler added*/
 } rfcomm_server_t;
-static rfcomm_server_t rfcomm_server[RFCOMM_MAX_CONN];
 
 typedef struct {
 	int id;
@@ -59,7 +61,40 @@ typedef struct {
 	bluetooth_device_address_t device_addr;
 } rfcomm_client_t;
 
-static rfcomm_client_t rfcomm_client[RFCOMM_MAX_CONN] = { { 0, }, };
+typedef struct {
+	unsigned int length;	/*remaining bytes of the request*/
+	unsigned int size;	/*total bytes of the request*/
+	gboolean notify;	/*emit BLUETOOTH_EVENT_RFCOMM_DATA_SENT*/
+} rfcomm_tx_request_t;
+
+typedef struct {
+	int fd;
+	guint event_src_id;	/*G_IO_OUT watch, 0 when idle*/
+	char *ring;		/*allocated on first use*/
+	unsigned int ring_size;
+	unsigned int head;
+	unsigned int len;	/*queued bytes*/
+	unsigned int high_water_mark;
+	GQueue *requests;
+} rfcomm_tx_queue_t;
+
+typedef struct {
+	int fd;
+	guint serial;
+	struct iovec *iov;	/*application buffer pool, NULL for the socket buffer*/
+	struct iovec *scratch;
+	bluetooth_rfcomm_buffer_t *filled;
+	int iov_count;
+	char *buffer;		/*socket buffer when no pool is registered*/
+	int buffer_size;
+} rfcomm_rx_mode_t;
+
+typedef struct {
+	rfcomm_server_t *server;	/*listening socket or its accepted connection*/
+	rfcomm_client_t *client;
+	rfcomm_tx_queue_t *tx;
+	rfcomm_rx_mode_t *rx;
+} rfcomm_fd_entry_t;
 
 struct connect_param_t {
 	char *remote_device_path;